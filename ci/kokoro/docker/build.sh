@@ -204,6 +204,14 @@ elif [[ "${BUILD_NAME}" = "cxx17" ]]; then
   export DISTRO=fedora-install
   export DISTRO_VERSION=30
   in_docker_script="ci/kokoro/docker/build-in-docker-cmake.sh"
+elif [[ "${BUILD_NAME}" = "cxx20" ]]; then
+  # Compile with C++20, this is the only build where the support for C++20
+  # coroutines (`GOOGLE_CLOUD_CPP_HAVE_COROUTINES`) is compiled and tested.
+  # GCC >= 11 enables coroutines with -std=c++20.
+  export GOOGLE_CLOUD_CPP_CXX_STANDARD=20
+  export DISTRO=fedora-install
+  export DISTRO_VERSION=34
+  in_docker_script="ci/kokoro/docker/build-in-docker-cmake.sh"
 elif [[ "${BUILD_NAME}" = "bazel-dependency" ]]; then
   export DISTRO=ubuntu
   export DISTRO_VERSION=18.04
@@ -0,0 +1,109 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/adaptive_throttler.h"
+#include "google/cloud/internal/random.h"
+#include "google/cloud/internal/throw_delegate.h"
+#include <algorithm>
+#include <random>
+
+namespace google {
+namespace cloud {
+inline namespace GOOGLE_CLOUD_CPP_NS {
+namespace {
+// The sliding window is approximated by this many buckets. The oldest bucket
+// is discarded as a whole, so the window is (up to 10%) shorter at times.
+std::size_t constexpr kBucketCount = 10;
+}  // namespace
+
+AdaptiveThrottler::AdaptiveThrottler(double k,
+                                     std::chrono::milliseconds window)
+    : k_(k),
+      bucket_width_(std::max(Clock::duration(1),
+                             std::chrono::duration_cast<Clock::duration>(
+                                 window / kBucketCount))),
+      origin_(Clock::now()),
+      buckets_(kBucketCount) {
+  if (k < 1.0) {
+    google::cloud::internal::ThrowInvalidArgument("k must be >= 1.0");
+  }
+  if (window.count() <= 0) {
+    google::cloud::internal::ThrowInvalidArgument("window must be positive");
+  }
+}
+
+bool AdaptiveThrottler::Admit() {
+  std::unique_lock<std::mutex> lk(mu_);
+  auto const p = RejectProbability(lk);
+  ++CurrentBucket(lk).requests;
+  ++counters_.requests;
+  if (p <= 0.0) return true;
+  lk.unlock();
+  std::uniform_real_distribution<double> d(0.0, 1.0);
+  if (d(google::cloud::internal::ThreadLocalFastPRNG()) >= p) return true;
+  lk.lock();
+  ++counters_.throttled;
+  return false;
+}
+
+void AdaptiveThrottler::OnResponse(Status const& status) {
+  if (status.code() == StatusCode::kUnavailable ||
+      status.code() == StatusCode::kResourceExhausted) {
+    return;
+  }
+  std::unique_lock<std::mutex> lk(mu_);
+  ++CurrentBucket(lk).accepts;
+  ++counters_.accepts;
+}
+
+double AdaptiveThrottler::RejectProbability() {
+  std::unique_lock<std::mutex> lk(mu_);
+  return RejectProbability(lk);
+}
+
+AdaptiveThrottlerCounters AdaptiveThrottler::counters() const {
+  std::lock_guard<std::mutex> lk(mu_);
+  return counters_;
+}
+
+AdaptiveThrottler::Bucket& AdaptiveThrottler::CurrentBucket(
+    std::unique_lock<std::mutex> const&) {
+  auto const epoch = static_cast<std::int64_t>((Clock::now() - origin_) /
+                                               bucket_width_);
+  auto& bucket = buckets_[static_cast<std::size_t>(epoch) % kBucketCount];
+  if (bucket.epoch != epoch) {
+    bucket = Bucket{};
+    bucket.epoch = epoch;
+  }
+  return bucket;
+}
+
+double AdaptiveThrottler::RejectProbability(
+    std::unique_lock<std::mutex> const& lk) {
+  auto const epoch = CurrentBucket(lk).epoch;
+  std::int64_t requests = 0;
+  std::int64_t accepts = 0;
+  for (auto const& b : buckets_) {
+    if (epoch - b.epoch >= static_cast<std::int64_t>(kBucketCount)) continue;
+    requests += b.requests;
+    accepts += b.accepts;
+  }
+  auto const p = (static_cast<double>(requests) - k_ * accepts) /
+                 static_cast<double>(requests + 1);
+  return std::max(0.0, p);
+}
+
+}  // namespace GOOGLE_CLOUD_CPP_NS
+}  // namespace cloud
+}  // namespace google
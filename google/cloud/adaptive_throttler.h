@@ -0,0 +1,124 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_ADAPTIVE_THROTTLER_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_ADAPTIVE_THROTTLER_H
+
+#include "google/cloud/internal/coarse_clock.h"
+#include "google/cloud/status.h"
+#include "google/cloud/version.h"
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace google {
+namespace cloud {
+inline namespace GOOGLE_CLOUD_CPP_NS {
+/// The counters for an `AdaptiveThrottler`.
+struct AdaptiveThrottlerCounters {
+  /// The number of requests, including the requests rejected locally.
+  std::int64_t requests = 0;
+
+  /// The number of requests accepted by the service.
+  std::int64_t accepts = 0;
+
+  /// The number of requests rejected locally, without contacting the service.
+  std::int64_t throttled = 0;
+};
+
+/**
+ * Reject requests locally when the service is overloaded.
+ *
+ * When a service is overloaded it rejects many requests, typically with
+ * `kUnavailable` or `kResourceExhausted`. Rejecting a request is cheaper than
+ * processing it, but it is not free, and clients sending at full rate can keep
+ * the service overloaded.
+ *
+ * This class implements the adaptive throttling described in the "Handling
+ * Overload" chapter of the Site Reliability Engineering book. It tracks the
+ * number of `requests` and the number of `accepts` (requests that the service
+ * did not reject due to overload) over a sliding window. Each new request is
+ * rejected locally with probability:
+ *
+ * @code
+ * max(0, (requests - k * accepts) / (requests + 1))
+ * @endcode
+ *
+ * While the service accepts all the requests no requests are rejected. Once
+ * the service rejects more than `1 - 1/k` of the requests the client starts
+ * rejecting some requests locally, the rejected requests are counted, so the
+ * local rejection rate grows while the service remains overloaded. Smaller
+ * values of @p k are more aggressive.
+ *
+ * Applications attach a throttler to their clients using
+ * `ConnectionOptions::set_adaptive_throttler()`. The same throttler can be
+ * shared by several clients of the same service. This class is thread-safe.
+ *
+ * @see https://sre.google/sre-book/handling-overload/
+ */
+class AdaptiveThrottler {
+ public:
+  /**
+   * Create a throttler.
+   *
+   * @param k the multiplier for the accepts, it must be at least 1.0.
+   * @param window the duration of the sliding window, it must be positive.
+   */
+  explicit AdaptiveThrottler(
+      double k = 2.0,
+      std::chrono::milliseconds window = std::chrono::minutes(2));
+
+  /**
+   * Record a new request and decide if it should be sent.
+   *
+   * @return false if the request should be rejected locally.
+   */
+  bool Admit();
+
+  /// Record the result of a request admitted by `Admit()`.
+  void OnResponse(Status const& status);
+
+  /// The current probability of rejecting a request.
+  double RejectProbability();
+
+  /// A snapshot of the counters for this throttler, since it was created.
+  AdaptiveThrottlerCounters counters() const;
+
+ private:
+  // The buckets are wide, a coarse clock is good enough.
+  using Clock = internal::CoarseSteadyClock;
+
+  struct Bucket {
+    std::int64_t epoch = 0;
+    std::int64_t requests = 0;
+    std::int64_t accepts = 0;
+  };
+
+  Bucket& CurrentBucket(std::unique_lock<std::mutex> const&);
+  double RejectProbability(std::unique_lock<std::mutex> const&);
+
+  double const k_;
+  Clock::duration const bucket_width_;
+  Clock::time_point const origin_;
+  mutable std::mutex mu_;
+  std::vector<Bucket> buckets_;
+  AdaptiveThrottlerCounters counters_;
+};
+
+}  // namespace GOOGLE_CLOUD_CPP_NS
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_ADAPTIVE_THROTTLER_H
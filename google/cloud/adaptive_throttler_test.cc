@@ -0,0 +1,111 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/adaptive_throttler.h"
+#include <gmock/gmock.h>
+#include <stdexcept>
+#include <thread>
+
+namespace google {
+namespace cloud {
+inline namespace GOOGLE_CLOUD_CPP_NS {
+namespace {
+
+Status Overloaded() { return Status(StatusCode::kUnavailable, "overloaded"); }
+
+TEST(AdaptiveThrottler, AdmitsWhileAccepted) {
+  AdaptiveThrottler tested;
+  for (int i = 0; i != 100; ++i) {
+    EXPECT_TRUE(tested.Admit());
+    // Errors other than overload are accepts, the service handled them.
+    tested.OnResponse(i % 2 == 0 ? Status()
+                                 : Status(StatusCode::kNotFound, "nope"));
+  }
+  EXPECT_EQ(0.0, tested.RejectProbability());
+
+  auto const counters = tested.counters();
+  EXPECT_EQ(100, counters.requests);
+  EXPECT_EQ(100, counters.accepts);
+  EXPECT_EQ(0, counters.throttled);
+}
+
+TEST(AdaptiveThrottler, RejectProbability) {
+  AdaptiveThrottler tested(2.0);
+  // With k == 2 the service can reject up to half the requests before the
+  // client starts throttling.
+  for (int i = 0; i != 10; ++i) {
+    EXPECT_TRUE(tested.Admit());
+    tested.OnResponse(i % 2 == 0 ? Status() : Overloaded());
+  }
+  EXPECT_EQ(0.0, tested.RejectProbability());
+
+  for (int i = 0; i != 10; ++i) {
+    tested.Admit();
+    tested.OnResponse(Status(StatusCode::kResourceExhausted, "quota"));
+  }
+  // (20 - 2 * 5) / (20 + 1)
+  EXPECT_DOUBLE_EQ(10.0 / 21.0, tested.RejectProbability());
+}
+
+TEST(AdaptiveThrottler, ThrottlesWhileOverloaded) {
+  AdaptiveThrottler tested(1.0);
+  int admitted = 0;
+  for (int i = 0; i != 1000; ++i) {
+    if (!tested.Admit()) continue;
+    ++admitted;
+    tested.OnResponse(Overloaded());
+  }
+  // The first request is always admitted, after that the reject probability
+  // quickly approaches 1.0.
+  EXPECT_LE(1, admitted);
+  EXPECT_GT(100, admitted);
+  EXPECT_LT(0.99, tested.RejectProbability());
+
+  auto const counters = tested.counters();
+  EXPECT_EQ(1000, counters.requests);
+  EXPECT_EQ(0, counters.accepts);
+  EXPECT_EQ(1000 - admitted, counters.throttled);
+}
+
+TEST(AdaptiveThrottler, WindowExpires) {
+  auto const window = std::chrono::milliseconds(100);
+  AdaptiveThrottler tested(1.0, window);
+  for (int i = 0; i != 10; ++i) {
+    tested.Admit();
+    tested.OnResponse(Overloaded());
+  }
+  EXPECT_LT(0.5, tested.RejectProbability());
+
+  std::this_thread::sleep_for(2 * window);
+  EXPECT_EQ(0.0, tested.RejectProbability());
+  EXPECT_TRUE(tested.Admit());
+}
+
+TEST(AdaptiveThrottler, ValidateParameters) {
+#if GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+  EXPECT_THROW(AdaptiveThrottler(0.5), std::invalid_argument);
+  EXPECT_THROW(AdaptiveThrottler(2.0, std::chrono::milliseconds(0)),
+               std::invalid_argument);
+#else
+  EXPECT_DEATH_IF_SUPPORTED(AdaptiveThrottler(0.5), "exceptions are disabled");
+  EXPECT_DEATH_IF_SUPPORTED(
+      AdaptiveThrottler(2.0, std::chrono::milliseconds(0)),
+      "exceptions are disabled");
+#endif  // GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+}
+
+}  // namespace
+}  // namespace GOOGLE_CLOUD_CPP_NS
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,193 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/async_log_backend.h"
+#include "google/cloud/internal/throw_delegate.h"
+#include <cstdint>
+
+namespace google {
+namespace cloud {
+inline namespace GOOGLE_CLOUD_CPP_NS {
+namespace {
+std::size_t RoundUpToPowerOfTwo(std::size_t n) {
+  std::size_t r = 1;
+  while (r < n) r <<= 1;
+  return r;
+}
+}  // namespace
+
+AsyncLogBackend::AsyncLogBackend(std::shared_ptr<LogBackend> backend,
+                                 AsyncLogBackendOptions options)
+    : backend_(std::move(backend)),
+      options_(std::move(options)),
+      mask_(RoundUpToPowerOfTwo(options_.capacity) - 1),
+      cells_(new Cell[mask_ + 1]),
+      push_pos_(0),
+      pop_pos_(0),
+      processed_(0),
+      dropped_(0),
+      overflows_(0),
+      drain_sleeping_(false),
+      waiters_(0),
+      drain_thread_id_(std::thread::id{}) {
+  if (!backend_) {
+    google::cloud::internal::ThrowInvalidArgument("backend must not be null");
+  }
+  if (options_.capacity == 0) {
+    google::cloud::internal::ThrowInvalidArgument("capacity must be positive");
+  }
+  if (options_.sample_period <= 0) {
+    google::cloud::internal::ThrowInvalidArgument(
+        "sample_period must be positive");
+  }
+  for (std::size_t i = 0; i <= mask_; ++i) cells_[i].sequence.store(i);
+  drain_thread_ = std::thread([this] { Drain(); });
+}
+
+AsyncLogBackend::~AsyncLogBackend() {
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    shutdown_ = true;
+    cv_.notify_all();
+  }
+  drain_thread_.join();
+}
+
+void AsyncLogBackend::Process(LogRecord const& log_record) {
+  ProcessWithOwnership(log_record);
+}
+
+void AsyncLogBackend::ProcessWithOwnership(LogRecord log_record) {
+  auto const flush = log_record.severity >= options_.flush_severity;
+  Push(std::move(log_record));
+  if (flush) Flush();
+}
+
+void AsyncLogBackend::Flush() {
+  if (InDrainThread()) return;
+  auto const target = push_pos_.load();
+  ++waiters_;
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  {
+    std::unique_lock<std::mutex> lk(mu_);
+    cv_.wait(lk, [&] {
+      return processed_.load() >= static_cast<std::int64_t>(target);
+    });
+  }
+  --waiters_;
+}
+
+// This is the bounded MPMC queue by Dmitry Vyukov, with a single consumer.
+// Each cell has a sequence number: a producer may fill cell `pos % size` once
+// its sequence is `pos`, and the consumer may empty it once it is `pos + 1`.
+bool AsyncLogBackend::TryPush(LogRecord& record) {
+  auto pos = push_pos_.load(std::memory_order_relaxed);
+  for (;;) {
+    auto& cell = cells_[pos & mask_];
+    auto const seq = cell.sequence.load(std::memory_order_acquire);
+    auto const diff =
+        static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos);
+    if (diff < 0) return false;  // the buffer is full
+    if (diff > 0) {
+      pos = push_pos_.load(std::memory_order_relaxed);
+      continue;
+    }
+    if (push_pos_.compare_exchange_weak(pos, pos + 1,
+                                        std::memory_order_relaxed)) {
+      cell.record = std::move(record);
+      cell.sequence.store(pos + 1, std::memory_order_release);
+      return true;
+    }
+  }
+}
+
+bool AsyncLogBackend::TryPop(LogRecord& record) {
+  auto const pos = pop_pos_.load(std::memory_order_relaxed);
+  auto& cell = cells_[pos & mask_];
+  if (cell.sequence.load(std::memory_order_acquire) != pos + 1) return false;
+  record = std::move(cell.record);
+  cell.sequence.store(pos + mask_ + 1, std::memory_order_release);
+  pop_pos_.store(pos + 1, std::memory_order_relaxed);
+  return true;
+}
+
+bool AsyncLogBackend::Empty() const {
+  auto const pos = pop_pos_.load(std::memory_order_relaxed);
+  return cells_[pos & mask_].sequence.load(std::memory_order_acquire) !=
+         pos + 1;
+}
+
+void AsyncLogBackend::Push(LogRecord record) {
+  if (!TryPush(record)) {
+    // The background thread cannot wait for itself.
+    auto const wait = !InDrainThread() && [this] {
+      switch (options_.overflow_policy) {
+        case LogOverflowPolicy::kBlock:
+          return true;
+        case LogOverflowPolicy::kSample:
+          return (overflows_.fetch_add(1) + 1) % options_.sample_period == 0;
+        case LogOverflowPolicy::kDrop:
+          break;
+      }
+      return false;
+    }();
+    if (!wait) {
+      ++dropped_;
+      return;
+    }
+    ++waiters_;
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    {
+      std::unique_lock<std::mutex> lk(mu_);
+      cv_.wait(lk, [&] { return TryPush(record); });
+    }
+    --waiters_;
+  }
+  // Pairs with the fence in `Drain()`: either the background thread sees the
+  // new record, or this thread sees that it is sleeping.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (!drain_sleeping_.load()) return;
+  std::lock_guard<std::mutex> lk(mu_);
+  cv_.notify_all();
+}
+
+bool AsyncLogBackend::InDrainThread() const {
+  return drain_thread_id_.load() == std::this_thread::get_id();
+}
+
+void AsyncLogBackend::Drain() {
+  drain_thread_id_.store(std::this_thread::get_id());
+  LogRecord record;
+  for (;;) {
+    if (TryPop(record)) {
+      backend_->ProcessWithOwnership(std::move(record));
+      ++processed_;
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (waiters_.load() == 0) continue;
+      std::lock_guard<std::mutex> lk(mu_);
+      cv_.notify_all();
+      continue;
+    }
+    std::unique_lock<std::mutex> lk(mu_);
+    if (shutdown_ && Empty()) return;
+    drain_sleeping_.store(true);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    cv_.wait(lk, [this] { return shutdown_ || !Empty(); });
+    drain_sleeping_.store(false);
+  }
+}
+
+}  // namespace GOOGLE_CLOUD_CPP_NS
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,150 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_ASYNC_LOG_BACKEND_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_ASYNC_LOG_BACKEND_H
+
+#include "google/cloud/log.h"
+#include "google/cloud/version.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace google {
+namespace cloud {
+inline namespace GOOGLE_CLOUD_CPP_NS {
+/// What `AsyncLogBackend` does with a record when its buffer is full.
+enum class LogOverflowPolicy {
+  /// Wait until the background thread makes room for the record.
+  kBlock,
+  /// Discard the record.
+  kDrop,
+  /// Discard the records, except every `sample_period`-th, which waits.
+  kSample,
+};
+
+/// Configure an `AsyncLogBackend`.
+struct AsyncLogBackendOptions {
+  /// The maximum number of buffered records, rounded up to a power of two.
+  std::size_t capacity = 4096;
+
+  /**
+   * What to do with the records that find the buffer full.
+   *
+   * The records are often logged from threads running a `CompletionQueue`,
+   * which should not wait for a slow backend. Use `LogOverflowPolicy::kBlock`
+   * only if losing records is worse than stalling these threads.
+   */
+  LogOverflowPolicy overflow_policy = LogOverflowPolicy::kDrop;
+
+  /// With `LogOverflowPolicy::kSample`, keep one in this many records.
+  std::int64_t sample_period = 100;
+
+  /**
+   * Records at or above this severity flush the buffer.
+   *
+   * These records often precede a crash, so they (and any records buffered
+   * before them) are processed before `Process()` returns.
+   */
+  Severity flush_severity = Severity::GCP_LS_CRITICAL;
+};
+
+/**
+ * Process the log records of another backend in a background thread.
+ *
+ * Backends such as the `std::clog` backend perform I/O in the thread that
+ * logs, often a thread running a `CompletionQueue`. This backend pushes the
+ * records into a bounded, lock-free ring buffer, and a dedicated thread
+ * drains the buffer into the wrapped backend. Applications wrap the backend
+ * before adding it to the `LogSink`:
+ *
+ * @code
+ * google::cloud::LogSink::Instance().AddBackend(
+ *     std::make_shared<google::cloud::AsyncLogBackend>(backend));
+ * @endcode
+ *
+ * The wrapped backend is only called from the background thread. Destroying
+ * this object processes any buffered records, then stops the thread.
+ */
+class AsyncLogBackend : public LogBackend {
+ public:
+  /**
+   * Start the background thread for @p backend.
+   *
+   * @throws std::invalid_argument if `options.capacity` is 0, or if
+   *     `options.sample_period` is not positive.
+   */
+  explicit AsyncLogBackend(
+      std::shared_ptr<LogBackend> backend,
+      AsyncLogBackendOptions options = AsyncLogBackendOptions{});
+  ~AsyncLogBackend() override;
+
+  AsyncLogBackend(AsyncLogBackend const&) = delete;
+  AsyncLogBackend& operator=(AsyncLogBackend const&) = delete;
+
+  void Process(LogRecord const& log_record) override;
+  void ProcessWithOwnership(LogRecord log_record) override;
+
+  /// Wait until the records pushed before this call are processed.
+  void Flush();
+
+  /// The number of records discarded because the buffer was full.
+  std::int64_t dropped_count() const { return dropped_.load(); }
+
+ private:
+  struct Cell {
+    std::atomic<std::size_t> sequence;
+    LogRecord record;
+  };
+
+  bool TryPush(LogRecord& record);
+  bool TryPop(LogRecord& record);
+  bool Empty() const;
+  bool InDrainThread() const;
+  void Push(LogRecord record);
+  void Drain();
+
+  std::shared_ptr<LogBackend> backend_;
+  AsyncLogBackendOptions const options_;
+  std::size_t const mask_;
+  std::unique_ptr<Cell[]> cells_;
+  std::atomic<std::size_t> push_pos_;
+  std::atomic<std::size_t> pop_pos_;
+  std::atomic<std::int64_t> processed_;
+  std::atomic<std::int64_t> dropped_;
+  std::atomic<std::int64_t> overflows_;
+
+  // Threads sleep on `cv_` when the buffer is empty (the background thread)
+  // or full (blocked producers), or while flushing. These flags avoid
+  // locking `mu_` to wake them up when nobody is sleeping.
+  std::mutex mu_;
+  std::condition_variable cv_;
+  std::atomic<bool> drain_sleeping_;
+  std::atomic<int> waiters_;
+  bool shutdown_ = false;
+  // The background thread cannot wait for itself. It stores its id before
+  // calling the wrapped backend, as `drain_thread_` may not be assigned yet.
+  std::atomic<std::thread::id> drain_thread_id_;
+  std::thread drain_thread_;
+};
+
+}  // namespace GOOGLE_CLOUD_CPP_NS
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_ASYNC_LOG_BACKEND_H
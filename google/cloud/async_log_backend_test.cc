@@ -0,0 +1,287 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/async_log_backend.h"
+#include <gmock/gmock.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace google {
+namespace cloud {
+inline namespace GOOGLE_CLOUD_CPP_NS {
+namespace {
+
+using ::testing::ElementsAre;
+
+/// A backend that records the messages, and can block until opened.
+class TestBackend : public LogBackend {
+ public:
+  explicit TestBackend(bool open = true) : open_(open) {}
+
+  void Process(LogRecord const& lr) override { ProcessWithOwnership(lr); }
+  void ProcessWithOwnership(LogRecord lr) override {
+    std::unique_lock<std::mutex> lk(mu_);
+    ++entered_;
+    cv_.notify_all();
+    cv_.wait(lk, [this] { return open_; });
+    messages_.push_back(std::move(lr.message));
+    thread_ids_.insert(std::this_thread::get_id());
+  }
+
+  void Open() {
+    std::lock_guard<std::mutex> lk(mu_);
+    open_ = true;
+    cv_.notify_all();
+  }
+
+  void WaitEntered(int count) {
+    std::unique_lock<std::mutex> lk(mu_);
+    cv_.wait(lk, [&] { return entered_ >= count; });
+  }
+
+  std::vector<std::string> messages() {
+    std::lock_guard<std::mutex> lk(mu_);
+    return messages_;
+  }
+
+  std::set<std::thread::id> thread_ids() {
+    std::lock_guard<std::mutex> lk(mu_);
+    return thread_ids_;
+  }
+
+ private:
+  std::mutex mu_;
+  std::condition_variable cv_;
+  bool open_;
+  int entered_ = 0;
+  std::vector<std::string> messages_;
+  std::set<std::thread::id> thread_ids_;
+};
+
+LogRecord MakeRecord(std::string message,
+                     Severity severity = Severity::GCP_LS_INFO) {
+  LogRecord lr;
+  lr.severity = severity;
+  lr.function = "Func";
+  lr.filename = "filename.cc";
+  lr.lineno = 123;
+  lr.timestamp = std::chrono::system_clock::now();
+  lr.message = std::move(message);
+  return lr;
+}
+
+/// Block the background thread on "m0", then fill the buffer.
+void FillBuffer(AsyncLogBackend& tested, TestBackend& backend, int capacity) {
+  tested.Process(MakeRecord("m0"));
+  backend.WaitEntered(1);
+  for (int i = 1; i <= capacity; ++i) {
+    tested.Process(MakeRecord("m" + std::to_string(i)));
+  }
+  EXPECT_EQ(0, tested.dropped_count());
+}
+
+TEST(AsyncLogBackend, ProcessInBackground) {
+  auto backend = std::make_shared<TestBackend>();
+  AsyncLogBackend tested(backend);
+  tested.Process(MakeRecord("m0"));
+  tested.ProcessWithOwnership(MakeRecord("m1"));
+  tested.Flush();
+  EXPECT_THAT(backend->messages(), ElementsAre("m0", "m1"));
+  auto const ids = backend->thread_ids();
+  ASSERT_EQ(1U, ids.size());
+  EXPECT_NE(std::this_thread::get_id(), *ids.begin());
+}
+
+TEST(AsyncLogBackend, DestructorDrains) {
+  auto backend = std::make_shared<TestBackend>(/*open=*/false);
+  {
+    AsyncLogBackend tested(backend);
+    for (int i = 0; i != 3; ++i) {
+      tested.Process(MakeRecord("m" + std::to_string(i)));
+    }
+    backend->Open();
+  }
+  EXPECT_THAT(backend->messages(), ElementsAre("m0", "m1", "m2"));
+}
+
+TEST(AsyncLogBackend, FlushOnFatal) {
+  auto backend = std::make_shared<TestBackend>();
+  AsyncLogBackendOptions options;
+  options.flush_severity = Severity::GCP_LS_CRITICAL;
+  AsyncLogBackend tested(backend, options);
+  for (int i = 0; i != 10; ++i) {
+    tested.Process(MakeRecord("m" + std::to_string(i)));
+  }
+  tested.Process(MakeRecord("fatal", Severity::GCP_LS_CRITICAL));
+  // The record, and all the records before it, are processed before
+  // `Process()` returns.
+  auto const messages = backend->messages();
+  ASSERT_EQ(11U, messages.size());
+  EXPECT_EQ("fatal", messages.back());
+}
+
+TEST(AsyncLogBackend, DropWhenFull) {
+  auto backend = std::make_shared<TestBackend>(/*open=*/false);
+  AsyncLogBackendOptions options;
+  options.capacity = 4;
+  options.overflow_policy = LogOverflowPolicy::kDrop;
+  AsyncLogBackend tested(backend, options);
+  FillBuffer(tested, *backend, 4);
+  for (int i = 0; i != 3; ++i) tested.Process(MakeRecord("dropped"));
+  EXPECT_EQ(3, tested.dropped_count());
+
+  backend->Open();
+  tested.Flush();
+  EXPECT_THAT(backend->messages(), ElementsAre("m0", "m1", "m2", "m3", "m4"));
+}
+
+TEST(AsyncLogBackend, BlockWhenFull) {
+  auto backend = std::make_shared<TestBackend>(/*open=*/false);
+  AsyncLogBackendOptions options;
+  options.capacity = 4;
+  options.overflow_policy = LogOverflowPolicy::kBlock;
+  AsyncLogBackend tested(backend, options);
+  FillBuffer(tested, *backend, 4);
+  std::thread t([&tested] { tested.Process(MakeRecord("m5")); });
+
+  backend->Open();
+  t.join();
+  tested.Flush();
+  EXPECT_EQ(0, tested.dropped_count());
+  EXPECT_THAT(backend->messages(),
+              ElementsAre("m0", "m1", "m2", "m3", "m4", "m5"));
+}
+
+TEST(AsyncLogBackend, SampleWhenFull) {
+  auto backend = std::make_shared<TestBackend>(/*open=*/false);
+  AsyncLogBackendOptions options;
+  options.capacity = 4;
+  options.overflow_policy = LogOverflowPolicy::kSample;
+  options.sample_period = 3;
+  AsyncLogBackend tested(backend, options);
+  FillBuffer(tested, *backend, 4);
+  tested.Process(MakeRecord("dropped"));
+  tested.Process(MakeRecord("dropped"));
+  EXPECT_EQ(2, tested.dropped_count());
+  // The third record waits.
+  std::thread t([&tested] { tested.Process(MakeRecord("sampled")); });
+
+  backend->Open();
+  t.join();
+  tested.Flush();
+  EXPECT_EQ(2, tested.dropped_count());
+  EXPECT_THAT(backend->messages(),
+              ElementsAre("m0", "m1", "m2", "m3", "m4", "sampled"));
+}
+
+TEST(AsyncLogBackend, DropByDefault) {
+  AsyncLogBackendOptions options;
+  EXPECT_EQ(LogOverflowPolicy::kDrop, options.overflow_policy);
+}
+
+/// Forwards the records to another `AsyncLogBackend`, and flushes it.
+class ForwardingBackend : public LogBackend {
+ public:
+  ForwardingBackend(AsyncLogBackend& target, TestBackend& target_backend)
+      : target_(target), target_backend_(target_backend) {}
+
+  void Process(LogRecord const& lr) override { ProcessWithOwnership(lr); }
+  void ProcessWithOwnership(LogRecord lr) override {
+    target_.Process(lr);
+    target_.Flush();
+    flushed_ = target_backend_.messages().size();
+  }
+
+  std::size_t flushed() const { return flushed_.load(); }
+
+ private:
+  AsyncLogBackend& target_;
+  TestBackend& target_backend_;
+  std::atomic<std::size_t> flushed_{0};
+};
+
+TEST(AsyncLogBackend, FlushFromOtherBackgroundThread) {
+  auto inner_backend = std::make_shared<TestBackend>();
+  AsyncLogBackend inner(inner_backend);
+  auto forwarding = std::make_shared<ForwardingBackend>(inner, *inner_backend);
+  AsyncLogBackend outer(forwarding);
+  outer.Process(MakeRecord("m0"));
+  outer.Flush();
+  // Only the background thread of `inner` skips flushing `inner`.
+  EXPECT_EQ(1U, forwarding->flushed());
+}
+
+TEST(AsyncLogBackend, ManyProducers) {
+  auto backend = std::make_shared<TestBackend>();
+  auto constexpr kThreadCount = 4;
+  auto constexpr kIterations = 1000;
+  {
+    AsyncLogBackendOptions options;
+    options.capacity = 16;
+    options.overflow_policy = LogOverflowPolicy::kBlock;
+    AsyncLogBackend tested(backend, options);
+    std::vector<std::thread> threads;
+    for (int t = 0; t != kThreadCount; ++t) {
+      threads.emplace_back([&tested, t] {
+        for (int i = 0; i != kIterations; ++i) {
+          tested.Process(MakeRecord(std::to_string(t) + ":" +
+                                    std::to_string(i)));
+        }
+      });
+    }
+    for (auto& t : threads) t.join();
+  }
+
+  // The records from each thread are processed in order.
+  std::vector<int> next(kThreadCount, 0);
+  auto const messages = backend->messages();
+  ASSERT_EQ(static_cast<std::size_t>(kThreadCount * kIterations),
+            messages.size());
+  for (auto const& m : messages) {
+    auto const pos = m.find(':');
+    auto const t = std::stoi(m.substr(0, pos));
+    EXPECT_EQ(next[t]++, std::stoi(m.substr(pos + 1)));
+  }
+}
+
+TEST(AsyncLogBackend, ValidateParameters) {
+  AsyncLogBackendOptions zero_capacity;
+  zero_capacity.capacity = 0;
+  AsyncLogBackendOptions zero_period;
+  zero_period.sample_period = 0;
+  auto backend = std::make_shared<TestBackend>();
+#if GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+  EXPECT_THROW(AsyncLogBackend(nullptr), std::invalid_argument);
+  EXPECT_THROW(AsyncLogBackend(backend, zero_capacity), std::invalid_argument);
+  EXPECT_THROW(AsyncLogBackend(backend, zero_period), std::invalid_argument);
+#else
+  EXPECT_DEATH_IF_SUPPORTED(AsyncLogBackend(nullptr),
+                            "exceptions are disabled");
+  EXPECT_DEATH_IF_SUPPORTED(AsyncLogBackend(backend, zero_capacity),
+                            "exceptions are disabled");
+  EXPECT_DEATH_IF_SUPPORTED(AsyncLogBackend(backend, zero_period),
+                            "exceptions are disabled");
+#endif  // GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+}
+
+}  // namespace
+}  // namespace GOOGLE_CLOUD_CPP_NS
+}  // namespace cloud
+}  // namespace google
@@ -15,6 +15,7 @@
 #ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_ASYNC_OPERATION_H
 #define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_ASYNC_OPERATION_H
 
+#include "google/cloud/streaming_read_stats.h"
 #include "google/cloud/version.h"
 #include <grpcpp/grpcpp.h>
 #include <chrono>
@@ -48,6 +49,20 @@ class AsyncOperation {
   virtual void Cancel() = 0;
 };
 
+/**
+ * Represents a pending asynchronous streaming read RPC.
+ */
+class AsyncStreamingReadOperation : public AsyncOperation {
+ public:
+  /**
+   * Return a snapshot of the statistics for this stream.
+   *
+   * The statistics are only collected if requested when the stream is created,
+   * see `CompletionQueue::MakeStreamingReadRpc()`.
+   */
+  virtual StreamingReadStats stats() const = 0;
+};
+
 }  // namespace GOOGLE_CLOUD_CPP_NS
 }  // namespace cloud
 }  // namespace google
@@ -19,6 +19,7 @@
 #include "google/cloud/internal/async_read_stream_impl.h"
 #include "google/cloud/internal/completion_queue_impl.h"
 #include "google/cloud/status_or.h"
+#include "google/cloud/streaming_read_batch_options.h"
 
 namespace google {
 namespace cloud {
@@ -77,11 +78,16 @@ class CompletionQueue {
    * @return a future that becomes satisfied after @p duration time has elapsed.
    *     The result of the future is the time at which it expired, or an error
    *     Status if the timer did not run to expiration (e.g. it was cancelled).
+   *
+   * @note The timer uses a monotonic clock, changes to the system clock do not
+   *     affect when it expires. The time in the result is the system clock
+   *     time when the timer was expected to expire.
    */
   template <typename Rep, typename Period>
   future<StatusOr<std::chrono::system_clock::time_point>> MakeRelativeTimer(
       std::chrono::duration<Rep, Period> duration) {
-    return MakeDeadlineTimer(std::chrono::system_clock::now() + duration);
+    return impl_->MakeRelativeTimer(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(duration));
   }
 
   /**
@@ -112,9 +118,10 @@ class CompletionQueue {
       AsyncCallType async_call, Request const& request,
       std::unique_ptr<grpc::ClientContext> context) {
     auto op =
-        std::make_shared<internal::AsyncUnaryRpcFuture<Request, Response>>();
+        std::make_shared<internal::AsyncUnaryRpcFuture<Request, Response>>(
+            std::move(context));
     impl_->StartOperation(op, [&](void* tag) {
-      op->Start(async_call, std::move(context), request, &impl_->cq(), tag);
+      op->Start(async_call, request, &impl_->cq(), tag);
     });
     return op->GetFuture();
   }
@@ -130,8 +137,18 @@ class CompletionQueue {
    * @param async_call a callable to start the asynchronous RPC.
    * @param request the contents of the request.
    * @param context an initialized request context to make the call.
-   * @param on_read the callback to be invoked on each successful Read().
+   * @param on_read the callback to be invoked on each successful Read(). It
+   *     must return `bool` or `future<bool>`, the stream is cancelled if the
+   *     result is `false`. Handlers that complete synchronously should return
+   *     `bool`, which avoids allocating a future for each message.
    * @param on_finish the callback to be invoked when the stream is closed.
+   * @param read_ahead the maximum number of messages to receive (and buffer)
+   *     while @p on_read is processing a message. Reading ahead overlaps the
+   *     network latency with the processing time. With the default (0) the
+   *     next message is not read until @p on_read completes.
+   * @param collect_stats if true, the stream collects the statistics returned
+   *     by `AsyncStreamingReadOperation::stats()`. This is disabled by
+   *     default, as it adds some overhead for each message.
    *
    * @tparam AsyncCallType the type of @a async_call. It must be invocable with
    *     parameters
@@ -151,13 +168,58 @@ class CompletionQueue {
             typename Response = typename internal::
                 AsyncStreamingReadResponseType<AsyncCallType, Request>::type,
             typename OnReadHandler, typename OnFinishHandler>
-  std::shared_ptr<AsyncOperation> MakeStreamingReadRpc(
+  std::shared_ptr<AsyncStreamingReadOperation> MakeStreamingReadRpc(
       AsyncCallType&& async_call, Request const& request,
       std::unique_ptr<grpc::ClientContext> context, OnReadHandler&& on_read,
-      OnFinishHandler&& on_finish) {
+      OnFinishHandler&& on_finish, std::size_t read_ahead = 0,
+      bool collect_stats = false) {
     auto stream = internal::MakeAsyncReadStreamImpl<Response>(
         std::forward<OnReadHandler>(on_read),
-        std::forward<OnFinishHandler>(on_finish));
+        std::forward<OnFinishHandler>(on_finish), read_ahead, collect_stats);
+    stream->Start(std::forward<AsyncCallType>(async_call), request,
+                  std::move(context), impl_);
+    return stream;
+  }
+
+  /**
+   * Make an asynchronous streaming read RPC, delivering messages in batches.
+   *
+   * This is similar to `MakeStreamingReadRpc()`, but @p on_read receives a
+   * `std::vector<Response>` with one or more messages. Grouping the messages
+   * amortizes the cost of calling @p on_read, which is useful for streams with
+   * many small messages.
+   *
+   * @param async_call a callable to start the asynchronous RPC.
+   * @param request the contents of the request.
+   * @param context an initialized request context to make the call.
+   * @param on_read the callback to be invoked on each batch of messages. It
+   *     must return `bool` or `future<bool>`, the stream is cancelled if the
+   *     result is `false`.
+   * @param on_finish the callback to be invoked when the stream is closed.
+   * @param options control the size of each batch, and how long to wait for a
+   *     partial batch to fill.
+   * @param collect_stats if true, the stream collects the statistics returned
+   *     by `AsyncStreamingReadOperation::stats()`.
+   *
+   * @tparam AsyncCallType the type of @a async_call, with the same requirements
+   *     as in `MakeStreamingReadRpc()`.
+   * @tparam Request the type of the request in the streaming RPC.
+   * @tparam Response the type of the response in the streaming RPC.
+   * @tparam OnReadHandler the type of the @p on_read callback.
+   * @tparam OnFinishHandler the type of the @p on_finish callback.
+   */
+  template <typename AsyncCallType, typename Request,
+            typename Response = typename internal::
+                AsyncStreamingReadResponseType<AsyncCallType, Request>::type,
+            typename OnReadHandler, typename OnFinishHandler>
+  std::shared_ptr<AsyncStreamingReadOperation> MakeBatchedStreamingReadRpc(
+      AsyncCallType&& async_call, Request const& request,
+      std::unique_ptr<grpc::ClientContext> context, OnReadHandler&& on_read,
+      OnFinishHandler&& on_finish, StreamingReadBatchOptions options = {},
+      bool collect_stats = false) {
+    auto stream = internal::MakeAsyncBatchReadStreamImpl<Response>(
+        std::forward<OnReadHandler>(on_read),
+        std::forward<OnFinishHandler>(on_finish), options, collect_stats);
     stream->Start(std::forward<AsyncCallType>(async_call), request,
                   std::move(context), impl_);
     return stream;
@@ -187,6 +249,31 @@ class CompletionQueue {
         });
   }
 
+#if GOOGLE_CLOUD_CPP_HAVE_COROUTINES
+  /**
+   * Await @p f in a C++20 coroutine, resuming on a thread running this queue.
+   *
+   * Awaiting a `future<T>` directly resumes the coroutine on whatever thread
+   * satisfies the future. Use this function when the coroutine must continue
+   * on one of the threads blocked in `Run()`:
+   *
+   * @code
+   * future<Status> Example(CompletionQueue cq, future<Status> f) {
+   *   auto status = co_await cq.MakeAwaitable(std::move(f));
+   *   // running in a thread blocked in `cq.Run()`
+   *   co_return status;
+   * }
+   * @endcode
+   *
+   * @note this is only available if `GOOGLE_CLOUD_CPP_HAVE_COROUTINES` is
+   *     defined.
+   */
+  template <typename T>
+  internal::CompletionQueueAwaiter<T> MakeAwaitable(future<T> f) {
+    return internal::CompletionQueueAwaiter<T>(impl_, std::move(f));
+  }
+#endif  // GOOGLE_CLOUD_CPP_HAVE_COROUTINES
+
  private:
   std::shared_ptr<internal::CompletionQueueImpl> impl_;
 };
@@ -14,13 +14,19 @@
 
 #include "google/cloud/completion_queue.h"
 #include "google/cloud/future.h"
+#include "google/cloud/internal/coarse_clock.h"
 #include "google/cloud/testing_util/assert_ok.h"
+#include "google/cloud/testing_util/mock_completion_queue.h"
 #include <google/bigtable/admin/v2/bigtable_table_admin.grpc.pb.h>
 #include <google/bigtable/v2/bigtable.grpc.pb.h>
 #include <gmock/gmock.h>
+#include <algorithm>
 #include <chrono>
+#include <cstdint>
 #include <memory>
+#include <string>
 #include <thread>
+#include <vector>
 
 namespace google {
 namespace cloud {
@@ -30,6 +36,7 @@ namespace {
 class MockCompletionQueue : public internal::CompletionQueueImpl {
  public:
   using internal::CompletionQueueImpl::SimulateCompletion;
+  using internal::CompletionQueueImpl::size;
 };
 
 namespace btadmin = ::google::bigtable::admin::v2;
@@ -53,6 +60,19 @@ class MockClient {
                                                grpc::CompletionQueue* cq));
 };
 
+/// Return the tags of the pending operations in @p cq not in @p known.
+std::vector<void*> OtherPendingTags(testing_util::MockCompletionQueue const& cq,
+                                    std::vector<void*> const& known) {
+  auto tags = cq.pending_tags();
+  tags.erase(std::remove_if(tags.begin(), tags.end(),
+                            [&known](void* t) {
+                              return std::find(known.begin(), known.end(),
+                                               t) != known.end();
+                            }),
+             tags.end());
+  return tags;
+}
+
 class MockTableReader
     : public grpc::ClientAsyncResponseReaderInterface<btadmin::Table> {
  public:
@@ -90,6 +110,44 @@ TEST(CompletionQueueTest, TimerSmokeTest) {
   t.join();
 }
 
+/// @test Verify that relative timers wait at least for the requested time.
+TEST(CompletionQueueTest, RelativeTimerDuration) {
+  CompletionQueue cq;
+  std::thread t([&cq] { cq.Run(); });
+
+  using ms = std::chrono::milliseconds;
+  auto const start = std::chrono::steady_clock::now();
+  auto const system_start = std::chrono::system_clock::now();
+  auto result = cq.MakeRelativeTimer(ms(20)).get();
+  EXPECT_LE(start + ms(20), std::chrono::steady_clock::now());
+  ASSERT_STATUS_OK(result);
+  // The result is the expected expiration time, in terms of the system clock.
+  EXPECT_LE(system_start + ms(20), *result);
+
+  cq.Shutdown();
+  t.join();
+}
+
+/// @test Verify that the threads running a CompletionQueue refresh the
+/// coarse clock.
+TEST(CompletionQueueTest, RunRefreshesCoarseClock) {
+  using ms = std::chrono::milliseconds;
+  CompletionQueue cq;
+  std::thread t([&cq] { cq.Run(); });
+
+  for (int i = 0; i != 10; ++i) {
+    cq.MakeRelativeTimer(ms(10)).get();
+    auto const coarse = internal::CoarseSteadyClock::now();
+    auto const now = std::chrono::steady_clock::now();
+    // The loop wakes up at least every 50ms, allow for some scheduling delays.
+    EXPECT_GE(now, coarse);
+    EXPECT_LE(now - ms(500), coarse);
+  }
+
+  cq.Shutdown();
+  t.join();
+}
+
 TEST(CompletionQueueTest, MockSmokeTest) {
   auto mock = std::make_shared<MockCompletionQueue>();
 
@@ -206,6 +264,52 @@ TEST(CompletionQueueTest, MakeUnaryRpc) {
   runner.join();
 }
 
+TEST(CompletionQueueTest, CancelUnaryRpcContinuation) {
+  using ms = std::chrono::milliseconds;
+
+  auto mock_cq = std::make_shared<MockCompletionQueue>();
+  CompletionQueue cq(mock_cq);
+
+  auto mock_reader = google::cloud::internal::make_unique<MockTableReader>();
+  EXPECT_CALL(*mock_reader, Finish(_, _, _))
+      .WillOnce([](btadmin::Table*, grpc::Status* status, void*) {
+        *status = grpc::Status(grpc::StatusCode::CANCELLED, "cancelled");
+      });
+  MockClient mock_client;
+  grpc::ClientContext* rpc_context = nullptr;
+  EXPECT_CALL(mock_client, AsyncGetTable(_, _, _))
+      .WillOnce([&mock_reader, &rpc_context](grpc::ClientContext* context,
+                                             btadmin::GetTableRequest const&,
+                                             grpc::CompletionQueue*) {
+        rpc_context = context;
+        return std::unique_ptr<
+            grpc::ClientAsyncResponseReaderInterface<btadmin::Table>>(
+            mock_reader.get());
+      });
+
+  future<Status> done =
+      cq.MakeUnaryRpc(
+            [&mock_client](grpc::ClientContext* context,
+                           btadmin::GetTableRequest const& request,
+                           grpc::CompletionQueue* cq) {
+              return mock_client.AsyncGetTable(context, request, cq);
+            },
+            btadmin::GetTableRequest{},
+            google::cloud::internal::make_unique<grpc::ClientContext>())
+          .then([](future<StatusOr<btadmin::Table>> f) {
+            return f.get().status();
+          });
+  ASSERT_NE(nullptr, rpc_context);
+
+  // Cancelling the continuation reaches the `grpc::ClientContext` of the RPC.
+  EXPECT_TRUE(done.cancel());
+  EXPECT_FALSE(done.cancel());
+
+  mock_cq->SimulateCompletion(true);
+  EXPECT_EQ(std::future_status::ready, done.wait_for(ms(0)));
+  EXPECT_EQ(StatusCode::kCancelled, done.get().code());
+}
+
 TEST(CompletionQueueTest, MakeStreamingReadRpc) {
   auto mock_cq = std::make_shared<MockCompletionQueue>();
   CompletionQueue cq(mock_cq);
@@ -267,6 +371,683 @@ TEST(CompletionQueueTest, MakeStreamingReadRpc) {
   runner.join();
 }
 
+/// @test Verify the read loop reuses the same operation and response buffer.
+TEST(CompletionQueueTest, MakeStreamingReadRpcReusesReadOperation) {
+  auto mock_cq = std::make_shared<MockCompletionQueue>();
+  CompletionQueue cq(mock_cq);
+
+  std::vector<btproto::ReadRowsResponse*> buffers;
+  std::vector<void*> tags;
+  auto mock_reader = google::cloud::internal::make_unique<MockRowReader>();
+  EXPECT_CALL(*mock_reader, StartCall(_)).Times(1);
+  EXPECT_CALL(*mock_reader, Read(_, _))
+      .Times(4)
+      .WillRepeatedly([&](btproto::ReadRowsResponse* r, void* tag) {
+        r->set_last_scanned_row_key("row-" + std::to_string(buffers.size()));
+        buffers.push_back(r);
+        tags.push_back(tag);
+      });
+  EXPECT_CALL(*mock_reader, Finish(_, _)).Times(1);
+
+  MockClient mock_client;
+  EXPECT_CALL(mock_client, AsyncReadRows(_, _, _))
+      .WillOnce([&mock_reader](grpc::ClientContext*,
+                               btproto::ReadRowsRequest const&,
+                               grpc::CompletionQueue*) {
+        return std::unique_ptr<
+            grpc::ClientAsyncReaderInterface<btproto::ReadRowsResponse>>(
+            mock_reader.release());
+      });
+
+  std::vector<std::string> keys;
+  int on_finish_counter = 0;
+  (void)cq.MakeStreamingReadRpc(
+      [&mock_client](grpc::ClientContext* context,
+                     btproto::ReadRowsRequest const& request,
+                     grpc::CompletionQueue* cq) {
+        return mock_client.AsyncReadRows(context, request, cq);
+      },
+      btproto::ReadRowsRequest{},
+      google::cloud::internal::make_unique<grpc::ClientContext>(),
+      [&keys](btproto::ReadRowsResponse const& r) {
+        keys.push_back(r.last_scanned_row_key());
+        return make_ready_future(true);
+      },
+      [&on_finish_counter](Status const&) { ++on_finish_counter; });
+
+  // Simulate the OnStart() completion
+  mock_cq->SimulateCompletion(true);
+  for (int i = 0; i != 3; ++i) {
+    // Simulate a Read() completion, there is always a single pending read.
+    EXPECT_EQ(1, mock_cq->size());
+    mock_cq->SimulateCompletion(true);
+  }
+  // Simulate a Read() returning false, and then the Finish() call.
+  mock_cq->SimulateCompletion(false);
+  mock_cq->SimulateCompletion(true);
+  EXPECT_EQ(0, mock_cq->size());
+  EXPECT_EQ(1, on_finish_counter);
+
+  EXPECT_THAT(keys, ::testing::ElementsAre("row-0", "row-1", "row-2"));
+  ASSERT_EQ(4, buffers.size());
+  ASSERT_EQ(4, tags.size());
+  for (std::size_t i = 1; i != buffers.size(); ++i) {
+    EXPECT_EQ(buffers[0], buffers[i]);
+    EXPECT_EQ(tags[0], tags[i]);
+  }
+}
+
+/// @test Verify that `on_read` handlers can return `bool`.
+TEST(CompletionQueueTest, MakeStreamingReadRpcSynchronousHandler) {
+  auto mock_cq = std::make_shared<MockCompletionQueue>();
+  CompletionQueue cq(mock_cq);
+
+  auto mock_reader = google::cloud::internal::make_unique<MockRowReader>();
+  EXPECT_CALL(*mock_reader, StartCall(_)).Times(1);
+  EXPECT_CALL(*mock_reader, Read(_, _)).Times(4);
+  EXPECT_CALL(*mock_reader, Finish(_, _)).Times(1);
+
+  MockClient mock_client;
+  EXPECT_CALL(mock_client, AsyncReadRows(_, _, _))
+      .WillOnce([&mock_reader](grpc::ClientContext*,
+                               btproto::ReadRowsRequest const&,
+                               grpc::CompletionQueue*) {
+        return std::unique_ptr<
+            grpc::ClientAsyncReaderInterface<btproto::ReadRowsResponse>>(
+            mock_reader.release());
+      });
+
+  int on_read_counter = 0;
+  int on_finish_counter = 0;
+  (void)cq.MakeStreamingReadRpc(
+      [&mock_client](grpc::ClientContext* context,
+                     btproto::ReadRowsRequest const& request,
+                     grpc::CompletionQueue* cq) {
+        return mock_client.AsyncReadRows(context, request, cq);
+      },
+      btproto::ReadRowsRequest{},
+      google::cloud::internal::make_unique<grpc::ClientContext>(),
+      [&on_read_counter](btproto::ReadRowsResponse const&) {
+        return ++on_read_counter < 2;
+      },
+      [&on_finish_counter](Status const&) { ++on_finish_counter; });
+
+  // Simulate the OnStart() completion
+  mock_cq->SimulateCompletion(true);
+  // Simulate two Read() completions, the second one stops the stream.
+  mock_cq->SimulateCompletion(true);
+  mock_cq->SimulateCompletion(true);
+  EXPECT_EQ(2, on_read_counter);
+  // Any additional messages are discarded.
+  mock_cq->SimulateCompletion(true);
+  EXPECT_EQ(2, on_read_counter);
+  EXPECT_EQ(0, on_finish_counter);
+
+  // Simulate a Read() returning false, and then the Finish() call.
+  mock_cq->SimulateCompletion(false);
+  mock_cq->SimulateCompletion(true);
+  EXPECT_EQ(2, on_read_counter);
+  EXPECT_EQ(1, on_finish_counter);
+}
+
+/// @test Verify the stream reads ahead while the handler is busy.
+TEST(CompletionQueueTest, MakeStreamingReadRpcReadAhead) {
+  auto mock_cq = std::make_shared<MockCompletionQueue>();
+  CompletionQueue cq(mock_cq);
+
+  int read_count = 0;
+  auto mock_reader = google::cloud::internal::make_unique<MockRowReader>();
+  EXPECT_CALL(*mock_reader, StartCall(_)).Times(1);
+  EXPECT_CALL(*mock_reader, Read(_, _))
+      .WillRepeatedly([&](btproto::ReadRowsResponse* r, void*) {
+        r->set_last_scanned_row_key("row-" + std::to_string(read_count++));
+      });
+  EXPECT_CALL(*mock_reader, Finish(_, _)).Times(1);
+
+  MockClient mock_client;
+  EXPECT_CALL(mock_client, AsyncReadRows(_, _, _))
+      .WillOnce([&mock_reader](grpc::ClientContext*,
+                               btproto::ReadRowsRequest const&,
+                               grpc::CompletionQueue*) {
+        return std::unique_ptr<
+            grpc::ClientAsyncReaderInterface<btproto::ReadRowsResponse>>(
+            mock_reader.release());
+      });
+
+  std::vector<std::string> keys;
+  std::vector<promise<bool>> pending;
+  int on_finish_counter = 0;
+  (void)cq.MakeStreamingReadRpc(
+      [&mock_client](grpc::ClientContext* context,
+                     btproto::ReadRowsRequest const& request,
+                     grpc::CompletionQueue* cq) {
+        return mock_client.AsyncReadRows(context, request, cq);
+      },
+      btproto::ReadRowsRequest{},
+      google::cloud::internal::make_unique<grpc::ClientContext>(),
+      [&](btproto::ReadRowsResponse const& r) {
+        keys.push_back(r.last_scanned_row_key());
+        pending.emplace_back();
+        return pending.back().get_future();
+      },
+      [&on_finish_counter](Status const&) { ++on_finish_counter; },
+      /*read_ahead=*/2);
+
+  // Simulate the OnStart() completion
+  mock_cq->SimulateCompletion(true);
+  EXPECT_EQ(1, read_count);
+  // The first message is delivered, and the stream reads ahead.
+  mock_cq->SimulateCompletion(true);
+  EXPECT_EQ(2, read_count);
+  EXPECT_THAT(keys, ::testing::ElementsAre("row-0"));
+  // The next two messages are buffered, then the stream stops reading.
+  mock_cq->SimulateCompletion(true);
+  EXPECT_EQ(3, read_count);
+  mock_cq->SimulateCompletion(true);
+  EXPECT_EQ(3, read_count);
+  EXPECT_THAT(keys, ::testing::ElementsAre("row-0"));
+
+  // Completing the handler delivers the next buffered message, and the stream
+  // resumes reading.
+  ASSERT_EQ(1, pending.size());
+  pending[0].set_value(true);
+  EXPECT_THAT(keys, ::testing::ElementsAre("row-0", "row-1"));
+  EXPECT_EQ(4, read_count);
+
+  // Stop the stream, the buffered message is dropped and the pending read is
+  // discarded.
+  ASSERT_EQ(2, pending.size());
+  pending[1].set_value(false);
+  mock_cq->SimulateCompletion(true);
+  EXPECT_THAT(keys, ::testing::ElementsAre("row-0", "row-1"));
+  EXPECT_EQ(5, read_count);
+  EXPECT_EQ(0, on_finish_counter);
+
+  // Simulate a Read() returning false, and then the Finish() call.
+  mock_cq->SimulateCompletion(false);
+  mock_cq->SimulateCompletion(true);
+  EXPECT_EQ(1, on_finish_counter);
+}
+
+/// @test Verify buffered messages are delivered before the stream finishes.
+TEST(CompletionQueueTest, MakeStreamingReadRpcReadAheadDrainsBeforeFinish) {
+  auto mock_cq = std::make_shared<MockCompletionQueue>();
+  CompletionQueue cq(mock_cq);
+
+  int read_count = 0;
+  auto mock_reader = google::cloud::internal::make_unique<MockRowReader>();
+  EXPECT_CALL(*mock_reader, StartCall(_)).Times(1);
+  EXPECT_CALL(*mock_reader, Read(_, _))
+      .WillRepeatedly([&](btproto::ReadRowsResponse* r, void*) {
+        r->set_last_scanned_row_key("row-" + std::to_string(read_count++));
+      });
+  EXPECT_CALL(*mock_reader, Finish(_, _)).Times(1);
+
+  MockClient mock_client;
+  EXPECT_CALL(mock_client, AsyncReadRows(_, _, _))
+      .WillOnce([&mock_reader](grpc::ClientContext*,
+                               btproto::ReadRowsRequest const&,
+                               grpc::CompletionQueue*) {
+        return std::unique_ptr<
+            grpc::ClientAsyncReaderInterface<btproto::ReadRowsResponse>>(
+            mock_reader.release());
+      });
+
+  std::vector<std::string> keys;
+  promise<bool> first;
+  int on_finish_counter = 0;
+  (void)cq.MakeStreamingReadRpc(
+      [&mock_client](grpc::ClientContext* context,
+                     btproto::ReadRowsRequest const& request,
+                     grpc::CompletionQueue* cq) {
+        return mock_client.AsyncReadRows(context, request, cq);
+      },
+      btproto::ReadRowsRequest{},
+      google::cloud::internal::make_unique<grpc::ClientContext>(),
+      [&](btproto::ReadRowsResponse const& r) {
+        keys.push_back(r.last_scanned_row_key());
+        if (keys.size() == 1) return first.get_future();
+        return make_ready_future(true);
+      },
+      [&on_finish_counter](Status const&) { ++on_finish_counter; },
+      /*read_ahead=*/4);
+
+  mock_cq->SimulateCompletion(true);  // OnStart()
+  mock_cq->SimulateCompletion(true);  // row-0, delivered
+  mock_cq->SimulateCompletion(true);  // row-1, buffered
+  mock_cq->SimulateCompletion(true);  // row-2, buffered
+  mock_cq->SimulateCompletion(false);  // end of stream
+  EXPECT_THAT(keys, ::testing::ElementsAre("row-0"));
+  EXPECT_EQ(0, on_finish_counter);
+
+  // Completing the handler delivers the buffered messages, and then the stream
+  // calls Finish().
+  first.set_value(true);
+  EXPECT_THAT(keys, ::testing::ElementsAre("row-0", "row-1", "row-2"));
+  mock_cq->SimulateCompletion(true);
+  EXPECT_EQ(1, on_finish_counter);
+}
+
+/// @test Verify that batched streaming reads group the buffered messages.
+TEST(CompletionQueueTest, MakeBatchedStreamingReadRpc) {
+  auto mock_cq = std::make_shared<MockCompletionQueue>();
+  CompletionQueue cq(mock_cq);
+
+  int read_count = 0;
+  auto mock_reader = google::cloud::internal::make_unique<MockRowReader>();
+  EXPECT_CALL(*mock_reader, StartCall(_)).Times(1);
+  EXPECT_CALL(*mock_reader, Read(_, _))
+      .WillRepeatedly([&](btproto::ReadRowsResponse* r, void*) {
+        r->set_last_scanned_row_key("row-" + std::to_string(read_count++));
+      });
+  EXPECT_CALL(*mock_reader, Finish(_, _)).Times(1);
+
+  MockClient mock_client;
+  EXPECT_CALL(mock_client, AsyncReadRows(_, _, _))
+      .WillOnce([&mock_reader](grpc::ClientContext*,
+                               btproto::ReadRowsRequest const&,
+                               grpc::CompletionQueue*) {
+        return std::unique_ptr<
+            grpc::ClientAsyncReaderInterface<btproto::ReadRowsResponse>>(
+            mock_reader.release());
+      });
+
+  std::vector<std::vector<std::string>> batches;
+  promise<bool> first;
+  int on_finish_counter = 0;
+  (void)cq.MakeBatchedStreamingReadRpc(
+      [&mock_client](grpc::ClientContext* context,
+                     btproto::ReadRowsRequest const& request,
+                     grpc::CompletionQueue* cq) {
+        return mock_client.AsyncReadRows(context, request, cq);
+      },
+      btproto::ReadRowsRequest{},
+      google::cloud::internal::make_unique<grpc::ClientContext>(),
+      [&](std::vector<btproto::ReadRowsResponse> const& batch) {
+        batches.emplace_back();
+        for (auto const& r : batch) {
+          batches.back().push_back(r.last_scanned_row_key());
+        }
+        if (batches.size() == 1) return first.get_future();
+        return make_ready_future(true);
+      },
+      [&on_finish_counter](Status const&) { ++on_finish_counter; },
+      StreamingReadBatchOptions{}.set_max_messages(2));
+
+  mock_cq->SimulateCompletion(true);  // OnStart()
+  mock_cq->SimulateCompletion(true);  // row-0, delivered
+  mock_cq->SimulateCompletion(true);  // row-1, buffered
+  mock_cq->SimulateCompletion(true);  // row-2, buffered
+  // The buffer is full, the stream stops reading.
+  EXPECT_EQ(3, read_count);
+  using ::testing::ElementsAre;
+  EXPECT_THAT(batches, ElementsAre(ElementsAre("row-0")));
+
+  // Completing the handler delivers the buffered messages as a single batch.
+  first.set_value(true);
+  EXPECT_THAT(batches,
+              ElementsAre(ElementsAre("row-0"), ElementsAre("row-1", "row-2")));
+  EXPECT_EQ(4, read_count);
+
+  mock_cq->SimulateCompletion(true);  // row-3, delivered
+  mock_cq->SimulateCompletion(false);  // end of stream
+  EXPECT_THAT(batches,
+              ElementsAre(ElementsAre("row-0"), ElementsAre("row-1", "row-2"),
+                          ElementsAre("row-3")));
+  EXPECT_EQ(0, on_finish_counter);
+  mock_cq->SimulateCompletion(true);
+  EXPECT_EQ(1, on_finish_counter);
+}
+
+/// @test Verify that batched streaming reads honor the `max_bytes()` limit.
+TEST(CompletionQueueTest, MakeBatchedStreamingReadRpcMaxBytes) {
+  auto mock_cq = std::make_shared<MockCompletionQueue>();
+  CompletionQueue cq(mock_cq);
+
+  int read_count = 0;
+  auto mock_reader = google::cloud::internal::make_unique<MockRowReader>();
+  EXPECT_CALL(*mock_reader, StartCall(_)).Times(1);
+  EXPECT_CALL(*mock_reader, Read(_, _))
+      .WillRepeatedly([&](btproto::ReadRowsResponse* r, void*) {
+        r->set_last_scanned_row_key("row-" + std::to_string(read_count++));
+      });
+  EXPECT_CALL(*mock_reader, Finish(_, _)).Times(1);
+
+  MockClient mock_client;
+  EXPECT_CALL(mock_client, AsyncReadRows(_, _, _))
+      .WillOnce([&mock_reader](grpc::ClientContext*,
+                               btproto::ReadRowsRequest const&,
+                               grpc::CompletionQueue*) {
+        return std::unique_ptr<
+            grpc::ClientAsyncReaderInterface<btproto::ReadRowsResponse>>(
+            mock_reader.release());
+      });
+
+  btproto::ReadRowsResponse sample;
+  sample.set_last_scanned_row_key("row-0");
+  auto const message_size = sample.ByteSizeLong();
+
+  std::vector<std::vector<std::string>> batches;
+  promise<bool> first;
+  int on_finish_counter = 0;
+  (void)cq.MakeBatchedStreamingReadRpc(
+      [&mock_client](grpc::ClientContext* context,
+                     btproto::ReadRowsRequest const& request,
+                     grpc::CompletionQueue* cq) {
+        return mock_client.AsyncReadRows(context, request, cq);
+      },
+      btproto::ReadRowsRequest{},
+      google::cloud::internal::make_unique<grpc::ClientContext>(),
+      [&](std::vector<btproto::ReadRowsResponse> const& batch) {
+        batches.emplace_back();
+        for (auto const& r : batch) {
+          batches.back().push_back(r.last_scanned_row_key());
+        }
+        if (batches.size() == 1) return first.get_future();
+        return make_ready_future(true);
+      },
+      [&on_finish_counter](Status const&) { ++on_finish_counter; },
+      StreamingReadBatchOptions{}.set_max_messages(8).set_max_bytes(
+          2 * message_size));
+
+  mock_cq->SimulateCompletion(true);  // OnStart()
+  mock_cq->SimulateCompletion(true);  // row-0, delivered
+  mock_cq->SimulateCompletion(true);  // row-1, buffered
+  mock_cq->SimulateCompletion(true);  // row-2, buffered
+  mock_cq->SimulateCompletion(true);  // row-3, buffered
+  mock_cq->SimulateCompletion(false);  // end of stream
+  EXPECT_EQ(0, on_finish_counter);
+
+  // The buffered messages are split at `max_bytes()`, and all of them are
+  // delivered before the stream finishes.
+  first.set_value(true);
+  using ::testing::ElementsAre;
+  EXPECT_THAT(batches,
+              ElementsAre(ElementsAre("row-0"), ElementsAre("row-1", "row-2"),
+                          ElementsAre("row-3")));
+  mock_cq->SimulateCompletion(true);
+  EXPECT_EQ(1, on_finish_counter);
+}
+
+/// @test Verify that batched streaming reads deliver partial batches once the
+/// `linger()` period expires.
+TEST(CompletionQueueTest, MakeBatchedStreamingReadRpcLinger) {
+  auto mock_cq = std::make_shared<testing_util::MockCompletionQueue>();
+  CompletionQueue cq(mock_cq);
+
+  int read_count = 0;
+  void* read_tag = nullptr;
+  auto mock_reader = google::cloud::internal::make_unique<MockRowReader>();
+  EXPECT_CALL(*mock_reader, StartCall(_)).Times(1);
+  EXPECT_CALL(*mock_reader, Read(_, _))
+      .WillRepeatedly([&](btproto::ReadRowsResponse* r, void* tag) {
+        read_tag = tag;
+        r->set_last_scanned_row_key("row-" + std::to_string(read_count++));
+      });
+  EXPECT_CALL(*mock_reader, Finish(_, _)).Times(1);
+
+  MockClient mock_client;
+  EXPECT_CALL(mock_client, AsyncReadRows(_, _, _))
+      .WillOnce([&mock_reader](grpc::ClientContext*,
+                               btproto::ReadRowsRequest const&,
+                               grpc::CompletionQueue*) {
+        return std::unique_ptr<
+            grpc::ClientAsyncReaderInterface<btproto::ReadRowsResponse>>(
+            mock_reader.release());
+      });
+
+  std::vector<std::vector<std::string>> batches;
+  int on_finish_counter = 0;
+  (void)cq.MakeBatchedStreamingReadRpc(
+      [&mock_client](grpc::ClientContext* context,
+                     btproto::ReadRowsRequest const& request,
+                     grpc::CompletionQueue* cq) {
+        return mock_client.AsyncReadRows(context, request, cq);
+      },
+      btproto::ReadRowsRequest{},
+      google::cloud::internal::make_unique<grpc::ClientContext>(),
+      [&](std::vector<btproto::ReadRowsResponse> const& batch) {
+        batches.emplace_back();
+        for (auto const& r : batch) {
+          batches.back().push_back(r.last_scanned_row_key());
+        }
+        return make_ready_future(true);
+      },
+      [&on_finish_counter](Status const&) { ++on_finish_counter; },
+      StreamingReadBatchOptions{}.set_max_messages(4).set_linger(
+          std::chrono::milliseconds(10)));
+
+  auto complete = [&mock_cq](void* tag, bool ok) {
+    mock_cq->SimulateCompletion(static_cast<AsyncOperation*>(tag), ok);
+  };
+
+  mock_cq->SimulateCompletion(true);  // OnStart()
+  ASSERT_NE(nullptr, read_tag);
+  complete(read_tag, true);  // row-0, buffered
+  auto timers = OtherPendingTags(*mock_cq, {read_tag});
+  ASSERT_EQ(1U, timers.size());
+  EXPECT_TRUE(batches.empty());
+
+  // The linger timer expires and flushes the partial batch.
+  complete(timers[0], true);
+  using ::testing::ElementsAre;
+  EXPECT_THAT(batches, ElementsAre(ElementsAre("row-0")));
+  EXPECT_TRUE(OtherPendingTags(*mock_cq, {read_tag}).empty());
+
+  complete(read_tag, false);  // end of stream
+  EXPECT_EQ(0, on_finish_counter);
+  mock_cq->SimulateCompletion(true);  // Finish()
+  EXPECT_EQ(1, on_finish_counter);
+}
+
+/// @test Verify that a full batch cancels the linger timer for that batch.
+TEST(CompletionQueueTest, MakeBatchedStreamingReadRpcLingerSizeFlush) {
+  auto mock_cq = std::make_shared<testing_util::MockCompletionQueue>();
+  CompletionQueue cq(mock_cq);
+
+  int read_count = 0;
+  void* read_tag = nullptr;
+  auto mock_reader = google::cloud::internal::make_unique<MockRowReader>();
+  EXPECT_CALL(*mock_reader, StartCall(_)).Times(1);
+  EXPECT_CALL(*mock_reader, Read(_, _))
+      .WillRepeatedly([&](btproto::ReadRowsResponse* r, void* tag) {
+        read_tag = tag;
+        r->set_last_scanned_row_key("row-" + std::to_string(read_count++));
+      });
+  EXPECT_CALL(*mock_reader, Finish(_, _)).Times(1);
+
+  MockClient mock_client;
+  EXPECT_CALL(mock_client, AsyncReadRows(_, _, _))
+      .WillOnce([&mock_reader](grpc::ClientContext*,
+                               btproto::ReadRowsRequest const&,
+                               grpc::CompletionQueue*) {
+        return std::unique_ptr<
+            grpc::ClientAsyncReaderInterface<btproto::ReadRowsResponse>>(
+            mock_reader.release());
+      });
+
+  std::vector<std::vector<std::string>> batches;
+  int on_finish_counter = 0;
+  (void)cq.MakeBatchedStreamingReadRpc(
+      [&mock_client](grpc::ClientContext* context,
+                     btproto::ReadRowsRequest const& request,
+                     grpc::CompletionQueue* cq) {
+        return mock_client.AsyncReadRows(context, request, cq);
+      },
+      btproto::ReadRowsRequest{},
+      google::cloud::internal::make_unique<grpc::ClientContext>(),
+      [&](std::vector<btproto::ReadRowsResponse> const& batch) {
+        batches.emplace_back();
+        for (auto const& r : batch) {
+          batches.back().push_back(r.last_scanned_row_key());
+        }
+        return make_ready_future(true);
+      },
+      [&on_finish_counter](Status const&) { ++on_finish_counter; },
+      StreamingReadBatchOptions{}.set_max_messages(2).set_linger(
+          std::chrono::milliseconds(10)));
+
+  auto complete = [&mock_cq](void* tag, bool ok) {
+    mock_cq->SimulateCompletion(static_cast<AsyncOperation*>(tag), ok);
+  };
+
+  mock_cq->SimulateCompletion(true);  // OnStart()
+  ASSERT_NE(nullptr, read_tag);
+  complete(read_tag, true);  // row-0, buffered
+  auto const first_timers = OtherPendingTags(*mock_cq, {read_tag});
+  ASSERT_EQ(1U, first_timers.size());
+  auto* first_timer = first_timers[0];
+
+  // The batch is full, it is delivered without waiting for the timer.
+  complete(read_tag, true);  // row-1, delivered
+  using ::testing::ElementsAre;
+  EXPECT_THAT(batches, ElementsAre(ElementsAre("row-0", "row-1")));
+
+  complete(read_tag, true);  // row-2, buffered, starts a new timer
+  auto const second_timers =
+      OtherPendingTags(*mock_cq, {read_tag, first_timer});
+  ASSERT_EQ(1U, second_timers.size());
+  auto* second_timer = second_timers[0];
+
+  // The first timer was cancelled, even if it fires it must not flush the
+  // second batch early.
+  complete(first_timer, true);
+  EXPECT_THAT(batches, ElementsAre(ElementsAre("row-0", "row-1")));
+
+  complete(second_timer, true);
+  EXPECT_THAT(batches, ElementsAre(ElementsAre("row-0", "row-1"),
+                                   ElementsAre("row-2")));
+
+  complete(read_tag, false);  // end of stream
+  mock_cq->SimulateCompletion(true);  // Finish()
+  EXPECT_EQ(1, on_finish_counter);
+}
+
+/// @test Verify that cancelling a batched stream cancels its linger timer.
+TEST(CompletionQueueTest, MakeBatchedStreamingReadRpcLingerCancel) {
+  auto mock_cq = std::make_shared<testing_util::MockCompletionQueue>();
+  CompletionQueue cq(mock_cq);
+
+  int read_count = 0;
+  void* read_tag = nullptr;
+  auto mock_reader = google::cloud::internal::make_unique<MockRowReader>();
+  EXPECT_CALL(*mock_reader, StartCall(_)).Times(1);
+  EXPECT_CALL(*mock_reader, Read(_, _))
+      .WillRepeatedly([&](btproto::ReadRowsResponse* r, void* tag) {
+        read_tag = tag;
+        r->set_last_scanned_row_key("row-" + std::to_string(read_count++));
+      });
+  EXPECT_CALL(*mock_reader, Finish(_, _)).Times(1);
+
+  MockClient mock_client;
+  EXPECT_CALL(mock_client, AsyncReadRows(_, _, _))
+      .WillOnce([&mock_reader](grpc::ClientContext*,
+                               btproto::ReadRowsRequest const&,
+                               grpc::CompletionQueue*) {
+        return std::unique_ptr<
+            grpc::ClientAsyncReaderInterface<btproto::ReadRowsResponse>>(
+            mock_reader.release());
+      });
+
+  std::vector<std::vector<std::string>> batches;
+  int on_finish_counter = 0;
+  auto op = cq.MakeBatchedStreamingReadRpc(
+      [&mock_client](grpc::ClientContext* context,
+                     btproto::ReadRowsRequest const& request,
+                     grpc::CompletionQueue* cq) {
+        return mock_client.AsyncReadRows(context, request, cq);
+      },
+      btproto::ReadRowsRequest{},
+      google::cloud::internal::make_unique<grpc::ClientContext>(),
+      [&](std::vector<btproto::ReadRowsResponse> const& batch) {
+        batches.emplace_back();
+        for (auto const& r : batch) {
+          batches.back().push_back(r.last_scanned_row_key());
+        }
+        return make_ready_future(true);
+      },
+      [&on_finish_counter](Status const&) { ++on_finish_counter; },
+      StreamingReadBatchOptions{}.set_max_messages(4).set_linger(
+          std::chrono::milliseconds(10)));
+
+  auto complete = [&mock_cq](void* tag, bool ok) {
+    mock_cq->SimulateCompletion(static_cast<AsyncOperation*>(tag), ok);
+  };
+
+  mock_cq->SimulateCompletion(true);  // OnStart()
+  ASSERT_NE(nullptr, read_tag);
+  complete(read_tag, true);  // row-0, buffered
+  auto const timers = OtherPendingTags(*mock_cq, {read_tag});
+  ASSERT_EQ(1U, timers.size());
+
+  op->Cancel();
+  // The timer was cancelled, even if it fires it does not flush the batch.
+  complete(timers[0], true);
+  EXPECT_TRUE(batches.empty());
+
+  // Any buffered messages are delivered before the stream finishes.
+  complete(read_tag, false);  // end of stream
+  using ::testing::ElementsAre;
+  EXPECT_THAT(batches, ElementsAre(ElementsAre("row-0")));
+  mock_cq->SimulateCompletion(true);  // Finish()
+  EXPECT_EQ(1, on_finish_counter);
+}
+
+/// @test Verify that streaming reads collect statistics when requested.
+TEST(CompletionQueueTest, MakeStreamingReadRpcStats) {
+  auto mock_cq = std::make_shared<MockCompletionQueue>();
+  CompletionQueue cq(mock_cq);
+
+  int read_count = 0;
+  std::int64_t expected_bytes = 0;
+  auto mock_reader = google::cloud::internal::make_unique<MockRowReader>();
+  EXPECT_CALL(*mock_reader, StartCall(_)).Times(1);
+  EXPECT_CALL(*mock_reader, Read(_, _))
+      .WillRepeatedly([&](btproto::ReadRowsResponse* r, void*) {
+        r->set_last_scanned_row_key("row-" + std::to_string(read_count++));
+        if (read_count <= 2) expected_bytes += r->ByteSizeLong();
+      });
+  EXPECT_CALL(*mock_reader, Finish(_, _)).Times(1);
+
+  MockClient mock_client;
+  EXPECT_CALL(mock_client, AsyncReadRows(_, _, _))
+      .WillOnce([&mock_reader](grpc::ClientContext*,
+                               btproto::ReadRowsRequest const&,
+                               grpc::CompletionQueue*) {
+        return std::unique_ptr<
+            grpc::ClientAsyncReaderInterface<btproto::ReadRowsResponse>>(
+            mock_reader.release());
+      });
+
+  auto op = cq.MakeStreamingReadRpc(
+      [&mock_client](grpc::ClientContext* context,
+                     btproto::ReadRowsRequest const& request,
+                     grpc::CompletionQueue* cq) {
+        return mock_client.AsyncReadRows(context, request, cq);
+      },
+      btproto::ReadRowsRequest{},
+      google::cloud::internal::make_unique<grpc::ClientContext>(),
+      [](btproto::ReadRowsResponse const&) { return true; },
+      [](Status const&) {}, /*read_ahead=*/0, /*collect_stats=*/true);
+
+  mock_cq->SimulateCompletion(true);  // OnStart()
+  mock_cq->SimulateCompletion(true);  // row-0
+  mock_cq->SimulateCompletion(true);  // row-1
+  auto stats = op->stats();
+  EXPECT_EQ(2, stats.messages);
+  EXPECT_EQ(expected_bytes, stats.bytes);
+  EXPECT_LE(stats.max_message_gap, stats.total_message_gap);
+  EXPECT_FALSE(stats.finished);
+
+  mock_cq->SimulateCompletion(false);  // end of stream
+  mock_cq->SimulateCompletion(true);   // Finish()
+  stats = op->stats();
+  EXPECT_EQ(2, stats.messages);
+  EXPECT_TRUE(stats.finished);
+  EXPECT_STATUS_OK(stats.status);
+  EXPECT_EQ(0, stats.discard_time.count());
+}
+
 TEST(CompletionQueueTest, MakeRpcsAfterShutdown) {
   using ms = std::chrono::milliseconds;
 
@@ -330,6 +1111,37 @@ TEST(CompletionQueueTest, RunAsync) {
   runner.join();
 }
 
+#if GOOGLE_CLOUD_CPP_HAVE_COROUTINES
+namespace {
+future<std::thread::id> AwaitOnQueue(CompletionQueue cq, future<int> f) {
+  co_await cq.MakeAwaitable(std::move(f));
+  co_return std::this_thread::get_id();
+}
+}  // namespace
+
+TEST(CompletionQueueTest, MakeAwaitable) {
+  CompletionQueue cq;
+  promise<std::thread::id> runner_id;
+  std::thread runner([&cq, &runner_id] {
+    runner_id.set_value(std::this_thread::get_id());
+    cq.Run();
+  });
+  auto expected = runner_id.get_future().get();
+
+  // A satisfied future still hops to the completion queue thread.
+  EXPECT_EQ(expected, AwaitOnQueue(cq, make_ready_future(0)).get());
+
+  // So does a future satisfied by a different thread.
+  promise<int> p;
+  auto actual = AwaitOnQueue(cq, p.get_future());
+  std::thread([&p] { p.set_value(42); }).join();
+  EXPECT_EQ(expected, actual.get());
+
+  cq.Shutdown();
+  runner.join();
+}
+#endif  // GOOGLE_CLOUD_CPP_HAVE_COROUTINES
+
 // Sets up a timer that reschedules itself and verifies we can shut down
 // cleanly whether we call `CancelAll()` on the queue first or not.
 namespace {
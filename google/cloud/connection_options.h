@@ -15,8 +15,10 @@
 #ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_CONNECTION_OPTIONS_H
 #define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_CONNECTION_OPTIONS_H
 
+#include "google/cloud/adaptive_throttler.h"
 #include "google/cloud/completion_queue.h"
 #include "google/cloud/internal/background_threads_impl.h"
+#include "google/cloud/retry_budget.h"
 #include "google/cloud/status_or.h"
 #include "google/cloud/tracing_options.h"
 #include <grpcpp/grpcpp.h>
@@ -217,6 +219,49 @@ class ConnectionOptions {
     return background_threads_factory_;
   }
 
+  /**
+   * Limit the retries for all the requests in clients configured with this
+   * object.
+   *
+   * By default each request retries independently, as configured by its retry
+   * policy. With a budget the retries of all requests (in all the clients
+   * sharing the budget) are capped at a fraction of the successful requests.
+   * This prevents the retries from multiplying the load on a service that is
+   * already failing. Use `RetryBudget::counters()` to find out how often the
+   * budget was exhausted. Used by `internal::WithRetryBudget()`.
+   *
+   * The default is `nullptr`, meaning there is no budget.
+   */
+  ConnectionOptions& set_retry_budget(std::shared_ptr<RetryBudget> v) {
+    retry_budget_ = std::move(v);
+    return *this;
+  }
+
+  /// The retry budget shared by clients configured with this object, if any.
+  std::shared_ptr<RetryBudget> retry_budget() const { return retry_budget_; }
+
+  /**
+   * Reject requests locally when the service is overloaded.
+   *
+   * With a throttler, clients configured with this object reject a fraction
+   * of their requests (with `kUnavailable`) when the service rejects too many
+   * requests due to overload. These requests fail without a network round
+   * trip, and the service can recover faster. See `AdaptiveThrottler` for
+   * details. Passed to `internal::RpcAttemptOptions::set_throttler()`.
+   *
+   * The default is `nullptr`, meaning there is no client-side throttling.
+   */
+  ConnectionOptions& set_adaptive_throttler(
+      std::shared_ptr<AdaptiveThrottler> v) {
+    adaptive_throttler_ = std::move(v);
+    return *this;
+  }
+
+  /// The throttler shared by clients configured with this object, if any.
+  std::shared_ptr<AdaptiveThrottler> adaptive_throttler() const {
+    return adaptive_throttler_;
+  }
+
  private:
   std::shared_ptr<grpc::ChannelCredentials> credentials_;
   std::string endpoint_;
@@ -227,6 +272,8 @@ class ConnectionOptions {
 
   std::string user_agent_prefix_;
   BackgroundThreadsFactory background_threads_factory_;
+  std::shared_ptr<RetryBudget> retry_budget_;
+  std::shared_ptr<AdaptiveThrottler> adaptive_throttler_;
 };
 
 }  // namespace GOOGLE_CLOUD_CPP_NS
@@ -187,6 +187,28 @@ TEST(ConnectionOptionsTest, CustomBackgroundThreads) {
   t.join();
 }
 
+TEST(ConnectionOptionsTest, RetryBudget) {
+  TestConnectionOptions options(grpc::InsecureChannelCredentials());
+  EXPECT_FALSE(options.retry_budget());
+
+  auto budget = std::make_shared<RetryBudget>();
+  options.set_retry_budget(budget);
+  EXPECT_EQ(budget, options.retry_budget());
+
+  // Copies of the options share the budget.
+  auto copy = options;
+  EXPECT_EQ(budget, copy.retry_budget());
+}
+
+TEST(ConnectionOptionsTest, AdaptiveThrottler) {
+  TestConnectionOptions options(grpc::InsecureChannelCredentials());
+  EXPECT_FALSE(options.adaptive_throttler());
+
+  auto throttler = std::make_shared<AdaptiveThrottler>();
+  options.set_adaptive_throttler(throttler);
+  EXPECT_EQ(throttler, options.adaptive_throttler());
+}
+
 TEST(ConnectionOptionsTest, DefaultTracingComponentsNoEnvironment) {
   testing_util::ScopedEnvironment env("GOOGLE_CLOUD_CPP_ENABLE_TRACING", {});
   auto const actual = internal::DefaultTracingComponents();
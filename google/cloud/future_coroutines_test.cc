@@ -0,0 +1,116 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/future.h"
+#include "google/cloud/testing_util/expect_future_error.h"
+#include <gmock/gmock.h>
+#include <thread>
+
+namespace google {
+namespace cloud {
+inline namespace GOOGLE_CLOUD_CPP_NS {
+namespace {
+#if GOOGLE_CLOUD_CPP_HAVE_COROUTINES
+
+future<int> AddOne(future<int> f) {
+  auto value = co_await std::move(f);
+  co_return value + 1;
+}
+
+future<void> Capture(future<int> f, int& result, std::thread::id& resumed_on) {
+  result = co_await std::move(f);
+  resumed_on = std::this_thread::get_id();
+}
+
+/// @test Verify that awaiting a satisfied future does not suspend.
+TEST(FutureCoroutinesTest, AwaitReady) {
+  auto r = AddOne(make_ready_future(41));
+  ASSERT_TRUE(r.is_ready());
+  EXPECT_EQ(42, r.get());
+}
+
+/// @test Verify that awaiting suspends until the future is satisfied.
+TEST(FutureCoroutinesTest, AwaitPending) {
+  promise<int> p;
+  auto r = AddOne(p.get_future());
+  EXPECT_FALSE(r.is_ready());
+  p.set_value(41);
+  ASSERT_TRUE(r.is_ready());
+  EXPECT_EQ(42, r.get());
+}
+
+/// @test Verify that the coroutine resumes in the thread satisfying the future.
+TEST(FutureCoroutinesTest, ResumesInSettingThread) {
+  promise<int> p;
+  int result = 0;
+  std::thread::id resumed_on;
+  auto r = Capture(p.get_future(), result, resumed_on);
+  EXPECT_FALSE(r.is_ready());
+
+  std::thread::id setter;
+  std::thread t([&p, &setter] {
+    setter = std::this_thread::get_id();
+    p.set_value(42);
+  });
+  r.get();
+  t.join();
+  EXPECT_EQ(42, result);
+  EXPECT_EQ(setter, resumed_on);
+}
+
+/// @test Verify that coroutines can chain other coroutines.
+TEST(FutureCoroutinesTest, Chain) {
+  promise<int> p;
+  auto r = AddOne(AddOne(AddOne(p.get_future())));
+  EXPECT_FALSE(r.is_ready());
+  p.set_value(0);
+  EXPECT_EQ(3, r.get());
+}
+
+/// @test Verify that awaiting a future without a shared state fails.
+TEST(FutureCoroutinesTest, AwaitInvalid) {
+  future<int> invalid;
+  testing_util::ExpectFutureError(
+      [&] { AddOne(std::move(invalid)).get(); }, std::future_errc::no_state);
+}
+
+#if GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+future<int> Throws(future<int> f) {
+  auto value = co_await std::move(f);
+  if (value < 0) throw std::runtime_error("negative");
+  co_return value;
+}
+
+/// @test Verify that exceptions propagate to the returned future.
+TEST(FutureCoroutinesTest, ExceptionInBody) {
+  promise<int> p;
+  auto r = Throws(p.get_future());
+  p.set_value(-1);
+  EXPECT_THROW(r.get(), std::runtime_error);
+}
+
+/// @test Verify that exceptions in the awaited future propagate too.
+TEST(FutureCoroutinesTest, ExceptionInAwaited) {
+  promise<int> p;
+  auto r = AddOne(p.get_future());
+  p.set_exception(std::make_exception_ptr(std::runtime_error("test")));
+  EXPECT_THROW(r.get(), std::runtime_error);
+}
+#endif  // GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+
+#endif  // GOOGLE_CLOUD_CPP_HAVE_COROUTINES
+}  // namespace
+}  // namespace GOOGLE_CLOUD_CPP_NS
+}  // namespace cloud
+}  // namespace google
@@ -18,6 +18,7 @@
 #include "google/cloud/testing_util/expect_future_error.h"
 #include <gmock/gmock.h>
 #include <functional>
+#include <string>
 
 namespace google {
 namespace cloud {
@@ -112,6 +113,47 @@ TEST(FutureTestInt, ThenUnwrap) {
   EXPECT_FALSE(next.valid());
 }
 
+/// @test Verify unwrapping works when the returned future is already ready.
+TEST(FutureTestInt, ThenUnwrapReady) {
+  promise<int> p;
+  future<std::string> next = p.get_future().then([](future<int> f) {
+    return make_ready_future("value=" + std::to_string(f.get()));
+  });
+  EXPECT_FALSE(next.is_ready());
+  p.set_value(42);
+  EXPECT_TRUE(next.is_ready());
+  EXPECT_EQ("value=42", next.get());
+}
+
+/// @test Verify unwrapping forwards exceptions from the returned future.
+TEST(FutureTestInt, ThenUnwrapInnerException) {
+  promise<int> p;
+  promise<std::string> pp;
+  future<std::string> next =
+      p.get_future().then([&pp](future<int>) { return pp.get_future(); });
+  p.set_value(42);
+  EXPECT_FALSE(next.is_ready());
+#if GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+  pp.set_exception(std::make_exception_ptr(std::runtime_error("test")));
+  EXPECT_TRUE(next.is_ready());
+  EXPECT_THROW(next.get(), std::runtime_error);
+#else
+  pp.set_exception(nullptr);
+  EXPECT_TRUE(next.is_ready());
+#endif  // GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+}
+
+/// @test Verify long chains of unwrapping continuations work.
+TEST(FutureTestInt, ThenUnwrapChain) {
+  promise<int> p;
+  future<int> f = p.get_future();
+  for (int i = 0; i != 100; ++i) {
+    f = f.then([](future<int> g) { return make_ready_future(g.get() + 1); });
+  }
+  p.set_value(0);
+  EXPECT_EQ(100, f.get());
+}
+
 TEST(FutureTestInt, ThenMoveOnlyCallable) {
   class MoveOnlyDoubler {
    public:
@@ -188,6 +230,49 @@ TEST(FutureTestInt, CancelThroughContinuation) {
   EXPECT_EQ(84, f1.get());
 }
 
+/// @test Verify cancellation reaches the future returned by the functor.
+TEST(FutureTestInt, CancelThroughUnwrappingContinuation) {
+  bool outer_cancelled = false;
+  bool inner_cancelled = false;
+  promise<int> p0([&outer_cancelled] { outer_cancelled = true; });
+  promise<int> p1([&inner_cancelled] { inner_cancelled = true; });
+  auto f1 = p1.get_future();
+  auto f = p0.get_future().then([&f1](future<int> g) {
+    auto value = g.get();
+    return f1.then([value](future<int> h) { return h.get() + value; });
+  });
+  p0.set_value(1);
+  EXPECT_TRUE(f.cancel());
+  EXPECT_FALSE(outer_cancelled);
+  EXPECT_TRUE(inner_cancelled);
+  EXPECT_FALSE(f.cancel());
+  p1.set_value(2);
+  EXPECT_EQ(3, f.get());
+}
+
+/// @test Verify cancellation requests are forwarded once the functor runs.
+TEST(FutureTestInt, CancelBeforeUnwrappingContinuationRuns) {
+  int outer_cancelled = 0;
+  int inner_cancelled = 0;
+  promise<int> p0([&outer_cancelled] { ++outer_cancelled; });
+  promise<int> p1([&inner_cancelled] { ++inner_cancelled; });
+  auto f1 = p1.get_future();
+  auto f = p0.get_future().then([&f1](future<int> g) {
+    auto value = g.get();
+    return f1.then([value](future<int> h) { return h.get() + value; });
+  });
+  EXPECT_TRUE(f.cancel());
+  EXPECT_EQ(1, outer_cancelled);
+  EXPECT_EQ(0, inner_cancelled);
+  // The cancellation request is "sticky", the inner future is cancelled as
+  // soon as it is created.
+  p0.set_value(1);
+  EXPECT_EQ(1, inner_cancelled);
+  p1.set_value(2);
+  EXPECT_EQ(3, f.get());
+  EXPECT_EQ(1, outer_cancelled);
+}
+
 // The following tests reference the technical specification:
 //   http://www.open-std.org/jtc1/sc22/wg21/docs/papers/2015/p0159r0.html
 // The test names match the section and paragraph from the TS.
@@ -101,7 +101,25 @@ class future<void> final : private internal::future_base<void> {
     check_valid();
     using requires_unwrap_t =
         typename internal::then_helper<F, void>::requires_unwrap_t;
-    return then_impl(std::forward<F>(func), requires_unwrap_t{});
+    return then_impl(std::forward<F>(func),
+                     this->shared_state_->memory_resource(),
+                     requires_unwrap_t{});
+  }
+
+  /**
+   * Attach a continuation to the future, allocating it from @p resource.
+   *
+   * This is the same as `then(func)`, but the continuation, and the shared
+   * state for the returned future, are allocated using @p resource. By default
+   * `then()` uses the same resource as the shared state of `*this`.
+   */
+  template <typename F>
+  typename internal::then_helper<F, void>::future_t then(
+      std::allocator_arg_t, MemoryResource* resource, F&& func) {
+    check_valid();
+    using requires_unwrap_t =
+        typename internal::then_helper<F, void>::requires_unwrap_t;
+    return then_impl(std::forward<F>(func), resource, requires_unwrap_t{});
   }
 
   explicit future(std::shared_ptr<shared_state_type> state)
@@ -110,16 +128,18 @@ class future<void> final : private internal::future_base<void> {
  private:
   /// Implement `then()` if the result does not require unwrapping.
   template <typename F>
-  typename internal::then_helper<F, void>::future_t then_impl(F&& functor,
-                                                              std::false_type);
+  typename internal::then_helper<F, void>::future_t then_impl(
+      F&& functor, MemoryResource* resource, std::false_type);
 
   /// Implement `then()` if the result requires unwrapping.
   template <typename F>
-  typename internal::then_helper<F, void>::future_t then_impl(F&& functor,
-                                                              std::true_type);
+  typename internal::then_helper<F, void>::future_t then_impl(
+      F&& functor, MemoryResource* resource, std::true_type);
 
   template <typename U>
   friend class future;
+  template <typename U>
+  friend class internal::future_awaiter;
 };
 
 /**
@@ -129,9 +149,22 @@ template <>
 class promise<void> final : private internal::promise_base<void> {
  public:
   /// Creates a promise with an unsatisfied shared state.
-  promise(std::function<void()> cancellation_callback = [] {})
+  promise(std::function<void()> cancellation_callback = {})
       : promise_base(cancellation_callback) {}
 
+  /**
+   * Creates a promise with an unsatisfied shared state allocated from
+   * @p resource.
+   *
+   * Continuations attached to the future, and the shared states they create,
+   * are also allocated from @p resource, unless the application provides a
+   * different resource to `future<void>::then()`. The resource must outlive
+   * the shared state and any continuations.
+   */
+  promise(std::allocator_arg_t, MemoryResource* resource,
+          std::function<void()> cancellation_callback = {})
+      : promise_base(resource, std::move(cancellation_callback)) {}
+
   /// Constructs a new promise and transfer any shared state from @p rhs.
   promise(promise&&) noexcept = default;
 
@@ -17,6 +17,8 @@
 """Automatically generated source lists for google_cloud_cpp_common - DO NOT EDIT."""
 
 google_cloud_cpp_common_hdrs = [
+    "adaptive_throttler.h",
+    "async_log_backend.h",
     "future.h",
     "future_generic.h",
     "future_void.h",
@@ -26,21 +28,25 @@ google_cloud_cpp_common_hdrs = [
     "internal/backoff_policy.h",
     "internal/big_endian.h",
     "internal/build_info.h",
+    "internal/coarse_clock.h",
     "internal/compiler_info.h",
     "internal/conjunction.h",
     "internal/disjunction.h",
     "internal/filesystem.h",
     "internal/format_time_point.h",
     "internal/future_base.h",
+    "internal/future_coroutines.h",
     "internal/future_fwd.h",
     "internal/future_impl.h",
     "internal/future_then_impl.h",
     "internal/future_then_meta.h",
     "internal/getenv.h",
+    "internal/hedging_policy.h",
     "internal/invoke_result.h",
     "internal/ios_flags_saver.h",
     "internal/make_unique.h",
     "internal/parse_rfc3339.h",
+    "internal/policy_traits.h",
     "internal/port_platform.h",
     "internal/random.h",
     "internal/retry_policy.h",
@@ -50,7 +56,9 @@ google_cloud_cpp_common_hdrs = [
     "internal/utility.h",
     "internal/version_info.h",
     "log.h",
+    "memory_resource.h",
     "optional.h",
+    "retry_budget.h",
     "status.h",
     "status_or.h",
     "terminate_handler.h",
@@ -59,19 +67,25 @@ google_cloud_cpp_common_hdrs = [
 ]
 
 google_cloud_cpp_common_srcs = [
+    "adaptive_throttler.cc",
+    "async_log_backend.cc",
     "iam_bindings.cc",
     "iam_policy.cc",
     "internal/backoff_policy.cc",
+    "internal/coarse_clock.cc",
     "internal/compiler_info.cc",
     "internal/filesystem.cc",
     "internal/format_time_point.cc",
     "internal/future_impl.cc",
     "internal/getenv.cc",
+    "internal/hedging_policy.cc",
     "internal/parse_rfc3339.cc",
     "internal/random.cc",
     "internal/setenv.cc",
     "internal/throw_delegate.cc",
     "log.cc",
+    "memory_resource.cc",
+    "retry_budget.cc",
     "status.cc",
     "terminate_handler.cc",
     "tracing_options.cc",
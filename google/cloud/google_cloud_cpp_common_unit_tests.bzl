@@ -17,6 +17,9 @@
 """Automatically generated unit tests list - DO NOT EDIT."""
 
 google_cloud_cpp_common_unit_tests = [
+    "adaptive_throttler_test.cc",
+    "async_log_backend_test.cc",
+    "future_coroutines_test.cc",
     "future_generic_test.cc",
     "future_generic_then_test.cc",
     "future_void_test.cc",
@@ -24,11 +27,13 @@ google_cloud_cpp_common_unit_tests = [
     "iam_bindings_test.cc",
     "internal/backoff_policy_test.cc",
     "internal/big_endian_test.cc",
+    "internal/coarse_clock_test.cc",
     "internal/compiler_info_test.cc",
     "internal/env_test.cc",
     "internal/filesystem_test.cc",
     "internal/format_time_point_test.cc",
     "internal/future_impl_test.cc",
+    "internal/hedging_policy_test.cc",
     "internal/invoke_result_test.cc",
     "internal/parse_rfc3339_test.cc",
     "internal/random_test.cc",
@@ -37,7 +42,9 @@ google_cloud_cpp_common_unit_tests = [
     "internal/tuple_test.cc",
     "internal/utility_test.cc",
     "log_test.cc",
+    "memory_resource_test.cc",
     "optional_test.cc",
+    "retry_budget_test.cc",
     "status_or_test.cc",
     "status_test.cc",
     "terminate_handler_test.cc",
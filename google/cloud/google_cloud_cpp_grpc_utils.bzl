@@ -26,11 +26,19 @@ google_cloud_cpp_grpc_utils_hdrs = [
     "grpc_utils/completion_queue.h",
     "grpc_utils/grpc_error_delegate.h",
     "grpc_utils/version.h",
+    "internal/async_hedged_unary_rpc.h",
+    "internal/async_pagination_range.h",
     "internal/async_read_stream_impl.h",
+    "internal/async_retry_streaming_read_rpc.h",
     "internal/async_retry_unary_rpc.h",
     "internal/background_threads_impl.h",
     "internal/completion_queue_impl.h",
     "internal/pagination_range.h",
+    "internal/retry_info.h",
+    "internal/rpc_attempt_options.h",
+    "internal/streaming_read_stats_recorder.h",
+    "streaming_read_batch_options.h",
+    "streaming_read_stats.h",
 ]
 
 google_cloud_cpp_grpc_utils_srcs = [
@@ -39,4 +47,7 @@ google_cloud_cpp_grpc_utils_srcs = [
     "grpc_error_delegate.cc",
     "internal/background_threads_impl.cc",
     "internal/completion_queue_impl.cc",
+    "internal/retry_info.cc",
+    "internal/rpc_attempt_options.cc",
+    "internal/streaming_read_stats_recorder.cc",
 ]
@@ -20,7 +20,13 @@ google_cloud_cpp_grpc_utils_unit_tests = [
     "completion_queue_test.cc",
     "connection_options_test.cc",
     "grpc_error_delegate_test.cc",
+    "internal/async_hedged_unary_rpc_test.cc",
+    "internal/async_pagination_range_test.cc",
+    "internal/async_retry_streaming_read_rpc_test.cc",
     "internal/async_retry_unary_rpc_test.cc",
     "internal/background_threads_impl_test.cc",
     "internal/pagination_range_test.cc",
+    "internal/retry_info_test.cc",
+    "internal/rpc_attempt_options_test.cc",
+    "internal/streaming_read_stats_recorder_test.cc",
 ]
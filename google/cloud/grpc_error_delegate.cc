@@ -62,13 +62,12 @@ google::cloud::StatusCode MapStatusCode(grpc::StatusCode const& code) {
 }  // namespace
 
 google::cloud::Status MakeStatusFromRpcError(grpc::Status const& status) {
-  return MakeStatusFromRpcError(status.error_code(), status.error_message());
+  return google::cloud::Status(MapStatusCode(status.error_code()),
+                               status.error_message(), status.error_details());
 }
 
 google::cloud::Status MakeStatusFromRpcError(grpc::StatusCode code,
                                              std::string what) {
-  // TODO(#1912): Pass along status.error_details() once we have absl::Status
-  // or some version that supports binary blobs of data.
   return google::cloud::Status(MapStatusCode(code), std::move(what));
 }
 
@@ -80,7 +79,8 @@ google::cloud::Status MakeStatusFromRpcError(
           static_cast<std::int32_t>(StatusCode::kUnauthenticated)) {
     code = static_cast<StatusCode>(status.code());
   }
-  return Status(code, status.message());
+  if (status.details_size() == 0) return Status(code, status.message());
+  return Status(code, status.message(), status.SerializeAsString());
 }
 
 }  // namespace GOOGLE_CLOUD_CPP_NS
@@ -106,6 +106,25 @@ TEST(MakeStatusFromRpcError, ProtoInvalidCode) {
   }
 }
 
+TEST(MakeStatusFromRpcError, ErrorDetails) {
+  google::rpc::Status proto;
+  proto.set_code(grpc::StatusCode::UNAVAILABLE);
+  proto.set_message("try-again");
+  EXPECT_TRUE(MakeStatusFromRpcError(proto).error_details().empty());
+
+  google::rpc::Status detail;
+  detail.set_message("nested");
+  proto.add_details()->PackFrom(detail);
+  auto const from_proto = MakeStatusFromRpcError(proto);
+  EXPECT_EQ(proto.SerializeAsString(), from_proto.error_details());
+
+  grpc::Status const original(grpc::StatusCode::UNAVAILABLE, "try-again",
+                              proto.SerializeAsString());
+  auto const from_grpc = MakeStatusFromRpcError(original);
+  EXPECT_EQ(StatusCode::kUnavailable, from_grpc.code());
+  EXPECT_EQ(original.error_details(), from_grpc.error_details());
+}
+
 }  // namespace
 }  // namespace GOOGLE_CLOUD_CPP_NS
 }  // namespace cloud
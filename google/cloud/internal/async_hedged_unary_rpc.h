@@ -0,0 +1,340 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_INTERNAL_ASYNC_HEDGED_UNARY_RPC_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_INTERNAL_ASYNC_HEDGED_UNARY_RPC_H
+
+#include "google/cloud/completion_queue.h"
+#include "google/cloud/internal/hedging_policy.h"
+#include "google/cloud/internal/make_unique.h"
+#include "google/cloud/version.h"
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace google {
+namespace cloud {
+inline namespace GOOGLE_CLOUD_CPP_NS {
+namespace internal {
+
+/**
+ * Make an asynchronous unary RPC, hedging slow attempts.
+ *
+ * This class creates a future<> that becomes satisfied when:
+ *
+ * - Any attempt succeeds.
+ * - An attempt fails with a non-retryable error.
+ * - All the attempts fail, and no more attempts are allowed.
+ * - The application cancels the returned future.
+ *
+ * The class starts a new attempt if the attempts in progress have not
+ * completed after the delay set by the hedging policy. The first successful
+ * attempt wins, and the remaining attempts are cancelled, which calls
+ * `grpc::ClientContext::TryCancel()` for each of them. If an attempt fails
+ * with a retryable error, and no other attempts are in progress, the class
+ * starts a new attempt immediately. In any case the number of attempts is
+ * limited by both the hedging policy and the retry policy.
+ *
+ * Only idempotent requests are hedged, non-idempotent requests make a single
+ * attempt.
+ *
+ * @tparam RPCRetryPolicy the type of the retry policy.
+ * @tparam AsyncCallType the type of the callable used to start the asynchronous
+ *     operation. This is typically a lambda that wraps both the `Client` object
+ *     and the member function to invoke.
+ * @tparam RequestType the type of the request object.
+ */
+template <typename RPCRetryPolicy, typename AsyncCallType,
+          typename RequestType>
+class AsyncHedgedUnaryRpc {
+ public:
+  //@{
+  /// @name Convenience aliases for the RPC request and response types.
+  using Request = RequestType;
+  using Response =
+      typename AsyncCallResponseType<AsyncCallType, RequestType>::type;
+  //@}
+
+  /**
+   * Start the hedged call.
+   *
+   * @param cq the completion queue where the attempts and timers run.
+   * @param location typically the name of the function that created this
+   *     call.
+   * @param rpc_retry_policy controls which errors are retryable, and the
+   *     maximum number of failures.
+   * @param hedging_policy controls the number of attempts, when they start,
+   *     and the budget for the additional attempts.
+   * @param is_idempotent if false the call makes a single attempt.
+   * @param async_call the callable to start a new asynchronous operation.
+   * @param request the parameters of the request.
+   * @return a future that becomes satisfied with the result of the first
+   *     successful attempt, or with the last error.
+   */
+  static future<StatusOr<Response>> Start(
+      CompletionQueue cq, char const* location,
+      std::unique_ptr<RPCRetryPolicy> rpc_retry_policy,
+      HedgingPolicy hedging_policy, bool is_idempotent,
+      AsyncCallType async_call, Request request) {
+    std::shared_ptr<AsyncHedgedUnaryRpc> self(new AsyncHedgedUnaryRpc(
+        location, std::move(rpc_retry_policy), std::move(hedging_policy),
+        is_idempotent, std::move(async_call), std::move(request)));
+    auto future = self->final_result_.get_future();
+    StartAttempt(self, std::move(cq));
+    return future;
+  }
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  // The constructor is private because we always want to wrap the object in
+  // a shared pointer. The lifetime is controlled by any pending operations in
+  // the CompletionQueue.
+  AsyncHedgedUnaryRpc(char const* location,
+                      std::unique_ptr<RPCRetryPolicy> rpc_retry_policy,
+                      HedgingPolicy hedging_policy, bool is_idempotent,
+                      AsyncCallType async_call, Request request)
+      : location_(location),
+        rpc_retry_policy_(std::move(rpc_retry_policy)),
+        hedging_policy_(std::move(hedging_policy)),
+        max_attempts_(is_idempotent ? hedging_policy_.max_attempts() : 1),
+        is_idempotent_(is_idempotent),
+        async_call_(std::move(async_call)),
+        request_(std::move(request)),
+        start_(Clock::now()),
+        state_(std::make_shared<State>()),
+        final_result_(MakeCancellationCallback(state_)) {}
+
+  /**
+   * The state shared with the cancellation callback.
+   *
+   * The future returned by `Start()` may outlive this object, so its
+   * cancellation callback shares this state instead of capturing `this`. The
+   * mutex also protects the other (non-const) members of this class.
+   */
+  struct State {
+    std::mutex mu;
+    bool cancelled = false;
+    /// Set once the final result is (about to be) set.
+    bool done = false;
+    /// The attempts and the hedging timer, cancelled when the call is done.
+    std::vector<future<void>> pending;
+  };
+
+  static std::function<void()> MakeCancellationCallback(
+      std::shared_ptr<State> state) {
+    return [state] {
+      std::unique_lock<std::mutex> lk(state->mu);
+      state->cancelled = true;
+      auto pending = std::move(state->pending);
+      lk.unlock();
+      for (auto& f : pending) f.cancel();
+    };
+  }
+
+  /// Save @p f so it can be cancelled, or cancel it if the call is done.
+  void AddPending(future<void> f) {
+    std::unique_lock<std::mutex> lk(state_->mu);
+    if (!state_->done && !state_->cancelled) {
+      state_->pending.push_back(std::move(f));
+      return;
+    }
+    lk.unlock();
+    f.cancel();
+  }
+
+  /// Start a new attempt, and the timer to hedge it if needed.
+  static void StartAttempt(std::shared_ptr<AsyncHedgedUnaryRpc> self,
+                           CompletionQueue cq) {
+    std::unique_lock<std::mutex> lk(self->state_->mu);
+    if (self->state_->done) return;
+    ++self->started_;
+    ++self->in_flight_;
+    bool const hedge = self->started_ < self->max_attempts_ &&
+                       !self->hedging_stopped_ && !self->timer_pending_;
+    if (hedge) self->timer_pending_ = true;
+    lk.unlock();
+
+    auto context =
+        ::google::cloud::internal::make_unique<grpc::ClientContext>();
+    self->AddPending(
+        cq.MakeUnaryRpc(self->async_call_, self->request_, std::move(context))
+            .then([self, cq](future<StatusOr<Response>> f) {
+              OnAttempt(self, cq, f.get());
+            }));
+    if (!hedge) return;
+    self->AddPending(
+        cq.MakeRelativeTimer(self->hedging_policy_.hedging_delay())
+            .then([self, cq](
+                      future<StatusOr<std::chrono::system_clock::time_point>>
+                          f) { OnHedgingTimer(self, cq, f.get().ok()); }));
+  }
+
+  /// The callback for the hedging timer.
+  static void OnHedgingTimer(std::shared_ptr<AsyncHedgedUnaryRpc> self,
+                             CompletionQueue cq, bool expired) {
+    {
+      std::lock_guard<std::mutex> lk(self->state_->mu);
+      self->timer_pending_ = false;
+      if (!expired || self->state_->done || self->state_->cancelled ||
+          self->hedging_stopped_ || self->started_ >= self->max_attempts_) {
+        return;
+      }
+      if (!self->hedging_policy_.OnHedge()) {
+        // The budget is exhausted, wait for the attempts in progress.
+        self->hedging_stopped_ = true;
+        return;
+      }
+    }
+    StartAttempt(std::move(self), std::move(cq));
+  }
+
+  /// The callback for a completed attempt, successful or not.
+  static void OnAttempt(std::shared_ptr<AsyncHedgedUnaryRpc> self,
+                        CompletionQueue cq, StatusOr<Response> result) {
+    std::unique_lock<std::mutex> lk(self->state_->mu);
+    --self->in_flight_;
+    if (self->state_->done) return;
+    if (result) {
+      auto pending = self->SetDone();
+      self->rpc_retry_policy_->OnSuccess();
+      lk.unlock();
+      // Record the latency of the call, not of the winning attempt. The winner
+      // is biased towards fast attempts, and it may have started well after
+      // the call.
+      self->hedging_policy_.OnSuccess(
+          std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() -
+                                                                self->start_));
+      // Cancel the losers, this calls `TryCancel()` on their contexts.
+      for (auto& f : pending) f.cancel();
+      self->final_result_.set_value(std::move(result));
+      return;
+    }
+    auto const& status = result.status();
+    char const* failure_description = nullptr;
+    if (self->state_->cancelled) {
+      failure_description = "hedged call cancelled";
+    } else if (!self->is_idempotent_) {
+      failure_description = "non-idempotent operation failed";
+    } else if (!self->rpc_retry_policy_->OnFailure(status)) {
+      self->hedging_stopped_ = true;
+      if (RPCRetryPolicy::RetryableTraits::IsPermanentFailure(status)) {
+        // All the attempts would fail in the same way, stop right away.
+        auto pending = self->SetDone();
+        lk.unlock();
+        for (auto& f : pending) f.cancel();
+        self->final_result_.set_value(
+            self->DetailedStatus("permanent failure", status));
+        return;
+      }
+      failure_description = "retry policy exhausted";
+    } else if (self->in_flight_ == 0 &&
+               self->started_ < self->max_attempts_) {
+      // No attempts are in progress, replace the failed attempt right away.
+      lk.unlock();
+      StartAttempt(std::move(self), std::move(cq));
+      return;
+    } else {
+      failure_description = "hedging attempts exhausted";
+    }
+    // Wait for the attempts in progress, any of them may still succeed.
+    if (self->in_flight_ != 0) return;
+    auto pending = self->SetDone();
+    lk.unlock();
+    for (auto& f : pending) f.cancel();
+    self->final_result_.set_value(
+        self->DetailedStatus(failure_description, status));
+  }
+
+  /// Mark the call as done, returning the operations to cancel.
+  std::vector<future<void>> SetDone() {
+    state_->done = true;
+    return std::move(state_->pending);
+  }
+
+  /// Generate an error message
+  Status DetailedStatus(char const* context, Status const& status) {
+    std::string full_message = location_;
+    full_message += context;
+    full_message += ", last error=";
+    full_message += status.message();
+    return Status(status.code(), std::move(full_message),
+                  status.error_details());
+  }
+
+  char const* location_;
+  std::unique_ptr<RPCRetryPolicy> rpc_retry_policy_;
+  HedgingPolicy hedging_policy_;
+  int const max_attempts_;
+  bool const is_idempotent_;
+
+  AsyncCallType async_call_;
+  Request request_;
+  /// When the first attempt started.
+  Clock::time_point const start_;
+
+  int started_ = 0;
+  int in_flight_ = 0;
+  bool timer_pending_ = false;
+  bool hedging_stopped_ = false;
+
+  std::shared_ptr<State> state_;
+  promise<StatusOr<Response>> final_result_;
+};
+
+/**
+ * Automatically deduce the type for `AsyncHedgedUnaryRpc` and start the hedged
+ * call.
+ *
+ * @param cq the completion queue where the attempts and timers run.
+ * @param location typically the name of the function that created this call.
+ * @param rpc_retry_policy controls which errors are retryable, and the maximum
+ *     number of failures.
+ * @param hedging_policy controls the number of attempts, when they start, and
+ *     the budget for the additional attempts.
+ * @param is_idempotent if false the call makes a single attempt.
+ * @param async_call the callable to start a new asynchronous operation.
+ * @param request the parameters of the request.
+ *
+ * @return a future that becomes satisfied with the result of the first
+ *     successful attempt, or with the last error.
+ */
+template <typename RPCRetryPolicy, typename AsyncCallType,
+          typename RequestType,
+          typename async_call_t = typename std::decay<AsyncCallType>::type,
+          typename request_t = typename std::decay<RequestType>::type,
+          typename std::enable_if<
+              google::cloud::internal::is_invocable<
+                  async_call_t, grpc::ClientContext*, request_t const&,
+                  grpc::CompletionQueue*>::value,
+              int>::type = 0>
+future<StatusOr<typename AsyncCallResponseType<async_call_t, request_t>::type>>
+StartAsyncHedgedUnaryRpc(CompletionQueue cq, char const* location,
+                         std::unique_ptr<RPCRetryPolicy> rpc_retry_policy,
+                         HedgingPolicy hedging_policy, bool is_idempotent,
+                         AsyncCallType&& async_call, RequestType&& request) {
+  return AsyncHedgedUnaryRpc<RPCRetryPolicy, async_call_t, request_t>::Start(
+      std::move(cq), location, std::move(rpc_retry_policy),
+      std::move(hedging_policy), is_idempotent,
+      std::forward<AsyncCallType>(async_call),
+      std::forward<RequestType>(request));
+}
+
+}  // namespace internal
+}  // namespace GOOGLE_CLOUD_CPP_NS
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_INTERNAL_ASYNC_HEDGED_UNARY_RPC_H
@@ -0,0 +1,305 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/internal/async_hedged_unary_rpc.h"
+#include "google/cloud/internal/retry_policy.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include "google/cloud/testing_util/mock_async_response_reader.h"
+#include "google/cloud/testing_util/mock_completion_queue.h"
+#include <google/bigtable/admin/v2/bigtable_table_admin.grpc.pb.h>
+#include <gmock/gmock.h>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace google {
+namespace cloud {
+inline namespace GOOGLE_CLOUD_CPP_NS {
+namespace internal {
+namespace {
+
+namespace btadmin = ::google::bigtable::admin::v2;
+using ::google::cloud::testing_util::MockAsyncResponseReader;
+using ::google::cloud::testing_util::MockCompletionQueue;
+using ::testing::_;
+using ::testing::HasSubstr;
+using ::testing::Invoke;
+using ms = std::chrono::milliseconds;
+
+class MockStub {
+ public:
+  MOCK_METHOD3(
+      AsyncGetTable,
+      std::unique_ptr<grpc::ClientAsyncResponseReaderInterface<btadmin::Table>>(
+          grpc::ClientContext*, btadmin::GetTableRequest const&,
+          grpc::CompletionQueue* cq));
+};
+
+/// Define which status codes are permanent failures for this test.
+struct IsRetryableTraits {
+  static bool IsPermanentFailure(Status const& status) {
+    return !status.ok() && status.code() != StatusCode::kUnavailable;
+  }
+};
+
+using RpcLimitedErrorCountRetryPolicy =
+    google::cloud::internal::LimitedErrorCountRetryPolicy<Status,
+                                                          IsRetryableTraits>;
+using ReaderType = MockAsyncResponseReader<btadmin::Table>;
+
+/**
+ * One attempt in a hedged call.
+ *
+ * The mock reader saves the tag for the attempt, the test decides when the
+ * attempt completes using this tag.
+ */
+struct Attempt {
+  Attempt(grpc::Status status, std::string name)
+      : reader(google::cloud::internal::make_unique<ReaderType>()) {
+    EXPECT_CALL(*reader, Finish(_, _, _))
+        .WillOnce(Invoke([this, status, name](btadmin::Table* table,
+                                              grpc::Status* s, void* t) {
+          table->set_name(name);
+          *s = status;
+          tag = t;
+        }));
+  }
+
+  std::unique_ptr<ReaderType> reader;
+  /// The tag for the attempt, null until the attempt starts.
+  void* tag = nullptr;
+};
+
+/**
+ * Run the hedged calls on a `MockCompletionQueue`.
+ *
+ * The tests complete each attempt, and expire each hedging timer, explicitly.
+ * The results do not depend on the timing of the test.
+ */
+class AsyncHedgedUnaryRpcTest : public ::testing::Test {
+ protected:
+  AsyncHedgedUnaryRpcTest()
+      : mock_cq_(std::make_shared<MockCompletionQueue>()), cq_(mock_cq_) {}
+
+  ~AsyncHedgedUnaryRpcTest() override {
+    // Release any operations left in the queue, such as cancelled timers.
+    mock_cq_->SimulateCompletion(false);
+  }
+
+  /// Expect calls to `AsyncGetTable()` returning each attempt's reader.
+  void ExpectAttempts(std::vector<Attempt*> const& attempts) {
+    attempts_ = attempts;
+    auto& expectation = EXPECT_CALL(mock_, AsyncGetTable(_, _, _));
+    expectation.Times(static_cast<int>(attempts.size()));
+    for (auto* a : attempts) {
+      expectation.WillOnce(
+          Invoke([a](grpc::ClientContext*, btadmin::GetTableRequest const&,
+                     grpc::CompletionQueue*) {
+            return std::unique_ptr<
+                // This is safe, see comments in MockAsyncResponseReader.
+                grpc::ClientAsyncResponseReaderInterface<btadmin::Table>>(
+                a->reader.get());
+          }));
+    }
+  }
+
+  /// Complete @p attempt, it must have started.
+  void Complete(Attempt const& attempt) {
+    ASSERT_NE(nullptr, attempt.tag);
+    Complete(attempt.tag, true);
+  }
+
+  void Complete(void* tag, bool ok) {
+    mock_cq_->SimulateCompletion(static_cast<AsyncOperation*>(tag), ok);
+  }
+
+  /// The pending timers, including any timers cancelled by the call.
+  std::vector<void*> Timers() const {
+    auto tags = mock_cq_->pending_tags();
+    tags.erase(std::remove_if(tags.begin(), tags.end(),
+                              [this](void* t) {
+                                return std::any_of(
+                                    attempts_.begin(), attempts_.end(),
+                                    [t](Attempt* a) { return a->tag == t; });
+                              }),
+               tags.end());
+    return tags;
+  }
+
+  future<StatusOr<btadmin::Table>> StartCall(HedgingPolicy hedging_policy,
+                                             bool is_idempotent = true) {
+    return StartAsyncHedgedUnaryRpc(
+        cq_, __func__, RpcLimitedErrorCountRetryPolicy(3).clone(),
+        std::move(hedging_policy), is_idempotent,
+        [this](grpc::ClientContext* context,
+               btadmin::GetTableRequest const& request,
+               grpc::CompletionQueue* cq) {
+          return mock_.AsyncGetTable(context, request, cq);
+        },
+        btadmin::GetTableRequest{});
+  }
+
+  MockStub mock_;
+  std::shared_ptr<MockCompletionQueue> mock_cq_;
+  CompletionQueue cq_;
+  std::vector<Attempt*> attempts_;
+};
+
+TEST_F(AsyncHedgedUnaryRpcTest, FirstAttemptWins) {
+  Attempt a1(grpc::Status::OK, "fast");
+  ExpectAttempts({&a1});
+
+  auto fut = StartCall(HedgingPolicy(2, ms(10)));
+  EXPECT_EQ(1U, Timers().size());
+  Complete(a1);
+  auto result = fut.get();
+  ASSERT_STATUS_OK(result);
+  EXPECT_EQ("fast", result->name());
+}
+
+TEST_F(AsyncHedgedUnaryRpcTest, HedgedAttemptWins) {
+  Attempt a1(grpc::Status::OK, "slow");
+  Attempt a2(grpc::Status::OK, "fast");
+  ExpectAttempts({&a1, &a2});
+
+  auto budget = std::make_shared<RetryBudget>(10.0, 0.1);
+  auto tracker = std::make_shared<LatencyTracker>(8, 1);
+  auto policy = HedgingPolicy(2, ms(10));
+  policy.set_budget(budget).set_latency_tracker(tracker);
+
+  auto fut = StartCall(policy);
+  EXPECT_EQ(nullptr, a2.tag);
+  // Make the call latency measurably longer than the winning attempt.
+  std::this_thread::sleep_for(ms(2));
+  auto timers = Timers();
+  ASSERT_EQ(1U, timers.size());
+  Complete(timers[0], true);
+  // The hedged attempt starts, and there are no more timers as the policy
+  // allows only 2 attempts.
+  Complete(a2);
+  auto result = fut.get();
+  ASSERT_STATUS_OK(result);
+  EXPECT_EQ("fast", result->name());
+  EXPECT_TRUE(Timers().empty());
+
+  // The loser was cancelled, completing it has no effect.
+  Complete(a1);
+  EXPECT_EQ(1, budget->counters().successes);
+  EXPECT_EQ(1, budget->counters().retries_allowed);
+  // The tracker records the latency of the call, from the first attempt.
+  auto latency = tracker->Percentile(1.0);
+  ASSERT_TRUE(latency.has_value());
+  EXPECT_LE(ms(2), *latency);
+}
+
+TEST_F(AsyncHedgedUnaryRpcTest, BudgetExhausted) {
+  Attempt a1(grpc::Status::OK, "fast");
+  ExpectAttempts({&a1});
+
+  auto budget = std::make_shared<RetryBudget>(1.0, 0.0);
+  ASSERT_TRUE(budget->TryRetry());
+  auto policy = HedgingPolicy(3, ms(10));
+  policy.set_budget(budget);
+
+  auto fut = StartCall(policy);
+  auto timers = Timers();
+  ASSERT_EQ(1U, timers.size());
+  // The budget rejects the hedged attempt, and the call stops hedging.
+  Complete(timers[0], true);
+  EXPECT_EQ(1, budget->counters().retries_denied);
+  EXPECT_TRUE(Timers().empty());
+
+  Complete(a1);
+  auto result = fut.get();
+  ASSERT_STATUS_OK(result);
+  EXPECT_EQ("fast", result->name());
+}
+
+TEST_F(AsyncHedgedUnaryRpcTest, ReplaceFailedAttempt) {
+  Attempt a1(grpc::Status(grpc::StatusCode::UNAVAILABLE, "try-again"), "");
+  Attempt a2(grpc::Status::OK, "fast");
+  ExpectAttempts({&a1, &a2});
+
+  auto fut = StartCall(HedgingPolicy(3, ms(10)));
+  Complete(a1);
+  // The failed attempt is replaced without waiting for the hedging timer.
+  EXPECT_EQ(1U, Timers().size());
+  Complete(a2);
+  auto result = fut.get();
+  ASSERT_STATUS_OK(result);
+  EXPECT_EQ("fast", result->name());
+}
+
+TEST_F(AsyncHedgedUnaryRpcTest, PermanentFailure) {
+  Attempt a1(grpc::Status(grpc::StatusCode::PERMISSION_DENIED, "uh-oh"), "");
+  ExpectAttempts({&a1});
+
+  auto fut = StartCall(HedgingPolicy(2, ms(10)));
+  Complete(a1);
+  auto result = fut.get();
+  EXPECT_EQ(StatusCode::kPermissionDenied, result.status().code());
+  EXPECT_THAT(result.status().message(), HasSubstr("permanent failure"));
+  EXPECT_THAT(result.status().message(), HasSubstr("uh-oh"));
+}
+
+TEST_F(AsyncHedgedUnaryRpcTest, AttemptsExhausted) {
+  Attempt a1(grpc::Status(grpc::StatusCode::UNAVAILABLE, "try-again"), "");
+  Attempt a2(grpc::Status(grpc::StatusCode::UNAVAILABLE, "try-again"), "");
+  ExpectAttempts({&a1, &a2});
+
+  auto fut = StartCall(HedgingPolicy(2, ms(10)));
+  Complete(a1);
+  Complete(a2);
+  auto result = fut.get();
+  EXPECT_EQ(StatusCode::kUnavailable, result.status().code());
+  EXPECT_THAT(result.status().message(),
+              HasSubstr("hedging attempts exhausted"));
+}
+
+TEST_F(AsyncHedgedUnaryRpcTest, NonIdempotent) {
+  Attempt a1(grpc::Status(grpc::StatusCode::UNAVAILABLE, "try-again"), "");
+  ExpectAttempts({&a1});
+
+  auto fut = StartCall(HedgingPolicy(3, ms(10)), /*is_idempotent=*/false);
+  // Non-idempotent calls are never hedged, there is no timer.
+  EXPECT_TRUE(Timers().empty());
+  Complete(a1);
+  auto result = fut.get();
+  EXPECT_EQ(StatusCode::kUnavailable, result.status().code());
+  EXPECT_THAT(result.status().message(), HasSubstr("non-idempotent"));
+}
+
+TEST_F(AsyncHedgedUnaryRpcTest, Cancel) {
+  Attempt a1(grpc::Status(grpc::StatusCode::CANCELLED, "cancelled"), "");
+  ExpectAttempts({&a1});
+
+  auto fut = StartCall(HedgingPolicy(2, ms(10)));
+  EXPECT_TRUE(fut.cancel());
+  // The timer was cancelled, even if it fires it does not start an attempt.
+  auto timers = Timers();
+  ASSERT_EQ(1U, timers.size());
+  Complete(timers[0], true);
+
+  Complete(a1);
+  auto result = fut.get();
+  EXPECT_EQ(StatusCode::kCancelled, result.status().code());
+  EXPECT_THAT(result.status().message(), HasSubstr("hedged call cancelled"));
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace GOOGLE_CLOUD_CPP_NS
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,291 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_INTERNAL_ASYNC_PAGINATION_RANGE_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_INTERNAL_ASYNC_PAGINATION_RANGE_H
+
+#include "google/cloud/future.h"
+#include "google/cloud/optional.h"
+#include "google/cloud/status_or.h"
+#include "google/cloud/version.h"
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace google {
+namespace cloud {
+inline namespace GOOGLE_CLOUD_CPP_NS {
+namespace internal {
+
+/**
+ * Adapt asynchronous pagination APIs to a sequence of futures.
+ *
+ * This is the asynchronous counterpart of `PaginationRange`. The loader
+ * returns a `future<StatusOr<Response>>`, typically from a
+ * `CompletionQueue::MakeUnaryRpc()` call, and the application consumes the
+ * items using `Next()` (one item at a time) or `NextPage()` (one page at a
+ * time). Neither function blocks, the next page is requested when the
+ * application asks for an item and the items already received are consumed.
+ * That is, the application controls the pace (and provides backpressure), at
+ * most one page is buffered, and at most one request is pending.
+ *
+ * The application must wait for each future to be satisfied before calling
+ * `Next()` or `NextPage()` again. The loader may be called from the thread
+ * satisfying the previous page's future, typically a thread running the
+ * completion queue.
+ *
+ * Errors terminate the iteration, as in `PaginationRange`: the error is
+ * returned once, and the following calls return an unset optional.
+ *
+ * @tparam T the type of the items, typically a proto describing the resources
+ * @tparam Request the type of the request object for the `List` RPC.
+ * @tparam Response the type of the response object for the `List` RPC.
+ */
+template <typename T, typename Request, typename Response>
+class AsyncPaginationRange {
+ public:
+  using Loader = std::function<future<StatusOr<Response>>(Request const& r)>;
+  using GetItems = std::function<std::vector<T>(Response r)>;
+
+  /**
+   * Create a new range to paginate over some elements.
+   *
+   * @param request the first request to start the iteration, the library may
+   *    initialize this request with any filtering constraints.
+   * @param loader starts the asynchronous RPC to fetch a new page of items.
+   * @param get_items extracts the items from the response.
+   */
+  AsyncPaginationRange(Request request, Loader loader, GetItems get_items)
+      : state_(std::make_shared<State>(std::move(request), std::move(loader),
+                                       std::move(get_items))) {}
+
+  /**
+   * Get the next item.
+   *
+   * @return a future satisfied with the next item, an error, or an unset
+   *     optional if there are no more items. Cancelling the future cancels
+   *     the pending request, if any.
+   */
+  future<optional<StatusOr<T>>> Next() {
+    return State::template Fetch<T>(state_, [](State& s) {
+      auto item = std::move(s.buffer.front());
+      s.buffer.pop_front();
+      return item;
+    });
+  }
+
+  /**
+   * Get all the remaining items in the current page, or the next page.
+   *
+   * @return a future satisfied with a non-empty vector of items, an error, or
+   *     an unset optional if there are no more items. Cancelling the future
+   *     cancels the pending request, if any.
+   */
+  future<optional<StatusOr<std::vector<T>>>> NextPage() {
+    return State::template Fetch<std::vector<T>>(state_, [](State& s) {
+      std::vector<T> page(std::make_move_iterator(s.buffer.begin()),
+                          std::make_move_iterator(s.buffer.end()));
+      s.buffer.clear();
+      return page;
+    });
+  }
+
+  /**
+   * Stop the iteration.
+   *
+   * Cancels the pending request, if any. The pending future (if any) is
+   * satisfied with a `kCancelled` error once that request completes. Any
+   * items already received are discarded, and any further calls to `Next()`
+   * or `NextPage()` return an unset optional.
+   */
+  void Cancel() { State::Cancel(state_); }
+
+ private:
+  /**
+   * The state shared with the pending request.
+   *
+   * The futures returned by `Next()` and `NextPage()` may outlive the range,
+   * so the continuations share this state instead of capturing `this`.
+   */
+  struct State {
+    State(Request r, Loader l, GetItems g)
+        : request(std::move(r)),
+          loader(std::move(l)),
+          get_items(std::move(g)) {}
+
+    /**
+     * Satisfy a future using the buffered items, loading pages as needed.
+     *
+     * @p extract is only called with a non-empty buffer, while holding the
+     * lock.
+     */
+    template <typename Value, typename Extract>
+    static future<optional<StatusOr<Value>>> Fetch(
+        std::shared_ptr<State> const& self, Extract extract) {
+      using Result = optional<StatusOr<Value>>;
+      std::unique_lock<std::mutex> lk(self->mu);
+      if (self->in_flight) {
+        return make_ready_future(Result(StatusOr<Value>(Status(
+            StatusCode::kFailedPrecondition,
+            "the previous Next() or NextPage() future is not satisfied"))));
+      }
+      if (!self->buffer.empty()) {
+        return make_ready_future(Result(StatusOr<Value>(extract(*self))));
+      }
+      if (self->done) return make_ready_future(Result{});
+      self->in_flight = true;
+      lk.unlock();
+
+      std::weak_ptr<State> w = self;
+      auto p = std::make_shared<promise<Result>>([w] {
+        if (auto s = w.lock()) Cancel(s);
+      });
+      auto f = p->get_future();
+      Load(self, [self, p, extract](Status status) {
+        std::unique_lock<std::mutex> lk(self->mu);
+        self->in_flight = false;
+        if (!status.ok()) {
+          lk.unlock();
+          p->set_value(Result(StatusOr<Value>(std::move(status))));
+          return;
+        }
+        if (self->buffer.empty()) {
+          lk.unlock();
+          p->set_value(Result{});
+          return;
+        }
+        auto result = Result(StatusOr<Value>(extract(*self)));
+        lk.unlock();
+        p->set_value(std::move(result));
+      });
+      return f;
+    }
+
+    /**
+     * Load pages until there is at least one item, the range ends, or fails.
+     *
+     * Empty pages with a `next_page_token` are skipped. Pages that are already
+     * available when the loader returns are handled in this loop, so a long
+     * run of them does not grow the stack.
+     */
+    static void Load(std::shared_ptr<State> const& self,
+                     std::function<void(Status)> on_done) {
+      for (;;) {
+        std::unique_lock<std::mutex> lk(self->mu);
+        if (self->cancelled) {
+          self->done = true;
+          lk.unlock();
+          on_done(Status(StatusCode::kCancelled, "pagination cancelled"));
+          return;
+        }
+        self->request.set_page_token(std::move(self->next_page_token));
+        self->next_page_token.clear();
+        auto request = self->request;
+        auto const generation = ++self->generation;
+        lk.unlock();
+
+        auto page = self->loader(request);
+        if (page.is_ready()) {
+          if (OnPage(self, page.get(), on_done)) continue;
+          return;
+        }
+        auto pending =
+            page.then([self, on_done](future<StatusOr<Response>> f) {
+              if (OnPage(self, f.get(), on_done)) Load(self, on_done);
+            });
+
+        lk.lock();
+        // Only keep the pending request if it is still the current one; the
+        // loader may complete immediately and start the next request.
+        if (generation != self->generation) return;
+        if (!self->cancelled) {
+          self->pending = std::move(pending);
+          return;
+        }
+        lk.unlock();
+        pending.cancel();
+        return;
+      }
+    }
+
+    /**
+     * Buffer the items in @p response.
+     *
+     * @return true if the page was empty and the next page must be loaded,
+     *     otherwise @p on_done is called.
+     */
+    static bool OnPage(std::shared_ptr<State> const& self,
+                       StatusOr<Response> response,
+                       std::function<void(Status)> const& on_done) {
+      std::unique_lock<std::mutex> lk(self->mu);
+      if (self->cancelled) {
+        self->done = true;
+        lk.unlock();
+        on_done(Status(StatusCode::kCancelled, "pagination cancelled"));
+        return false;
+      }
+      if (!response) {
+        self->done = true;
+        lk.unlock();
+        on_done(std::move(response).status());
+        return false;
+      }
+      self->next_page_token = std::move(*response->mutable_next_page_token());
+      if (self->next_page_token.empty()) self->done = true;
+      auto items = self->get_items(*std::move(response));
+      for (auto& i : items) self->buffer.push_back(std::move(i));
+      if (self->buffer.empty() && !self->done) return true;
+      lk.unlock();
+      on_done(Status());
+      return false;
+    }
+
+    static void Cancel(std::shared_ptr<State> const& self) {
+      std::unique_lock<std::mutex> lk(self->mu);
+      self->cancelled = true;
+      self->done = true;
+      self->buffer.clear();
+      auto pending = std::move(self->pending);
+      lk.unlock();
+      if (pending.valid()) pending.cancel();
+    }
+
+    std::mutex mu;
+    Request request;
+    Loader loader;
+    GetItems get_items;
+    std::deque<T> buffer;
+    std::string next_page_token;
+    bool done = false;
+    bool in_flight = false;
+    bool cancelled = false;
+    std::int64_t generation = 0;
+    future<void> pending;
+  };
+
+  std::shared_ptr<State> state_;
+};
+
+}  // namespace internal
+}  // namespace GOOGLE_CLOUD_CPP_NS
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_INTERNAL_ASYNC_PAGINATION_RANGE_H
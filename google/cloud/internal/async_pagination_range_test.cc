@@ -0,0 +1,275 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/internal/async_pagination_range.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include <google/bigtable/admin/v2/bigtable_instance_admin.grpc.pb.h>
+#include <gmock/gmock.h>
+#include <deque>
+
+namespace google {
+namespace cloud {
+inline namespace GOOGLE_CLOUD_CPP_NS {
+namespace internal {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::HasSubstr;
+using ItemType = ::google::bigtable::admin::v2::AppProfile;
+using Request = ::google::bigtable::admin::v2::ListAppProfilesRequest;
+using Response = ::google::bigtable::admin::v2::ListAppProfilesResponse;
+using TestedRange = AsyncPaginationRange<ItemType, Request, Response>;
+
+/// A loader where the test controls when each page is returned.
+class FakeLoader {
+ public:
+  future<StatusOr<Response>> Load(Request const& r) {
+    tokens.push_back(r.page_token());
+    pending.emplace_back([this] { ++cancel_count; });
+    return pending.back().get_future();
+  }
+
+  void Complete(StatusOr<Response> response) {
+    auto p = std::move(pending.front());
+    pending.pop_front();
+    p.set_value(std::move(response));
+  }
+
+  std::deque<promise<StatusOr<Response>>> pending;
+  std::vector<std::string> tokens;
+  int cancel_count = 0;
+};
+
+std::vector<ItemType> GetItems(Response const& response) {
+  return std::vector<ItemType>(response.app_profiles().begin(),
+                               response.app_profiles().end());
+}
+
+Response MakePage(std::string const& token,
+                  std::vector<std::string> const& names) {
+  Response response;
+  response.set_next_page_token(token);
+  for (auto const& n : names) response.add_app_profiles()->set_name(n);
+  return response;
+}
+
+TestedRange MakeRange(FakeLoader& loader) {
+  return TestedRange(
+      Request{}, [&loader](Request const& r) { return loader.Load(r); },
+      GetItems);
+}
+
+TEST(AsyncPaginationRange, Empty) {
+  FakeLoader loader;
+  auto range = MakeRange(loader);
+  auto f = range.Next();
+  EXPECT_EQ(std::future_status::timeout, f.wait_for(std::chrono::seconds(0)));
+  loader.Complete(MakePage("", {}));
+  EXPECT_FALSE(f.get().has_value());
+  EXPECT_FALSE(range.Next().get().has_value());
+  EXPECT_THAT(loader.tokens, ElementsAre(""));
+}
+
+TEST(AsyncPaginationRange, NextTwoPages) {
+  FakeLoader loader;
+  auto range = MakeRange(loader);
+  // Nothing is loaded until the application asks for an item.
+  EXPECT_TRUE(loader.tokens.empty());
+
+  auto f = range.Next();
+  loader.Complete(MakePage("t1", {"p1", "p2"}));
+  auto item = f.get();
+  ASSERT_TRUE(item.has_value());
+  ASSERT_STATUS_OK(*item);
+  EXPECT_EQ("p1", (*item)->name());
+
+  // The buffered item is returned without loading the next page.
+  item = range.Next().get();
+  ASSERT_TRUE(item.has_value());
+  ASSERT_STATUS_OK(*item);
+  EXPECT_EQ("p2", (*item)->name());
+  EXPECT_THAT(loader.tokens, ElementsAre(""));
+
+  f = range.Next();
+  loader.Complete(MakePage("", {"p3"}));
+  item = f.get();
+  ASSERT_TRUE(item.has_value());
+  ASSERT_STATUS_OK(*item);
+  EXPECT_EQ("p3", (*item)->name());
+
+  EXPECT_FALSE(range.Next().get().has_value());
+  EXPECT_THAT(loader.tokens, ElementsAre("", "t1"));
+}
+
+TEST(AsyncPaginationRange, NextPage) {
+  FakeLoader loader;
+  auto range = MakeRange(loader);
+
+  auto f = range.Next();
+  loader.Complete(MakePage("t1", {"p1", "p2", "p3"}));
+  auto item = f.get();
+  ASSERT_TRUE(item.has_value());
+  ASSERT_STATUS_OK(*item);
+  EXPECT_EQ("p1", (*item)->name());
+
+  auto names = [](std::vector<ItemType> const& page) {
+    std::vector<std::string> result;
+    for (auto const& p : page) result.push_back(p.name());
+    return result;
+  };
+
+  // The remaining items in the current page.
+  auto page = range.NextPage().get();
+  ASSERT_TRUE(page.has_value());
+  ASSERT_STATUS_OK(*page);
+  EXPECT_THAT(names(**page), ElementsAre("p2", "p3"));
+
+  auto p = range.NextPage();
+  loader.Complete(MakePage("", {"p4", "p5"}));
+  page = p.get();
+  ASSERT_TRUE(page.has_value());
+  ASSERT_STATUS_OK(*page);
+  EXPECT_THAT(names(**page), ElementsAre("p4", "p5"));
+
+  EXPECT_FALSE(range.NextPage().get().has_value());
+}
+
+TEST(AsyncPaginationRange, SkipEmptyPages) {
+  FakeLoader loader;
+  auto range = MakeRange(loader);
+
+  auto f = range.Next();
+  loader.Complete(MakePage("t1", {}));
+  loader.Complete(MakePage("t2", {}));
+  EXPECT_EQ(std::future_status::timeout, f.wait_for(std::chrono::seconds(0)));
+  loader.Complete(MakePage("", {"p1"}));
+  auto item = f.get();
+  ASSERT_TRUE(item.has_value());
+  ASSERT_STATUS_OK(*item);
+  EXPECT_EQ("p1", (*item)->name());
+  EXPECT_THAT(loader.tokens, ElementsAre("", "t1", "t2"));
+}
+
+TEST(AsyncPaginationRange, SkipManyReadyEmptyPages) {
+  // Each empty page is returned by a satisfied future. Skipping them must not
+  // recurse, or this test would overflow the stack.
+  auto constexpr kEmptyPages = 100000;
+  int count = 0;
+  TestedRange range(
+      Request{},
+      [&count](Request const&) {
+        if (++count <= kEmptyPages) {
+          return make_ready_future(
+              StatusOr<Response>(MakePage("t" + std::to_string(count), {})));
+        }
+        return make_ready_future(StatusOr<Response>(MakePage("", {"p1"})));
+      },
+      GetItems);
+
+  auto item = range.Next().get();
+  ASSERT_TRUE(item.has_value());
+  ASSERT_STATUS_OK(*item);
+  EXPECT_EQ("p1", (*item)->name());
+  EXPECT_EQ(kEmptyPages + 1, count);
+  EXPECT_FALSE(range.Next().get().has_value());
+}
+
+TEST(AsyncPaginationRange, ErrorEndsRange) {
+  FakeLoader loader;
+  auto range = MakeRange(loader);
+
+  auto f = range.Next();
+  loader.Complete(MakePage("t1", {"p1"}));
+  auto item = f.get();
+  ASSERT_TRUE(item.has_value());
+  ASSERT_STATUS_OK(*item);
+
+  f = range.Next();
+  loader.Complete(Status(StatusCode::kUnavailable, "try-again"));
+  item = f.get();
+  ASSERT_TRUE(item.has_value());
+  EXPECT_EQ(StatusCode::kUnavailable, item->status().code());
+  EXPECT_THAT(item->status().message(), HasSubstr("try-again"));
+
+  EXPECT_FALSE(range.Next().get().has_value());
+  EXPECT_THAT(loader.tokens, ElementsAre("", "t1"));
+}
+
+TEST(AsyncPaginationRange, PreviousFutureNotSatisfied) {
+  FakeLoader loader;
+  auto range = MakeRange(loader);
+
+  auto f = range.Next();
+  auto item = range.Next().get();
+  ASSERT_TRUE(item.has_value());
+  EXPECT_EQ(StatusCode::kFailedPrecondition, item->status().code());
+
+  loader.Complete(MakePage("", {"p1"}));
+  item = f.get();
+  ASSERT_TRUE(item.has_value());
+  ASSERT_STATUS_OK(*item);
+  EXPECT_EQ("p1", (*item)->name());
+  EXPECT_THAT(loader.tokens, ElementsAre(""));
+}
+
+TEST(AsyncPaginationRange, CancelFuture) {
+  FakeLoader loader;
+  auto range = MakeRange(loader);
+
+  auto f = range.Next();
+  f.cancel();
+  EXPECT_EQ(1, loader.cancel_count);
+  loader.Complete(MakePage("t1", {"p1"}));
+  auto item = f.get();
+  ASSERT_TRUE(item.has_value());
+  EXPECT_EQ(StatusCode::kCancelled, item->status().code());
+
+  EXPECT_FALSE(range.Next().get().has_value());
+  EXPECT_THAT(loader.tokens, ElementsAre(""));
+}
+
+TEST(AsyncPaginationRange, CancelRange) {
+  FakeLoader loader;
+  auto range = MakeRange(loader);
+
+  auto f = range.Next();
+  loader.Complete(MakePage("t1", {"p1", "p2"}));
+  ASSERT_TRUE(f.get().has_value());
+
+  // Buffered items are discarded.
+  range.Cancel();
+  EXPECT_FALSE(range.Next().get().has_value());
+  EXPECT_FALSE(range.NextPage().get().has_value());
+  EXPECT_EQ(0, loader.cancel_count);
+}
+
+TEST(AsyncPaginationRange, FutureOutlivesRange) {
+  FakeLoader loader;
+  future<optional<StatusOr<ItemType>>> f;
+  {
+    auto range = MakeRange(loader);
+    f = range.Next();
+  }
+  loader.Complete(MakePage("", {"p1"}));
+  auto item = f.get();
+  ASSERT_TRUE(item.has_value());
+  ASSERT_STATUS_OK(*item);
+  EXPECT_EQ("p1", (*item)->name());
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace GOOGLE_CLOUD_CPP_NS
+}  // namespace cloud
+}  // namespace google
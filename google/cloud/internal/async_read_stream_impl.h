@@ -16,8 +16,19 @@
 #define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_INTERNAL_ASYNC_READ_STREAM_IMPL_H
 
 #include "google/cloud/internal/completion_queue_impl.h"
+#include "google/cloud/internal/disjunction.h"
+#include "google/cloud/internal/make_unique.h"
+#include "google/cloud/internal/streaming_read_stats_recorder.h"
+#include "google/cloud/streaming_read_batch_options.h"
 #include "google/cloud/version.h"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
 #include <memory>
+#include <mutex>
+#include <type_traits>
+#include <vector>
 
 namespace google {
 namespace cloud {
@@ -96,15 +107,23 @@ using AsyncStreamingReadResponseType = AsyncStreamingReadRpcUnwrap<
  *
  * @tparam Response the type of the responses in the streaming read RPC.
  * @tparam OnReadHandler the type of the user-provided callable to handle Read
- *     responses.
+ *     responses. It must return `future<bool>` or `bool`, `true` to continue
+ *     reading, `false` to cancel the stream.
  * @tparam OnFinishHandler the type of the user-provided callback to handle
  *     Finish responses.
+ * @tparam Batched if true, @p OnReadHandler receives a
+ *     `std::vector<Response>` with one or more messages.
  */
-template <typename Response, typename OnReadHandler, typename OnFinishHandler>
+template <typename Response, typename OnReadHandler, typename OnFinishHandler,
+          bool Batched = false>
 class AsyncReadStreamImpl
-    : public AsyncOperation,
-      public std::enable_shared_from_this<
-          AsyncReadStreamImpl<Response, OnReadHandler, OnFinishHandler>> {
+    : public AsyncStreamingReadOperation,
+      public std::enable_shared_from_this<AsyncReadStreamImpl<
+          Response, OnReadHandler, OnFinishHandler, Batched>> {
+  /// The type passed to `on_read_`.
+  using Batch = typename std::conditional<Batched, std::vector<Response>,
+                                          Response>::type;
+
  public:
   /**
    * Create a new instance.
@@ -112,12 +131,40 @@ class AsyncReadStreamImpl
    * @param on_read the handler for a successful `Read()` result. Failed
    *   `Read()` operations automatically terminate the loop and call `Finish()`.
    * @param on_finish the handler for a completed `Finish()` result.
+   * @param read_ahead the maximum number of messages received, but not yet
+   *   delivered to @p on_read. With the default (0), the stream does not read
+   *   the next message until @p on_read completes.
+   * @param collect_stats if true, collect the statistics returned by
+   *   `stats()`.
    */
   static std::shared_ptr<AsyncReadStreamImpl> Create(
-      OnReadHandler&& on_read, OnFinishHandler&& on_finish) {
-    return std::shared_ptr<AsyncReadStreamImpl>(
-        new AsyncReadStreamImpl(std::forward<OnReadHandler>(on_read),
-                                std::forward<OnFinishHandler>(on_finish)));
+      OnReadHandler&& on_read, OnFinishHandler&& on_finish,
+      std::size_t read_ahead = 0, bool collect_stats = false) {
+    return std::shared_ptr<AsyncReadStreamImpl>(new AsyncReadStreamImpl(
+        std::forward<OnReadHandler>(on_read),
+        std::forward<OnFinishHandler>(on_finish), read_ahead,
+        StreamingReadBatchOptions{}.set_max_messages(1), collect_stats));
+  }
+
+  /**
+   * Create a new instance delivering messages in batches.
+   *
+   * @param on_read the handler for each batch of successful `Read()` results.
+   * @param on_finish the handler for a completed `Finish()` result.
+   * @param options control the size of the batches and how long to wait for a
+   *   batch to fill. At most `options.max_messages()` messages are buffered
+   *   while @p on_read is busy.
+   * @param collect_stats if true, collect the statistics returned by
+   *   `stats()`.
+   */
+  static std::shared_ptr<AsyncReadStreamImpl> CreateBatched(
+      OnReadHandler&& on_read, OnFinishHandler&& on_finish,
+      StreamingReadBatchOptions const& options, bool collect_stats = false) {
+    static_assert(Batched, "CreateBatched() requires a batched stream");
+    return std::shared_ptr<AsyncReadStreamImpl>(new AsyncReadStreamImpl(
+        std::forward<OnReadHandler>(on_read),
+        std::forward<OnFinishHandler>(on_finish), options.max_messages(),
+        options, collect_stats));
   }
 
   /**
@@ -156,6 +203,7 @@ class AsyncReadStreamImpl
 
     context_ = std::move(context);
     cq_ = std::move(cq);
+    if (stats_) stats_->OnStart();
     auto callback = std::make_shared<NotifyStart>(this->shared_from_this());
     cq_->StartOperation(std::move(callback), [&](void* tag) {
       // @note If the the `CompletionQueue` has been `Shutdown()` this lambda is
@@ -168,7 +216,19 @@ class AsyncReadStreamImpl
   }
 
   /// Cancel the current streaming read RPC.
-  void Cancel() override { context_->TryCancel(); }
+  void Cancel() override {
+    std::unique_lock<std::mutex> lk(mu_);
+    auto timer = StopLingerTimer(lk);
+    lk.unlock();
+    if (timer.valid()) timer.cancel();
+    context_->TryCancel();
+  }
+
+  /// Return the statistics for this stream, if they are collected.
+  StreamingReadStats stats() const override {
+    if (!stats_) return StreamingReadStats{};
+    return stats_->Snapshot();
+  }
 
  private:
   /// Handle a completed `Start()` request.
@@ -177,57 +237,302 @@ class AsyncReadStreamImpl
       Finish();
       return;
     }
-    Read();
+    StartReadLoop();
   }
 
-  /// Start a `Read()` request.
-  void Read() {
-    // An adapter to call `OnRead()` via the completion queue.
-    class NotifyRead final : public AsyncGrpcOperation {
-     public:
-      explicit NotifyRead(std::shared_ptr<AsyncReadStreamImpl> c)
-          : control_(std::move(c)) {}
+  /**
+   * An adapter to call `OnRead()` via the completion queue.
+   *
+   * The stream uses a single object of this type for all its `Read()` calls.
+   * The object remains registered with the completion queue until a `Read()`
+   * fails, and each message is read into the same `response` buffer.
+   */
+  class NotifyRead final : public AsyncGrpcOperation {
+   public:
+    explicit NotifyRead(std::shared_ptr<AsyncReadStreamImpl> c)
+        : control_(std::move(c)) {}
 
-      Response response;
+    Response response;
 
-     private:
-      void Cancel() override {}  // LCOV_EXCL_LINE
-      bool Notify(bool ok) override {
-        control_->OnRead(ok, std::move(response));
-        return true;
-      }
-      std::shared_ptr<AsyncReadStreamImpl> control_;
-    };
+   private:
+    void Cancel() override {}  // LCOV_EXCL_LINE
+    bool Notify(bool ok) override { return control_->OnRead(ok); }
 
+    std::shared_ptr<AsyncReadStreamImpl> control_;
+  };
+
+  /// Register the read operation and start the first `Read()` request.
+  void StartReadLoop() {
     auto callback = std::make_shared<NotifyRead>(this->shared_from_this());
-    auto response = &callback->response;
-    cq_->StartOperation(std::move(callback),
-                        [&](void* tag) { reader_->Read(response, tag); });
+    read_op_ = callback.get();
+    cq_->StartOperation(std::move(callback), [this](void* tag) {
+      reader_->Read(&read_op_->response, tag);
+    });
   }
 
-  /// Handle the result of a `Read()` call.
-  void OnRead(bool ok, Response response) {
+  /// Start the next `Read()` request.
+  void Read() {
+    cq_->RestartOperation(*read_op_, [this](void* tag) {
+      reader_->Read(&read_op_->response, tag);
+    });
+  }
+
+  /**
+   * Handle the result of a `Read()` call.
+   *
+   * @return true if the read loop has terminated, in which case the read
+   *     operation is released.
+   */
+  bool OnRead(bool ok) {
+    std::unique_lock<std::mutex> lk(mu_);
+    read_pending_ = false;
+    if (stats_) {
+      if (ok) stats_->OnMessage(read_op_->response.ByteSizeLong());
+      if (!ok) stats_->OnEndOfStream();
+    }
     if (!ok) {
-      Finish();
-      return;
+      // Any buffered messages are delivered before calling `Finish()`.
+      eof_ = true;
+      Dispatch(std::move(lk), /*flush=*/true);
+      return true;
+    }
+    if (discarding_) {
+      read_pending_ = true;
+      lk.unlock();
+      Read();
+      return false;
+    }
+    if (!handler_busy_ && buffer_.empty() && linger_.count() == 0) {
+      // The common case: deliver the message without buffering it.
+      handler_busy_ = true;
+      // Move the message out of the read buffer before reading ahead.
+      Batch batch;
+      TakeBatch(read_op_->response, batch);
+      read_pending_ = read_ahead_ != 0;
+      auto const start_read = read_pending_;
+      lk.unlock();
+      if (start_read) Read();
+      Deliver(std::move(batch));
+      return false;
+    }
+    if (max_bytes_ != 0) buffer_bytes_ += read_op_->response.ByteSizeLong();
+    buffer_.push_back(std::move(read_op_->response));
+    Dispatch(std::move(lk), /*flush=*/false);
+    return false;
+  }
+
+  /// Deliver the next batch if it is ready, and decide whether to keep reading.
+  void Dispatch(std::unique_lock<std::mutex> lk, bool flush) {
+    Batch batch;
+    future<void> timer;
+    auto const deliver = !handler_busy_ && !buffer_.empty() &&
+                         (flush || linger_.count() == 0 || BatchFull());
+    if (deliver) {
+      handler_busy_ = true;
+      TakeBatch(batch);
+      // The linger period applies to each batch, stop the timer for this one.
+      timer = StopLingerTimer(lk);
+    }
+    auto const start_read = ShouldRead();
+    if (start_read) read_pending_ = true;
+    auto const start_timer = !handler_busy_ && !buffer_.empty() &&
+                             linger_.count() != 0 && !linger_pending_;
+    if (start_timer) linger_pending_ = true;
+    auto const generation = linger_generation_;
+    auto const finish =
+        eof_ && !handler_busy_ && buffer_.empty() && !finishing_;
+    if (finish) finishing_ = true;
+    lk.unlock();
+    if (timer.valid()) timer.cancel();
+    if (start_read) Read();
+    if (start_timer) StartLingerTimer(generation);
+    if (finish) Finish();
+    if (deliver) Deliver(std::move(batch));
+  }
+
+  /// Return true if the stream should start a new `Read()`, `mu_` is held.
+  bool ShouldRead() const {
+    if (read_pending_ || eof_) return false;
+    // While the handler is idle the stream keeps reading to fill a batch,
+    // otherwise it stops once `read_ahead_` messages are buffered.
+    return discarding_ || !handler_busy_ || buffer_.size() < read_ahead_;
+  }
+
+  /// Return true if the buffered messages fill a batch, `mu_` is held.
+  bool BatchFull() const {
+    return buffer_.size() >= max_messages_ ||
+           (max_bytes_ != 0 && buffer_bytes_ >= max_bytes_);
+  }
+
+  /// Move a single message into @p response.
+  static void TakeBatch(Response& message, Response& response) {
+    response = std::move(message);
+  }
+
+  /// Move a single message into @p batch.
+  static void TakeBatch(Response& message, std::vector<Response>& batch) {
+    batch.push_back(std::move(message));
+  }
+
+  /// Move the next message from the buffer into @p response.
+  void TakeBatch(Response& response) {
+    response = std::move(buffer_.front());
+    buffer_.pop_front();
+  }
+
+  /// Move the next batch from the buffer into @p batch.
+  void TakeBatch(std::vector<Response>& batch) {
+    std::size_t bytes = 0;
+    while (!buffer_.empty() && batch.size() < max_messages_ &&
+           (max_bytes_ == 0 || batch.empty() || bytes < max_bytes_)) {
+      if (max_bytes_ != 0) bytes += buffer_.front().ByteSizeLong();
+      batch.push_back(std::move(buffer_.front()));
+      buffer_.pop_front();
     }
+    buffer_bytes_ = bytes > buffer_bytes_ ? 0 : buffer_bytes_ - bytes;
+  }
 
-    auto continue_reading = on_read_(std::move(response));
+  /**
+   * Deliver a partial batch once the linger period expires.
+   *
+   * @p generation identifies the batch, a timer that expires after its batch
+   * was delivered (or the stream was cancelled) is ignored.
+   */
+  void StartLingerTimer(std::uint64_t generation) {
     auto self = this->shared_from_this();
-    continue_reading.then([self](future<bool> result) {
-      if (!result.get()) {
-        // Cancel the stream, this is what the user meant by returning `false`.
-        self->Cancel();
-        // Start discarding messages, gRPC requires that any pending messages
-        // are read before calling Finish(). So we need to read until the first
-        // message that returns ok==false.
-        self->Discard();
+    auto timer = cq_->MakeRelativeTimer(linger_).then(
+        [self, generation](
+            future<StatusOr<std::chrono::system_clock::time_point>> f) {
+          if (f.get()) self->OnLinger(generation);
+        });
+    std::unique_lock<std::mutex> lk(mu_);
+    if (linger_pending_ && generation == linger_generation_) {
+      linger_timer_ = std::move(timer);
+      return;
+    }
+    // The batch was delivered, or the stream cancelled, before the timer was
+    // stored.
+    lk.unlock();
+    timer.cancel();
+  }
+
+  /**
+   * Stop the pending linger timer, if any, `mu_` is held.
+   *
+   * @return the timer, the caller must cancel it after releasing `mu_`.
+   */
+  future<void> StopLingerTimer(std::unique_lock<std::mutex> const&) {
+    linger_pending_ = false;
+    ++linger_generation_;
+    return std::move(linger_timer_);
+  }
+
+  /// Handle an expired linger timer.
+  void OnLinger(std::uint64_t generation) {
+    std::unique_lock<std::mutex> lk(mu_);
+    if (!linger_pending_ || generation != linger_generation_) return;
+    // This timer has expired, there is no need to cancel it.
+    (void)StopLingerTimer(lk);
+    Dispatch(std::move(lk), /*flush=*/true);
+  }
+
+  /**
+   * Call `on_read_` with @p batch, and with any buffered messages.
+   *
+   * Only one call to `on_read_` is active at a time. Handlers that complete
+   * synchronously are called in a loop, the loop continues in a callback if the
+   * handler returns an unsatisfied future.
+   */
+  void Deliver(Batch batch) {
+    bool keep_reading;
+    do {
+      auto const start =
+          stats_ ? StreamingReadStatsRecorder::Clock::now()
+                 : StreamingReadStatsRecorder::Clock::time_point{};
+      if (!OnReadResult(on_read_(std::move(batch)), keep_reading, start)) {
         return;
       }
-      self->Read();
+      if (stats_) stats_->OnHandlerDone(start);
+    } while (NextBatch(keep_reading, batch));
+  }
+
+  /// Handle a synchronous result from `on_read_`.
+  bool OnReadResult(bool result, bool& keep_reading,
+                    StreamingReadStatsRecorder::Clock::time_point) {
+    keep_reading = result;
+    return true;
+  }
+
+  /**
+   * Handle a `future<bool>` result from `on_read_`.
+   *
+   * Most handlers return a satisfied future, avoid creating a continuation in
+   * that case.
+   *
+   * @return true if @p keep_reading is available immediately.
+   */
+  bool OnReadResult(future<bool> result, bool& keep_reading,
+                    StreamingReadStatsRecorder::Clock::time_point start) {
+    if (result.is_ready()) {
+      keep_reading = result.get();
+      return true;
+    }
+    auto self = this->shared_from_this();
+    result.then([self, start](future<bool> f) {
+      if (self->stats_) self->stats_->OnHandlerDone(start);
+      Batch batch;
+      if (self->NextBatch(f.get(), batch)) self->Deliver(std::move(batch));
     });
+    return false;
+  }
+
+  /**
+   * Update the read loop after `on_read_` completes.
+   *
+   * @return true if there are buffered messages to deliver, and in that case
+   *     sets @p batch to the next batch.
+   */
+  bool NextBatch(bool keep_reading, Batch& batch) {
+    std::unique_lock<std::mutex> lk(mu_);
+    future<void> timer;
+    if (!keep_reading) {
+      // Cancel the stream, this is what the user meant by returning `false`.
+      // Start discarding messages, gRPC requires that any pending messages
+      // are read before calling Finish(). So we need to read until the first
+      // message that returns ok==false.
+      discarding_ = true;
+      if (stats_) stats_->OnDiscardStart();
+      buffer_.clear();
+      buffer_bytes_ = 0;
+      timer = StopLingerTimer(lk);
+    }
+    if (!buffer_.empty()) {
+      // These messages were received while the handler was busy, deliver them
+      // without waiting for the batch to fill.
+      ClearBatch(batch);
+      TakeBatch(batch);
+      auto const start_read = ShouldRead();
+      if (start_read) read_pending_ = true;
+      lk.unlock();
+      if (start_read) Read();
+      return true;
+    }
+    handler_busy_ = false;
+    auto const start_read = ShouldRead();
+    if (start_read) read_pending_ = true;
+    auto const finish = eof_ && !finishing_;
+    if (finish) finishing_ = true;
+    lk.unlock();
+    if (timer.valid()) timer.cancel();
+    if (!keep_reading) Cancel();
+    if (start_read) Read();
+    if (finish) Finish();
+    return false;
   }
 
+  static void ClearBatch(Response&) {}
+  static void ClearBatch(std::vector<Response>& batch) { batch.clear(); }
+
   /// Start a Finish() request on the underlying read stream.
   void Finish() {
     // An adapter to call `OnFinish()` via the completion queue.
@@ -247,6 +552,11 @@ class AsyncReadStreamImpl
       std::shared_ptr<AsyncReadStreamImpl> control_;
     };
 
+    std::unique_lock<std::mutex> lk(mu_);
+    auto timer = StopLingerTimer(lk);
+    lk.unlock();
+    if (timer.valid()) timer.cancel();
+
     auto callback = std::make_shared<NotifyFinish>(this->shared_from_this());
     auto status = &callback->status;
     cq_->StartOperation(std::move(callback),
@@ -255,60 +565,70 @@ class AsyncReadStreamImpl
 
   /// Handle the result of a Finish() request.
   void OnFinish(bool ok, Status status) {
-    on_finish_(ok ? std::move(status)
-                  : Status(StatusCode::kCancelled, "call cancelled"));
-  }
-
-  /**
-   * Discard all the messages until OnRead() receives a failure.
-   *
-   * gRPC requires that `Finish()` be called only once all received values have
-   * been discarded. When we cancel a request as a result of `OnRead()`
-   * returning false we need to ignore future messages before calling
-   * `Finish()`.
-   */
-  void Discard() {
-    // An adapter to call `OnDiscard()` via the completion queue.
-    class NotifyDiscard final : public AsyncGrpcOperation {
-     public:
-      explicit NotifyDiscard(std::shared_ptr<AsyncReadStreamImpl> c)
-          : control_(std::move(c)) {}
-
-      Response response;
-
-     private:
-      void Cancel() override {}  // LCOV_EXCL_LINE
-      bool Notify(bool ok) override {
-        control_->OnDiscard(ok, std::move(response));
-        return true;
-      }
-      std::shared_ptr<AsyncReadStreamImpl> control_;
-    };
-
-    auto callback = std::make_shared<NotifyDiscard>(this->shared_from_this());
-    auto response = &callback->response;
-    cq_->StartOperation(std::move(callback),
-                        [&](void* tag) { reader_->Read(response, tag); });
+    if (!ok) status = Status(StatusCode::kCancelled, "call cancelled");
+    if (stats_) stats_->OnFinish(status);
+    on_finish_(std::move(status));
   }
 
-  /// Handle the result of a Discard() call.
-  void OnDiscard(bool ok, Response) {
-    if (!ok) {
-      Finish();
-      return;
-    }
-    Discard();
-  }
-
-  explicit AsyncReadStreamImpl(OnReadHandler&& on_read,
-                               OnFinishHandler&& on_finish)
-      : on_read_(std::move(on_read)), on_finish_(std::move(on_finish)) {}
+  AsyncReadStreamImpl(OnReadHandler&& on_read, OnFinishHandler&& on_finish,
+                      std::size_t read_ahead,
+                      StreamingReadBatchOptions const& batch_options,
+                      bool collect_stats)
+      : on_read_(std::move(on_read)),
+        on_finish_(std::move(on_finish)),
+        read_ahead_(read_ahead),
+        max_messages_(batch_options.max_messages()),
+        max_bytes_(batch_options.max_bytes()),
+        linger_(batch_options.linger()),
+        stats_(collect_stats ? ::google::cloud::internal::make_unique<
+                                   StreamingReadStatsRecorder>()
+                             : nullptr) {}
 
   typename std::decay<OnReadHandler>::type on_read_;
   typename std::decay<OnFinishHandler>::type on_finish_;
   std::unique_ptr<grpc::ClientContext> context_;
   std::shared_ptr<CompletionQueueImpl> cq_;
   std::unique_ptr<grpc::ClientAsyncReaderInterface<Response>> reader_;
+
+  /// The read operation, owned by the completion queue while it is pending.
+  NotifyRead* read_op_ = nullptr;
+  std::size_t const read_ahead_;
+  std::size_t const max_messages_;
+  std::size_t const max_bytes_;
+  std::chrono::microseconds const linger_;
+  /// Null unless the application requested statistics for this stream.
+  std::unique_ptr<StreamingReadStatsRecorder> const stats_;
+
+  std::mutex mu_;
+  /// Messages received while `on_read_` is busy, at most `read_ahead_`.
+  std::deque<Response> buffer_;  // GUARDED_BY(mu_)
+  /// The total size of `buffer_`, only computed if `max_bytes_` is set.
+  std::size_t buffer_bytes_ = 0;  // GUARDED_BY(mu_)
+  /// Set while a linger timer is pending.
+  bool linger_pending_ = false;  // GUARDED_BY(mu_)
+  /// Identifies the batch for the current linger timer.
+  std::uint64_t linger_generation_ = 0;  // GUARDED_BY(mu_)
+  /// The pending linger timer, cancelled once its batch is delivered.
+  future<void> linger_timer_;  // GUARDED_BY(mu_)
+  /// Set once `Finish()` is called.
+  bool finishing_ = false;  // GUARDED_BY(mu_)
+  /// Set while `on_read_` (or the future it returned) is pending.
+  bool handler_busy_ = false;  // GUARDED_BY(mu_)
+  /// Set while a `Read()` request is pending.
+  bool read_pending_ = false;  // GUARDED_BY(mu_)
+  /// Set when a `Read()` request fails, `Finish()` is called once the
+  /// buffered messages are delivered.
+  bool eof_ = false;  // GUARDED_BY(mu_)
+
+  /**
+   * Discard all the messages until `OnRead()` receives a failure.
+   *
+   * gRPC requires that `Finish()` be called only once all received values have
+   * been discarded. When we cancel a request as a result of `on_read_`
+   * returning false we need to ignore future messages before calling
+   * `Finish()`.
+   */
+  bool discarding_ = false;  // GUARDED_BY(mu_)
 };
 
 /**
@@ -317,6 +637,9 @@ class AsyncReadStreamImpl
  * @param on_read the handler for a successful `Read()` result. Failed
  *   `Read()` operations automatically terminate the loop and call `Finish()`.
  * @param on_finish the handler for a completed `Finish()` result.
+ * @param read_ahead the maximum number of messages received, but not yet
+ *   delivered to @p on_read.
+ * @param collect_stats if true, collect statistics for the stream.
  *
  * @tparam Response the type of the response.
  * @tparam OnReadHandler the type of @p on_read.
@@ -327,19 +650,66 @@ template <
     typename std::enable_if<
         google::cloud::internal::is_invocable<OnReadHandler, Response>::value,
         int>::type on_read_is_invocable_with_response = 0,
+    typename on_read_result_t =
+        google::cloud::internal::invoke_result_t<OnReadHandler, Response>,
     typename std::enable_if<
-        std::is_same<future<bool>, google::cloud::internal::invoke_result_t<
-                                       OnReadHandler, Response>>::value,
-        int>::type on_read_returns_future_bool = 0,
+        google::cloud::internal::disjunction<
+            std::is_same<future<bool>, on_read_result_t>,
+            std::is_same<bool, on_read_result_t>>::value,
+        int>::type on_read_returns_bool_or_future_bool = 0,
     typename std::enable_if<
         google::cloud::internal::is_invocable<OnFinishHandler, Status>::value,
         int>::type on_finish_is_invocable_with_status = 0>
 inline std::shared_ptr<
     AsyncReadStreamImpl<Response, OnReadHandler, OnFinishHandler>>
-MakeAsyncReadStreamImpl(OnReadHandler&& on_read, OnFinishHandler&& on_finish) {
+MakeAsyncReadStreamImpl(OnReadHandler&& on_read, OnFinishHandler&& on_finish,
+                        std::size_t read_ahead = 0,
+                        bool collect_stats = false) {
   return AsyncReadStreamImpl<Response, OnReadHandler, OnFinishHandler>::Create(
       std::forward<OnReadHandler>(on_read),
-      std::forward<OnFinishHandler>(on_finish));
+      std::forward<OnFinishHandler>(on_finish), read_ahead, collect_stats);
+}
+
+/**
+ * Create an `AsyncReadStreamImpl<Response>` that delivers batches of messages.
+ *
+ * @param on_read the handler for each batch of successful `Read()` results, it
+ *   receives a `std::vector<Response>` with at least one element.
+ * @param on_finish the handler for a completed `Finish()` result.
+ * @param options control the size of the batches.
+ * @param collect_stats if true, collect statistics for the stream.
+ *
+ * @tparam Response the type of the response.
+ * @tparam OnReadHandler the type of @p on_read.
+ * @tparam OnFinishHandler the type of @p on_finish.
+ */
+template <typename Response, typename OnReadHandler, typename OnFinishHandler,
+          typename std::enable_if<
+              google::cloud::internal::is_invocable<
+                  OnReadHandler, std::vector<Response>>::value,
+              int>::type on_read_is_invocable_with_batch = 0,
+          typename on_read_result_t = google::cloud::internal::invoke_result_t<
+              OnReadHandler, std::vector<Response>>,
+          typename std::enable_if<
+              google::cloud::internal::disjunction<
+                  std::is_same<future<bool>, on_read_result_t>,
+                  std::is_same<bool, on_read_result_t>>::value,
+              int>::type on_read_returns_bool_or_future_bool = 0,
+          typename std::enable_if<google::cloud::internal::is_invocable<
+                                      OnFinishHandler, Status>::value,
+                                  int>::type on_finish_is_invocable_with_status =
+              0>
+inline std::shared_ptr<
+    AsyncReadStreamImpl<Response, OnReadHandler, OnFinishHandler, true>>
+MakeAsyncBatchReadStreamImpl(OnReadHandler&& on_read,
+                             OnFinishHandler&& on_finish,
+                             StreamingReadBatchOptions const& options,
+                             bool collect_stats = false) {
+  using Impl =
+      AsyncReadStreamImpl<Response, OnReadHandler, OnFinishHandler, true>;
+  return Impl::CreateBatched(std::forward<OnReadHandler>(on_read),
+                             std::forward<OnFinishHandler>(on_finish),
+                             options, collect_stats);
 }
 
 }  // namespace internal
@@ -0,0 +1,387 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_INTERNAL_ASYNC_RETRY_STREAMING_READ_RPC_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_INTERNAL_ASYNC_RETRY_STREAMING_READ_RPC_H
+
+#include "google/cloud/completion_queue.h"
+#include "google/cloud/internal/async_read_stream_impl.h"
+#include "google/cloud/internal/disjunction.h"
+#include "google/cloud/internal/invoke_result.h"
+#include "google/cloud/internal/make_unique.h"
+#include "google/cloud/internal/retry_info.h"
+#include "google/cloud/version.h"
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace google {
+namespace cloud {
+inline namespace GOOGLE_CLOUD_CPP_NS {
+namespace internal {
+
+/**
+ * Make an asynchronous streaming read RPC, resuming the stream on failures.
+ *
+ * This class creates a future<> that becomes satisfied when the streaming read
+ * either:
+ *
+ * - Reads all the messages successfully.
+ * - Fails with a non-retryable error.
+ * - The retry policy expires.
+ * - The `on_read` handler stops the stream by returning `false`.
+ * - The application cancels the returned future.
+ *
+ * When the stream fails with a retryable error the class waits, using the
+ * backoff policy, and then starts a new stream. Before each message is
+ * delivered to `on_read`, the class calls `update_request` to rewrite the
+ * request, typically to resume after the last delivered message (for example,
+ * by setting a resume token or a starting key). Thus the new stream does not
+ * deliver any message twice. If a stream delivers any messages before failing
+ * the backoff policy is reset, as the failure is unrelated to the previous
+ * ones. If the error includes a `google.rpc.RetryInfo` the class waits for the
+ * delay requested by the service instead, bounded by the backoff policy.
+ *
+ * @tparam RPCBackoffPolicy the type of the backoff policy.
+ * @tparam RPCRetryPolicy the type of the retry policy.
+ * @tparam AsyncCallType the type of the callable used to start each stream.
+ * @tparam RequestType the type of the request object.
+ * @tparam OnReadHandler the type of the callable to handle each message. It
+ *     must return `bool` or `future<bool>`, `true` to continue reading, `false`
+ *     to stop the stream.
+ * @tparam UpdateRequest the type of the callable to update the request. It must
+ *     be invocable as `void(RequestType&, Response const&)`.
+ */
+template <typename RPCBackoffPolicy, typename RPCRetryPolicy,
+          typename AsyncCallType, typename RequestType, typename OnReadHandler,
+          typename UpdateRequest>
+class RetryAsyncStreamingReadRpc {
+ public:
+  //@{
+  /// @name Convenience aliases for the RPC request and response types.
+  using Request = RequestType;
+  using Response = typename AsyncStreamingReadResponseType<AsyncCallType,
+                                                           RequestType>::type;
+  //@}
+
+  /**
+   * Start the asynchronous streaming read and its retry loop.
+   *
+   * @param cq the completion queue where the retry loop is executed.
+   * @param location typically the name of the function that created this
+   *     asynchronous retry loop.
+   * @param rpc_retry_policy controls the number of retries, and what errors are
+   *     considered retryable.
+   * @param rpc_backoff_policy determines the wait time between retries.
+   * @param async_call the callable to start a new streaming read RPC.
+   * @param request the initial request, updated by @p update_request as
+   *     messages are delivered.
+   * @param on_read the handler for each message.
+   * @param update_request rewrites the request so a new stream resumes after
+   *     the given message.
+   * @return a future that becomes satisfied with the final status of the
+   *     streaming read.
+   */
+  static future<Status> Start(
+      CompletionQueue cq, char const* location,
+      std::unique_ptr<RPCRetryPolicy> rpc_retry_policy,
+      std::unique_ptr<RPCBackoffPolicy> rpc_backoff_policy,
+      AsyncCallType async_call, Request request, OnReadHandler on_read,
+      UpdateRequest update_request) {
+    std::shared_ptr<RetryAsyncStreamingReadRpc> self(
+        new RetryAsyncStreamingReadRpc(
+            location, std::move(rpc_retry_policy),
+            std::move(rpc_backoff_policy), std::move(async_call),
+            std::move(request), std::move(on_read), std::move(update_request)));
+    auto future = self->final_result_.get_future();
+    StartIteration(self, std::move(cq));
+    return future;
+  }
+
+ private:
+  using OnReadResultType =
+      typename std::decay<invoke_result_t<OnReadHandler, Response>>::type;
+
+  // The constructor is private because we always want to wrap the object in
+  // a shared pointer. The lifetime is controlled by any pending operations in
+  // the CompletionQueue.
+  RetryAsyncStreamingReadRpc(char const* location,
+                             std::unique_ptr<RPCRetryPolicy> rpc_retry_policy,
+                             std::unique_ptr<RPCBackoffPolicy> rpc_backoff_policy,
+                             AsyncCallType async_call, Request request,
+                             OnReadHandler on_read,
+                             UpdateRequest update_request)
+      : location_(location),
+        rpc_retry_policy_(std::move(rpc_retry_policy)),
+        initial_backoff_policy_(rpc_backoff_policy->clone()),
+        rpc_backoff_policy_(std::move(rpc_backoff_policy)),
+        async_call_(std::move(async_call)),
+        request_(std::move(request)),
+        on_read_(std::move(on_read)),
+        update_request_(std::move(update_request)),
+        cancellation_(std::make_shared<CancellationState>()),
+        final_result_(MakeCancellationCallback(cancellation_)) {}
+
+  /**
+   * Track cancellation requests for the retry loop.
+   *
+   * The future returned by `Start()` may outlive this object, so its
+   * cancellation callback shares this state instead of capturing `this`.
+   */
+  struct CancellationState {
+    std::mutex mu;
+    bool cancelled = false;
+    /// The current stream, if any.
+    std::shared_ptr<AsyncOperation> stream;
+    /// Set if the current stream finished before `SetStream()` was called.
+    bool stream_done = false;
+    /// The pending backoff timer, if any.
+    future<void> timer;
+  };
+
+  static std::function<void()> MakeCancellationCallback(
+      std::shared_ptr<CancellationState> state) {
+    return [state] {
+      std::unique_lock<std::mutex> lk(state->mu);
+      state->cancelled = true;
+      auto stream = std::move(state->stream);
+      auto timer = std::move(state->timer);
+      lk.unlock();
+      if (stream) stream->Cancel();
+      if (timer.valid()) timer.cancel();
+    };
+  }
+
+  /// Return true if the application cancelled the retry loop.
+  bool Cancelled() {
+    std::lock_guard<std::mutex> lk(cancellation_->mu);
+    return cancellation_->cancelled;
+  }
+
+  /// Save @p stream so it can be cancelled by the application.
+  void SetStream(std::shared_ptr<AsyncOperation> stream) {
+    std::unique_lock<std::mutex> lk(cancellation_->mu);
+    if (!cancellation_->cancelled) {
+      // Do not keep a finished stream, it owns a reference to this object.
+      if (!cancellation_->stream_done) cancellation_->stream = std::move(stream);
+      return;
+    }
+    lk.unlock();
+    stream->Cancel();
+  }
+
+  /// Release the current stream, it has finished.
+  void ClearStream() {
+    std::unique_lock<std::mutex> lk(cancellation_->mu);
+    cancellation_->stream_done = true;
+    auto stream = std::move(cancellation_->stream);
+    lk.unlock();
+  }
+
+  /// Save @p timer so it can be cancelled by the application.
+  void SetTimer(future<void> timer) {
+    std::unique_lock<std::mutex> lk(cancellation_->mu);
+    if (!cancellation_->cancelled) {
+      cancellation_->timer = std::move(timer);
+      return;
+    }
+    lk.unlock();
+    timer.cancel();
+  }
+
+  /// Deliver @p response to the application, after updating the request.
+  static OnReadResultType OnRead(
+      std::shared_ptr<RetryAsyncStreamingReadRpc> const& self,
+      Response response) {
+    self->update_request_(self->request_, response);
+    self->has_progress_ = true;
+    return OnReadResult(self, self->on_read_(std::move(response)));
+  }
+
+  /// Record a synchronous result from `on_read_`.
+  static bool OnReadResult(
+      std::shared_ptr<RetryAsyncStreamingReadRpc> const& self,
+      bool keep_reading) {
+    if (!keep_reading) self->stopped_ = true;
+    return keep_reading;
+  }
+
+  /// Record an asynchronous result from `on_read_`.
+  static future<bool> OnReadResult(
+      std::shared_ptr<RetryAsyncStreamingReadRpc> const& self,
+      future<bool> keep_reading) {
+    if (keep_reading.is_ready()) {
+      return make_ready_future(OnReadResult(self, keep_reading.get()));
+    }
+    return keep_reading.then(
+        [self](future<bool> f) { return OnReadResult(self, f.get()); });
+  }
+
+  /// The callback for a completed stream, successful or not.
+  static void OnFinish(std::shared_ptr<RetryAsyncStreamingReadRpc> self,
+                       CompletionQueue cq, Status status) {
+    // The stream owns a reference to this object, break the cycle.
+    self->ClearStream();
+    if (status.ok() || self->stopped_) {
+      if (status.ok()) self->rpc_retry_policy_->OnSuccess();
+      self->final_result_.set_value(std::move(status));
+      return;
+    }
+    if (self->Cancelled()) {
+      self->final_result_.set_value(
+          self->DetailedStatus("retry loop cancelled", status));
+      return;
+    }
+    if (!self->rpc_retry_policy_->OnFailure(status)) {
+      auto failure_description =
+          RPCRetryPolicy::RetryableTraits::IsPermanentFailure(status)
+              ? "permanent failure"
+              : "retry policy exhausted";
+      self->final_result_.set_value(
+          self->DetailedStatus(failure_description, status));
+      return;
+    }
+    if (self->has_progress_) {
+      self->rpc_backoff_policy_ = self->initial_backoff_policy_->clone();
+      self->has_progress_ = false;
+    }
+    // Prefer the delay requested by the service, if any.
+    auto const delay = BackoffDelay(*self->rpc_backoff_policy_, status);
+    self->SetTimer(
+        cq.MakeRelativeTimer(delay)
+            .then([self, cq](
+                      future<StatusOr<std::chrono::system_clock::time_point>>
+                          result) {
+              auto tp = result.get();
+              if (self->Cancelled()) {
+                self->final_result_.set_value(self->DetailedStatus(
+                    "retry loop cancelled",
+                    Status(StatusCode::kCancelled, "backoff cancelled")));
+              } else if (tp) {
+                StartIteration(self, cq);
+              } else {
+                self->final_result_.set_value(
+                    self->DetailedStatus("timer error", tp.status()));
+              }
+            }));
+  }
+
+  /// Start a new stream, resuming from the last delivered message.
+  static void StartIteration(std::shared_ptr<RetryAsyncStreamingReadRpc> self,
+                             CompletionQueue cq) {
+    {
+      std::lock_guard<std::mutex> lk(self->cancellation_->mu);
+      self->cancellation_->stream_done = false;
+    }
+    auto context =
+        ::google::cloud::internal::make_unique<grpc::ClientContext>();
+    self->SetStream(cq.MakeStreamingReadRpc(
+        self->async_call_, self->request_, std::move(context),
+        [self](Response r) { return OnRead(self, std::move(r)); },
+        [self, cq](Status s) { OnFinish(self, cq, std::move(s)); }));
+  }
+
+  /// Generate an error message
+  Status DetailedStatus(char const* context, Status const& status) {
+    std::string full_message = location_;
+    full_message += context;
+    full_message += ", last error=";
+    full_message += status.message();
+    return Status(status.code(), std::move(full_message),
+                  status.error_details());
+  }
+
+  char const* location_;
+  std::unique_ptr<RPCRetryPolicy> rpc_retry_policy_;
+  std::unique_ptr<RPCBackoffPolicy> initial_backoff_policy_;
+  std::unique_ptr<RPCBackoffPolicy> rpc_backoff_policy_;
+
+  AsyncCallType async_call_;
+  Request request_;
+  OnReadHandler on_read_;
+  UpdateRequest update_request_;
+
+  // The stream calls `on_read_`, and then `on_finish`, from one callback at a
+  // time, and a new stream starts only after the previous one finishes. These
+  // members do not need a mutex.
+  bool has_progress_ = false;
+  bool stopped_ = false;
+
+  std::shared_ptr<CancellationState> cancellation_;
+  promise<Status> final_result_;
+};
+
+/**
+ * Automatically deduce the type for `RetryAsyncStreamingReadRpc` and start the
+ * streaming read and its retry loop.
+ *
+ * @param cq the completion queue where the retry loop is executed.
+ * @param location typically the name of the function that created this
+ *     asynchronous retry loop.
+ * @param rpc_retry_policy controls the number of retries, and what errors are
+ *     considered retryable.
+ * @param rpc_backoff_policy determines the wait time between retries.
+ * @param async_call the callable to start a new streaming read RPC.
+ * @param request the initial request.
+ * @param on_read the handler for each message, it must return `bool` or
+ *     `future<bool>`.
+ * @param update_request rewrites the request to resume after a message, it is
+ *     called before the message is delivered to @p on_read.
+ *
+ * @return a future that becomes satisfied when (a) the stream completes
+ *     successfully, or (b) one of the streams fails with a non-retryable error,
+ *     or (c) the retry policy is expired, or (d) @p on_read returns `false`, in
+ *     which case the future has the status reported by the stream.
+ */
+template <
+    typename RPCBackoffPolicy, typename RPCRetryPolicy, typename AsyncCallType,
+    typename RequestType, typename OnReadHandler, typename UpdateRequest,
+    typename async_call_t = typename std::decay<AsyncCallType>::type,
+    typename request_t = typename std::decay<RequestType>::type,
+    typename Response =
+        typename AsyncStreamingReadResponseType<async_call_t, request_t>::type,
+    typename on_read_t = typename std::decay<OnReadHandler>::type,
+    typename update_request_t = typename std::decay<UpdateRequest>::type,
+    typename on_read_result_t = invoke_result_t<on_read_t, Response>,
+    typename std::enable_if<
+        disjunction<std::is_same<future<bool>, on_read_result_t>,
+                    std::is_same<bool, on_read_result_t>>::value,
+        int>::type = 0,
+    typename std::enable_if<is_invocable<update_request_t, request_t&,
+                                         Response const&>::value,
+                            int>::type = 0>
+future<Status> StartRetryAsyncStreamingReadRpc(
+    CompletionQueue cq, char const* location,
+    std::unique_ptr<RPCRetryPolicy> rpc_retry_policy,
+    std::unique_ptr<RPCBackoffPolicy> rpc_backoff_policy,
+    AsyncCallType&& async_call, RequestType&& request, OnReadHandler&& on_read,
+    UpdateRequest&& update_request) {
+  return RetryAsyncStreamingReadRpc<
+      RPCBackoffPolicy, RPCRetryPolicy, async_call_t, request_t, on_read_t,
+      update_request_t>::Start(std::move(cq), location,
+                               std::move(rpc_retry_policy),
+                               std::move(rpc_backoff_policy),
+                               std::forward<AsyncCallType>(async_call),
+                               std::forward<RequestType>(request),
+                               std::forward<OnReadHandler>(on_read),
+                               std::forward<UpdateRequest>(update_request));
+}
+
+}  // namespace internal
+}  // namespace GOOGLE_CLOUD_CPP_NS
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_INTERNAL_ASYNC_RETRY_STREAMING_READ_RPC_H
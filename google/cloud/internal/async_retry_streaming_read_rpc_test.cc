@@ -0,0 +1,292 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/internal/async_retry_streaming_read_rpc.h"
+#include "google/cloud/internal/backoff_policy.h"
+#include "google/cloud/internal/retry_policy.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include "google/cloud/testing_util/chrono_literals.h"
+#include "google/cloud/testing_util/mock_completion_queue.h"
+#include <google/bigtable/v2/bigtable.grpc.pb.h>
+#include <gmock/gmock.h>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace google {
+namespace cloud {
+inline namespace GOOGLE_CLOUD_CPP_NS {
+namespace internal {
+namespace {
+
+namespace btproto = ::google::bigtable::v2;
+using ::google::cloud::testing_util::MockCompletionQueue;
+using ::testing::_;
+using ::testing::ElementsAre;
+using ::testing::HasSubstr;
+
+class MockStub {
+ public:
+  MOCK_METHOD3(AsyncReadRows,
+               std::unique_ptr<::grpc::ClientAsyncReaderInterface<
+                   btproto::ReadRowsResponse>>(grpc::ClientContext*,
+                                               btproto::ReadRowsRequest const&,
+                                               grpc::CompletionQueue* cq));
+};
+
+class MockRowReader
+    : public grpc::ClientAsyncReaderInterface<btproto::ReadRowsResponse> {
+ public:
+  MOCK_METHOD1(StartCall, void(void*));
+  MOCK_METHOD1(ReadInitialMetadata, void(void*));
+  MOCK_METHOD2(Read, void(btproto::ReadRowsResponse*, void*));
+  MOCK_METHOD2(Finish, void(grpc::Status*, void*));
+};
+
+/// Define which status codes are permanent failures for this test.
+struct IsRetryableTraits {
+  static bool IsPermanentFailure(Status const& status) {
+    return !status.ok() && status.code() != StatusCode::kUnavailable;
+  }
+};
+
+using RpcLimitedErrorCountRetryPolicy =
+    google::cloud::internal::LimitedErrorCountRetryPolicy<Status,
+                                                          IsRetryableTraits>;
+using RpcExponentialBackoffPolicy =
+    google::cloud::internal::ExponentialBackoffPolicy;
+
+/// Create a reader that returns @p keys and then finishes with @p status.
+std::unique_ptr<MockRowReader> MakeReader(std::vector<std::string> keys,
+                                          grpc::Status status) {
+  auto reader = google::cloud::internal::make_unique<MockRowReader>();
+  EXPECT_CALL(*reader, StartCall(_)).Times(1);
+  auto index = std::make_shared<std::size_t>(0);
+  EXPECT_CALL(*reader, Read(_, _))
+      .WillRepeatedly([keys, index](btproto::ReadRowsResponse* r, void*) {
+        if (*index < keys.size()) r->set_last_scanned_row_key(keys[*index]);
+        ++*index;
+      });
+  EXPECT_CALL(*reader, Finish(_, _))
+      .WillOnce([status](grpc::Status* s, void*) { *s = status; });
+  return reader;
+}
+
+/// Rewrite the request to skip the rows already delivered.
+void ResumeAfter(btproto::ReadRowsRequest& request,
+                 btproto::ReadRowsResponse const&) {
+  request.set_rows_limit(request.rows_limit() - 1);
+}
+
+TEST(AsyncRetryStreamingReadRpcTest, ResumesAfterTransientFailure) {
+  using namespace google::cloud::testing_util::chrono_literals;
+
+  std::vector<std::unique_ptr<MockRowReader>> readers;
+  readers.push_back(MakeReader(
+      {"row-0", "row-1"}, grpc::Status(grpc::StatusCode::UNAVAILABLE, "try")));
+  readers.push_back(MakeReader({"row-2"}, grpc::Status::OK));
+
+  MockStub mock;
+  std::vector<std::int64_t> limits;
+  EXPECT_CALL(mock, AsyncReadRows(_, _, _))
+      .Times(2)
+      .WillRepeatedly([&](grpc::ClientContext*,
+                          btproto::ReadRowsRequest const& request,
+                          grpc::CompletionQueue*) {
+        limits.push_back(request.rows_limit());
+        auto reader = std::move(readers.front());
+        readers.erase(readers.begin());
+        return std::unique_ptr<
+            grpc::ClientAsyncReaderInterface<btproto::ReadRowsResponse>>(
+            reader.release());
+      });
+
+  auto impl = std::make_shared<MockCompletionQueue>();
+  CompletionQueue cq(impl);
+
+  btproto::ReadRowsRequest request;
+  request.set_rows_limit(10);
+
+  std::vector<std::string> keys;
+  auto fut = StartRetryAsyncStreamingReadRpc(
+      cq, __func__, RpcLimitedErrorCountRetryPolicy(3).clone(),
+      RpcExponentialBackoffPolicy(10_us, 40_us, 2.0).clone(),
+      [&mock](grpc::ClientContext* context,
+              btproto::ReadRowsRequest const& request,
+              grpc::CompletionQueue* cq) {
+        return mock.AsyncReadRows(context, request, cq);
+      },
+      request,
+      [&keys](btproto::ReadRowsResponse const& r) {
+        keys.push_back(r.last_scanned_row_key());
+        return true;
+      },
+      ResumeAfter);
+
+  impl->SimulateCompletion(true);   // OnStart()
+  impl->SimulateCompletion(true);   // row-0
+  impl->SimulateCompletion(true);   // row-1
+  impl->SimulateCompletion(false);  // the stream fails
+  impl->SimulateCompletion(true);   // Finish()
+  EXPECT_THAT(keys, ElementsAre("row-0", "row-1"));
+  EXPECT_EQ(1, impl->size());       // the backoff timer
+  impl->SimulateCompletion(true);
+
+  impl->SimulateCompletion(true);   // OnStart()
+  impl->SimulateCompletion(true);   // row-2
+  impl->SimulateCompletion(false);  // end of stream
+  impl->SimulateCompletion(true);   // Finish()
+
+  EXPECT_TRUE(impl->empty());
+  ASSERT_EQ(std::future_status::ready, fut.wait_for(0_us));
+  ASSERT_STATUS_OK(fut.get());
+  EXPECT_THAT(keys, ElementsAre("row-0", "row-1", "row-2"));
+  // The second stream only reads the rows that were not delivered.
+  EXPECT_THAT(limits, ElementsAre(10, 8));
+}
+
+TEST(AsyncRetryStreamingReadRpcTest, PermanentFailure) {
+  using namespace google::cloud::testing_util::chrono_literals;
+
+  auto reader = MakeReader(
+      {"row-0"}, grpc::Status(grpc::StatusCode::PERMISSION_DENIED, "uh-oh"));
+  MockStub mock;
+  EXPECT_CALL(mock, AsyncReadRows(_, _, _))
+      .WillOnce([&reader](grpc::ClientContext*, btproto::ReadRowsRequest const&,
+                          grpc::CompletionQueue*) {
+        return std::unique_ptr<
+            grpc::ClientAsyncReaderInterface<btproto::ReadRowsResponse>>(
+            reader.release());
+      });
+
+  auto impl = std::make_shared<MockCompletionQueue>();
+  CompletionQueue cq(impl);
+
+  auto fut = StartRetryAsyncStreamingReadRpc(
+      cq, __func__, RpcLimitedErrorCountRetryPolicy(3).clone(),
+      RpcExponentialBackoffPolicy(10_us, 40_us, 2.0).clone(),
+      [&mock](grpc::ClientContext* context,
+              btproto::ReadRowsRequest const& request,
+              grpc::CompletionQueue* cq) {
+        return mock.AsyncReadRows(context, request, cq);
+      },
+      btproto::ReadRowsRequest{},
+      [](btproto::ReadRowsResponse const&) { return make_ready_future(true); },
+      ResumeAfter);
+
+  impl->SimulateCompletion(true);   // OnStart()
+  impl->SimulateCompletion(true);   // row-0
+  impl->SimulateCompletion(false);  // the stream fails
+  impl->SimulateCompletion(true);   // Finish()
+
+  EXPECT_TRUE(impl->empty());
+  ASSERT_EQ(std::future_status::ready, fut.wait_for(0_us));
+  auto status = fut.get();
+  EXPECT_EQ(StatusCode::kPermissionDenied, status.code());
+  EXPECT_THAT(status.message(), HasSubstr(__func__));
+  EXPECT_THAT(status.message(), HasSubstr("permanent failure"));
+}
+
+TEST(AsyncRetryStreamingReadRpcTest, HandlerStopsStream) {
+  using namespace google::cloud::testing_util::chrono_literals;
+
+  // A retryable status, the loop should not retry because the handler stopped
+  // the stream.
+  auto reader = MakeReader(
+      {"row-0", "row-1"},
+      grpc::Status(grpc::StatusCode::UNAVAILABLE, "cancelled by client"));
+  MockStub mock;
+  EXPECT_CALL(mock, AsyncReadRows(_, _, _))
+      .WillOnce([&reader](grpc::ClientContext*, btproto::ReadRowsRequest const&,
+                          grpc::CompletionQueue*) {
+        return std::unique_ptr<
+            grpc::ClientAsyncReaderInterface<btproto::ReadRowsResponse>>(
+            reader.release());
+      });
+
+  auto impl = std::make_shared<MockCompletionQueue>();
+  CompletionQueue cq(impl);
+
+  auto fut = StartRetryAsyncStreamingReadRpc(
+      cq, __func__, RpcLimitedErrorCountRetryPolicy(3).clone(),
+      RpcExponentialBackoffPolicy(10_us, 40_us, 2.0).clone(),
+      [&mock](grpc::ClientContext* context,
+              btproto::ReadRowsRequest const& request,
+              grpc::CompletionQueue* cq) {
+        return mock.AsyncReadRows(context, request, cq);
+      },
+      btproto::ReadRowsRequest{},
+      [](btproto::ReadRowsResponse const&) { return false; }, ResumeAfter);
+
+  impl->SimulateCompletion(true);   // OnStart()
+  impl->SimulateCompletion(true);   // row-0, the handler stops the stream
+  impl->SimulateCompletion(true);   // row-1, discarded
+  impl->SimulateCompletion(false);  // end of stream
+  impl->SimulateCompletion(true);   // Finish()
+
+  EXPECT_TRUE(impl->empty());
+  ASSERT_EQ(std::future_status::ready, fut.wait_for(0_us));
+  auto status = fut.get();
+  EXPECT_EQ(StatusCode::kUnavailable, status.code());
+  EXPECT_EQ("cancelled by client", status.message());
+}
+
+TEST(AsyncRetryStreamingReadRpcTest, CancelDuringBackoff) {
+  using namespace google::cloud::testing_util::chrono_literals;
+
+  auto reader =
+      MakeReader({}, grpc::Status(grpc::StatusCode::UNAVAILABLE, "try"));
+  MockStub mock;
+  EXPECT_CALL(mock, AsyncReadRows(_, _, _))
+      .WillOnce([&reader](grpc::ClientContext*, btproto::ReadRowsRequest const&,
+                          grpc::CompletionQueue*) {
+        return std::unique_ptr<
+            grpc::ClientAsyncReaderInterface<btproto::ReadRowsResponse>>(
+            reader.release());
+      });
+
+  auto impl = std::make_shared<MockCompletionQueue>();
+  CompletionQueue cq(impl);
+
+  auto fut = StartRetryAsyncStreamingReadRpc(
+      cq, __func__, RpcLimitedErrorCountRetryPolicy(3).clone(),
+      RpcExponentialBackoffPolicy(10_us, 40_us, 2.0).clone(),
+      [&mock](grpc::ClientContext* context,
+              btproto::ReadRowsRequest const& request,
+              grpc::CompletionQueue* cq) {
+        return mock.AsyncReadRows(context, request, cq);
+      },
+      btproto::ReadRowsRequest{},
+      [](btproto::ReadRowsResponse const&) { return true; }, ResumeAfter);
+
+  impl->SimulateCompletion(true);   // OnStart()
+  impl->SimulateCompletion(false);  // the stream fails
+  impl->SimulateCompletion(true);   // Finish()
+  EXPECT_EQ(1, impl->size());       // the backoff timer
+
+  fut.cancel();
+  impl->SimulateCompletion(false);
+
+  EXPECT_TRUE(impl->empty());
+  ASSERT_EQ(std::future_status::ready, fut.wait_for(0_us));
+  auto status = fut.get();
+  EXPECT_EQ(StatusCode::kCancelled, status.code());
+  EXPECT_THAT(status.message(), HasSubstr("retry loop cancelled"));
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace GOOGLE_CLOUD_CPP_NS
+}  // namespace cloud
+}  // namespace google
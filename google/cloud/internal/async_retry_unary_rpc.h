@@ -17,9 +17,13 @@
 
 #include "google/cloud/completion_queue.h"
 #include "google/cloud/internal/completion_queue_impl.h"
-#include "google/cloud/internal/make_unique.h"
+#include "google/cloud/internal/policy_traits.h"
+#include "google/cloud/internal/retry_info.h"
+#include "google/cloud/internal/rpc_attempt_options.h"
 #include "google/cloud/version.h"
 #include <google/protobuf/empty.pb.h>
+#include <memory>
+#include <mutex>
 
 namespace google {
 namespace cloud {
@@ -35,10 +39,29 @@ namespace internal {
  * - Succeeds.
  * - Fails with a non-retryable error.
  * - The retry policy expires.
+ * - The application cancels the returned future.
  *
  * The class retries the operation, using a backoff policy to wait between
- * retries. The class does not block, it uses the completion queue to wait.
+ * retries. If the error includes a `google.rpc.RetryInfo` the class waits for
+ * the delay requested by the service instead, bounded by the backoff policy's
+ * maximum delay. The class does not block, it uses the completion queue to
+ * wait.
  *
+ * Each attempt uses a new `grpc::ClientContext`, its deadline is the retry
+ * policy's deadline, if any, so the service can stop working on requests the
+ * client has given up on. With a per-attempt timeout (see
+ * `RpcAttemptOptions`) slow attempts are abandoned and retried: an attempt
+ * that exceeds its own deadline, but not the retry policy's deadline, is
+ * reported to the retry policy as `kUnavailable`. If the options include an
+ * `AdaptiveThrottler`, attempts rejected by the throttler fail locally with
+ * `kUnavailable`, and are retried (or not) like any other attempt.
+ *
+ * @tparam RPCBackoffPolicy the type of the backoff policy, either a
+ *     `std::unique_ptr<>` to a `BackoffPolicy` or a concrete policy held by
+ *     value, see `PolicyTraits`.
+ * @tparam RPCRetryPolicy the type of the retry policy, either a
+ *     `std::unique_ptr<>` to a `RetryPolicy` or a concrete policy held by
+ *     value.
  * @tparam AsyncCallType the type of the callable used to start the asynchronous
  *     operation. This is typically a lambda that wraps both the `Client` object
  *     and the member function to invoke.
@@ -73,6 +96,7 @@ class RetryAsyncUnaryRpc {
    * @param async_call the callable to start a new asynchronous operation.
    * @param request the parameters of the request.
    * @param cq the completion queue where the retry loop is executed.
+   * @param attempt_options configure the context and timeout for each attempt.
    * @return a future that becomes satisfied when (a) one of the retry attempts
    *     is successful, or (b) one of the retry attempts fails with a
    *     non-retryable error, or (c) one of the retry attempts fails with a
@@ -80,13 +104,14 @@ class RetryAsyncUnaryRpc {
    *     retry policy is expired.
    */
   static future<StatusOr<Response>> Start(
-      CompletionQueue cq, char const* location,
-      std::unique_ptr<RPCRetryPolicy> rpc_retry_policy,
-      std::unique_ptr<RPCBackoffPolicy> rpc_backoff_policy, bool is_idempotent,
-      AsyncCallType async_call, Request request) {
+      CompletionQueue cq, char const* location, RPCRetryPolicy rpc_retry_policy,
+      RPCBackoffPolicy rpc_backoff_policy, bool is_idempotent,
+      AsyncCallType async_call, Request request,
+      RpcAttemptOptions attempt_options = {}) {
     std::shared_ptr<RetryAsyncUnaryRpc> self(new RetryAsyncUnaryRpc(
         location, std::move(rpc_retry_policy), std::move(rpc_backoff_policy),
-        is_idempotent, std::move(async_call), std::move(request)));
+        is_idempotent, std::move(async_call), std::move(request),
+        std::move(attempt_options)));
     auto future = self->final_result_.get_future();
     self->StartIteration(self, std::move(cq));
     return future;
@@ -96,61 +121,170 @@ class RetryAsyncUnaryRpc {
   // The constructor is private because we always want to wrap the object in
   // a shared pointer. The lifetime is controlled by any pending operations in
   // the CompletionQueue.
-  RetryAsyncUnaryRpc(char const* location,
-                     std::unique_ptr<RPCRetryPolicy> rpc_retry_policy,
-                     std::unique_ptr<RPCBackoffPolicy> rpc_backoff_policy,
-                     bool is_idempotent, AsyncCallType async_call,
-                     Request request)
+  RetryAsyncUnaryRpc(char const* location, RPCRetryPolicy rpc_retry_policy,
+                     RPCBackoffPolicy rpc_backoff_policy, bool is_idempotent,
+                     AsyncCallType async_call, Request request,
+                     RpcAttemptOptions attempt_options)
       : location_(location),
         rpc_retry_policy_(std::move(rpc_retry_policy)),
         rpc_backoff_policy_(std::move(rpc_backoff_policy)),
         is_idempotent_(is_idempotent),
         async_call_(std::move(async_call)),
-        request_(std::move(request)) {}
+        request_(std::move(request)),
+        attempt_options_(std::move(attempt_options)),
+        cancellation_(std::make_shared<CancellationState>()),
+        final_result_(MakeCancellationCallback(cancellation_)) {}
+
+  /**
+   * Track cancellation requests for the retry loop.
+   *
+   * The future returned by `Start()` may outlive this object, so its
+   * cancellation callback shares this state instead of capturing `this`.
+   */
+  struct CancellationState {
+    std::mutex mu;
+    bool cancelled = false;
+    /// The pending RPC attempt or backoff timer, if any.
+    future<void> pending;
+  };
+
+  static std::function<void()> MakeCancellationCallback(
+      std::shared_ptr<CancellationState> state) {
+    return [state] {
+      std::unique_lock<std::mutex> lk(state->mu);
+      state->cancelled = true;
+      auto pending = std::move(state->pending);
+      lk.unlock();
+      if (pending.valid()) pending.cancel();
+    };
+  }
+
+  /// Return true if the application cancelled the retry loop.
+  bool Cancelled() {
+    std::lock_guard<std::mutex> lk(cancellation_->mu);
+    return cancellation_->cancelled;
+  }
+
+  /**
+   * Save @p pending so it can be cancelled by the application.
+   *
+   * If the loop was already cancelled @p pending is cancelled immediately.
+   * This is best-effort: the loop also checks `Cancelled()` before starting
+   * a new attempt or backoff timer.
+   */
+  void SetPending(future<void> pending) {
+    std::unique_lock<std::mutex> lk(cancellation_->mu);
+    if (!cancellation_->cancelled) {
+      cancellation_->pending = std::move(pending);
+      return;
+    }
+    lk.unlock();
+    pending.cancel();
+  }
 
   /// The callback for a completed request, successful or not.
   static void OnCompletion(std::shared_ptr<RetryAsyncUnaryRpc> self,
                            CompletionQueue cq, StatusOr<Response> result) {
     if (result) {
+      self->retry_policy().OnSuccess();
       self->final_result_.set_value(std::move(result));
       return;
     }
+    if (self->Cancelled()) {
+      self->final_result_.set_value(
+          self->DetailedStatus("retry loop cancelled", result.status()));
+      return;
+    }
     if (!self->is_idempotent_) {
       self->final_result_.set_value(self->DetailedStatus(
           "non-idempotent operation failed", result.status()));
       return;
     }
-    if (!self->rpc_retry_policy_->OnFailure(result.status())) {
+    if (!self->retry_policy().OnFailure(
+            self->RetryPolicyStatus(result.status()))) {
       auto failure_description =
-          RPCRetryPolicy::RetryableTraits::IsPermanentFailure(result.status())
+          RetryPolicyType::RetryableTraits::IsPermanentFailure(result.status())
               ? "permanent failure"
               : "retry policy exhausted";
       self->final_result_.set_value(
           self->DetailedStatus(failure_description, result.status()));
       return;
     }
-    cq.MakeRelativeTimer(self->rpc_backoff_policy_->OnCompletion())
-        .then([self, cq](future<StatusOr<std::chrono::system_clock::time_point>>
-                             result) {
-          if (auto tp = result.get()) {
-            self->StartIteration(self, cq);
-          } else {
-            self->final_result_.set_value(
-                self->DetailedStatus("timer error", tp.status()));
-          }
-        });
+    // Prefer the delay requested by the service, if any.
+    auto const delay =
+        BackoffDelay(self->backoff_policy(), result.status());
+    self->SetPending(
+        cq.MakeRelativeTimer(delay)
+            .then([self, cq](
+                      future<StatusOr<std::chrono::system_clock::time_point>>
+                          result) {
+              auto tp = result.get();
+              if (self->Cancelled()) {
+                self->final_result_.set_value(self->DetailedStatus(
+                    "retry loop cancelled",
+                    Status(StatusCode::kCancelled, "backoff cancelled")));
+              } else if (tp) {
+                self->StartIteration(self, cq);
+              } else {
+                self->final_result_.set_value(
+                    self->DetailedStatus("timer error", tp.status()));
+              }
+            }));
   }
 
   /// The callback to start another iteration of the retry loop.
   static void StartIteration(std::shared_ptr<RetryAsyncUnaryRpc> self,
                              CompletionQueue cq) {
-    auto context =
-        ::google::cloud::internal::make_unique<grpc::ClientContext>();
+    auto throttler = self->attempt_options_.throttler();
+    if (throttler && !throttler->Admit()) {
+      OnCompletion(self, std::move(cq),
+                   Status(StatusCode::kUnavailable,
+                          "request throttled by the client, the service is "
+                          "overloaded"));
+      return;
+    }
+    auto const retry_deadline = self->retry_policy().deadline();
+    auto context = self->attempt_options_.MakeContext(retry_deadline);
+    self->attempt_deadline_ =
+        context->deadline() < retry_deadline
+            ? context->deadline()
+            : std::chrono::system_clock::time_point::max();
+
+    self->SetPending(
+        cq.MakeUnaryRpc(self->async_call_, self->request_, std::move(context))
+            .then([self, cq, throttler](future<StatusOr<Response>> fut) {
+              auto result = fut.get();
+              if (throttler) throttler->OnResponse(result.status());
+              self->OnCompletion(self, cq, std::move(result));
+            }));
+  }
 
-    cq.MakeUnaryRpc(self->async_call_, self->request_, std::move(context))
-        .then([self, cq](future<StatusOr<Response>> fut) {
-          self->OnCompletion(self, cq, fut.get());
-        });
+  /**
+   * The status of the last attempt, as reported to the retry policy.
+   *
+   * Attempts that exceed their own deadline, but not the retry policy's
+   * deadline, are retryable. Their status is reported as `kUnavailable`. A
+   * `kDeadlineExceeded` error received before the attempt deadline comes from
+   * the service (or a deadline it propagated), and is reported unchanged.
+   */
+  Status RetryPolicyStatus(Status const& status) const {
+    if (status.code() != StatusCode::kDeadlineExceeded ||
+        std::chrono::system_clock::now() < attempt_deadline_) {
+      return status;
+    }
+    return Status(StatusCode::kUnavailable,
+                  "attempt timeout: " + status.message());
+  }
+
+  using RetryPolicyTraits = PolicyTraits<RPCRetryPolicy>;
+  using RetryPolicyType = typename RetryPolicyTraits::type;
+  using BackoffPolicyTraits = PolicyTraits<RPCBackoffPolicy>;
+
+  RetryPolicyType& retry_policy() {
+    return RetryPolicyTraits::Get(rpc_retry_policy_);
+  }
+  typename BackoffPolicyTraits::type& backoff_policy() {
+    return BackoffPolicyTraits::Get(rpc_backoff_policy_);
   }
 
   /// Generate an error message
@@ -159,17 +293,23 @@ class RetryAsyncUnaryRpc {
     full_message += context;
     full_message += ", last error=";
     full_message += status.message();
-    return Status(status.code(), std::move(full_message));
+    return Status(status.code(), std::move(full_message),
+                  status.error_details());
   }
 
   char const* location_;
-  std::unique_ptr<RPCRetryPolicy> rpc_retry_policy_;
-  std::unique_ptr<RPCBackoffPolicy> rpc_backoff_policy_;
+  RPCRetryPolicy rpc_retry_policy_;
+  RPCBackoffPolicy rpc_backoff_policy_;
   bool is_idempotent_;
 
   AsyncCallType async_call_;
   Request request_;
+  RpcAttemptOptions attempt_options_;
+  /// The deadline of the current attempt, if earlier than the retry deadline.
+  std::chrono::system_clock::time_point attempt_deadline_ =
+      std::chrono::system_clock::time_point::max();
 
+  std::shared_ptr<CancellationState> cancellation_;
   promise<StatusOr<Response>> final_result_;
 };
 
@@ -180,14 +320,18 @@ class RetryAsyncUnaryRpc {
  * @param location typically the name of the function that created this
  *     asynchronous retry loop.
  * @param rpc_retry_policy controls the number of retries, and what errors are
- *     considered retryable.
- * @param rpc_backoff_policy determines the wait time between retries.
+ *     considered retryable. Either a `std::unique_ptr<RetryPolicy>`, typically
+ *     the result of `clone()`, or a concrete policy by value. The latter
+ *     avoids a heap allocation and virtual function calls.
+ * @param rpc_backoff_policy determines the wait time between retries. Either a
+ *     `std::unique_ptr<BackoffPolicy>` or a concrete policy by value.
  * @param idempotent_policy determines if a request is retryable.
  * @param metadata_update_policy controls how to update the metadata fields in
  *     the request.
  * @param async_call the callable to start a new asynchronous operation.
  * @param request the parameters of the request.
  * @param cq the completion queue where the retry loop is executed.
+ * @param attempt_options configure the context and timeout for each attempt.
  *
  * @return a future that becomes satisfied when (a) one of the retry attempts
  *     is successful, or (b) one of the retry attempts fails with a
@@ -206,10 +350,10 @@ template <typename RPCBackoffPolicy, typename RPCRetryPolicy,
               int>::type = 0>
 future<StatusOr<typename AsyncCallResponseType<async_call_t, request_t>::type>>
 StartRetryAsyncUnaryRpc(CompletionQueue cq, char const* location,
-                        std::unique_ptr<RPCRetryPolicy> rpc_retry_policy,
-                        std::unique_ptr<RPCBackoffPolicy> rpc_backoff_policy,
-                        bool is_idempotent, AsyncCallType&& async_call,
-                        RequestType&& request) {
+                        RPCRetryPolicy rpc_retry_policy,
+                        RPCBackoffPolicy rpc_backoff_policy, bool is_idempotent,
+                        AsyncCallType&& async_call, RequestType&& request,
+                        RpcAttemptOptions attempt_options = {}) {
   return RetryAsyncUnaryRpc<RPCBackoffPolicy, RPCRetryPolicy, async_call_t,
                             request_t>::Start(std::move(cq), location,
                                               std::move(rpc_retry_policy),
@@ -218,7 +362,8 @@ StartRetryAsyncUnaryRpc(CompletionQueue cq, char const* location,
                                               std::forward<AsyncCallType>(
                                                   async_call),
                                               std::forward<RequestType>(
-                                                  request));
+                                                  request),
+                                              std::move(attempt_options));
 }
 
 }  // namespace internal
@@ -14,12 +14,14 @@
 
 #include "google/cloud/internal/async_retry_unary_rpc.h"
 #include "google/cloud/internal/backoff_policy.h"
+#include "google/cloud/internal/make_unique.h"
 #include "google/cloud/internal/retry_policy.h"
 #include "google/cloud/testing_util/assert_ok.h"
 #include "google/cloud/testing_util/chrono_literals.h"
 #include "google/cloud/testing_util/mock_async_response_reader.h"
 #include "google/cloud/testing_util/mock_completion_queue.h"
 #include <google/bigtable/admin/v2/bigtable_table_admin.grpc.pb.h>
+#include <google/rpc/error_details.pb.h>
 #include <gmock/gmock.h>
 #include <thread>
 
@@ -35,6 +37,7 @@ using ::google::cloud::testing_util::MockCompletionQueue;
 using ::testing::_;
 using ::testing::HasSubstr;
 using ::testing::Invoke;
+using ::testing::Return;
 
 /**
  * A class to test the retry loop.
@@ -76,6 +79,8 @@ using RpcRetryPolicy =
 using RpcLimitedErrorCountRetryPolicy =
     google::cloud::internal::LimitedErrorCountRetryPolicy<Status,
                                                           IsRetryableTraits>;
+using RpcLimitedTimeRetryPolicy =
+    google::cloud::internal::LimitedTimeRetryPolicy<Status, IsRetryableTraits>;
 using RpcBackoffPolicy = google::cloud::internal::BackoffPolicy;
 using RpcExponentialBackoffPolicy =
     google::cloud::internal::ExponentialBackoffPolicy;
@@ -318,6 +323,108 @@ TEST(AsyncRetryUnaryRpcTest, TooManyTransientFailures) {
   EXPECT_THAT(result.status().message(), HasSubstr("try-again"));
 }
 
+TEST(AsyncRetryUnaryRpcTest, CancelDuringCall) {
+  using namespace google::cloud::testing_util::chrono_literals;
+
+  MockStub mock;
+
+  using ReaderType = MockAsyncResponseReader<btadmin::Table>;
+  auto reader = google::cloud::internal::make_unique<ReaderType>();
+  EXPECT_CALL(*reader, Finish(_, _, _))
+      .WillOnce(Invoke([](btadmin::Table*, grpc::Status* status, void*) {
+        *status = grpc::Status(grpc::StatusCode::UNAVAILABLE, "try-again");
+      }));
+
+  EXPECT_CALL(mock, AsyncGetTable(_, _, _))
+      .WillOnce(Invoke([&reader](grpc::ClientContext*,
+                                 btadmin::GetTableRequest const&,
+                                 grpc::CompletionQueue*) {
+        return std::unique_ptr<
+            grpc::ClientAsyncResponseReaderInterface<btadmin::Table>>(
+            reader.get());
+      }));
+
+  auto impl = std::make_shared<MockCompletionQueue>();
+  CompletionQueue cq(impl);
+
+  auto fut = StartRetryAsyncUnaryRpc(
+      cq, __func__, RpcLimitedErrorCountRetryPolicy(2).clone(),
+      RpcExponentialBackoffPolicy(10_us, 40_us, 2.0).clone(),
+      /*is_idempotent=*/true,
+      [&mock](grpc::ClientContext* context,
+              btadmin::GetTableRequest const& request,
+              grpc::CompletionQueue* cq) {
+        return mock.AsyncGetTable(context, request, cq);
+      },
+      btadmin::GetTableRequest{});
+
+  EXPECT_TRUE(fut.cancel());
+  EXPECT_FALSE(fut.cancel());
+
+  // The call completes with a retryable error, but no timer or new attempt
+  // is started.
+  EXPECT_EQ(1, impl->size());
+  impl->SimulateCompletion(true);
+  EXPECT_TRUE(impl->empty());
+
+  EXPECT_EQ(std::future_status::ready, fut.wait_for(0_us));
+  auto result = fut.get();
+  EXPECT_FALSE(result);
+  EXPECT_THAT(result.status().message(), HasSubstr("retry loop cancelled"));
+}
+
+TEST(AsyncRetryUnaryRpcTest, CancelDuringBackoff) {
+  using namespace google::cloud::testing_util::chrono_literals;
+
+  MockStub mock;
+
+  using ReaderType = MockAsyncResponseReader<btadmin::Table>;
+  auto reader = google::cloud::internal::make_unique<ReaderType>();
+  EXPECT_CALL(*reader, Finish(_, _, _))
+      .WillOnce(Invoke([](btadmin::Table*, grpc::Status* status, void*) {
+        *status = grpc::Status(grpc::StatusCode::UNAVAILABLE, "try-again");
+      }));
+
+  EXPECT_CALL(mock, AsyncGetTable(_, _, _))
+      .WillOnce(Invoke([&reader](grpc::ClientContext*,
+                                 btadmin::GetTableRequest const&,
+                                 grpc::CompletionQueue*) {
+        return std::unique_ptr<
+            grpc::ClientAsyncResponseReaderInterface<btadmin::Table>>(
+            reader.get());
+      }));
+
+  auto impl = std::make_shared<MockCompletionQueue>();
+  CompletionQueue cq(impl);
+
+  auto fut = StartRetryAsyncUnaryRpc(
+      cq, __func__, RpcLimitedErrorCountRetryPolicy(2).clone(),
+      RpcExponentialBackoffPolicy(10_us, 40_us, 2.0).clone(),
+      /*is_idempotent=*/true,
+      [&mock](grpc::ClientContext* context,
+              btadmin::GetTableRequest const& request,
+              grpc::CompletionQueue* cq) {
+        return mock.AsyncGetTable(context, request, cq);
+      },
+      btadmin::GetTableRequest{});
+
+  EXPECT_EQ(1, impl->size());  // simulate the call completing
+  impl->SimulateCompletion(true);
+  EXPECT_EQ(1, impl->size());  // the backoff timer is pending
+  EXPECT_TRUE(fut.cancel());
+
+  // The mock completion queue does not create real alarms, so the timer still
+  // "expires", but the loop stops without making a second attempt.
+  impl->SimulateCompletion(true);
+  EXPECT_TRUE(impl->empty());
+
+  EXPECT_EQ(std::future_status::ready, fut.wait_for(0_us));
+  auto result = fut.get();
+  EXPECT_FALSE(result);
+  EXPECT_EQ(StatusCode::kCancelled, result.status().code());
+  EXPECT_THAT(result.status().message(), HasSubstr("retry loop cancelled"));
+}
+
 TEST(AsyncRetryUnaryRpcTest, TransientOnNonIdempotent) {
   using namespace google::cloud::testing_util::chrono_literals;
 
@@ -372,6 +479,548 @@ TEST(AsyncRetryUnaryRpcTest, TransientOnNonIdempotent) {
   EXPECT_THAT(result.status().message(), HasSubstr("maybe-try-again"));
 }
 
+TEST(AsyncRetryUnaryRpcTest, RetryBudgetExhausted) {
+  using namespace google::cloud::testing_util::chrono_literals;
+
+  MockStub mock;
+
+  using ReaderType = MockAsyncResponseReader<btadmin::Table>;
+  auto finish_failure = [](btadmin::Table*, grpc::Status* status, void*) {
+    *status = grpc::Status(grpc::StatusCode::UNAVAILABLE, "try-again");
+  };
+  auto r1 = google::cloud::internal::make_unique<ReaderType>();
+  EXPECT_CALL(*r1, Finish(_, _, _)).WillOnce(Invoke(finish_failure));
+  auto r2 = google::cloud::internal::make_unique<ReaderType>();
+  EXPECT_CALL(*r2, Finish(_, _, _)).WillOnce(Invoke(finish_failure));
+
+  EXPECT_CALL(mock, AsyncGetTable(_, _, _))
+      .WillOnce(Invoke([&r1](grpc::ClientContext*,
+                             btadmin::GetTableRequest const&,
+                             grpc::CompletionQueue*) {
+        return std::unique_ptr<
+            grpc::ClientAsyncResponseReaderInterface<btadmin::Table>>(r1.get());
+      }))
+      .WillOnce(Invoke([&r2](grpc::ClientContext*,
+                             btadmin::GetTableRequest const&,
+                             grpc::CompletionQueue*) {
+        return std::unique_ptr<
+            grpc::ClientAsyncResponseReaderInterface<btadmin::Table>>(r2.get());
+      }));
+
+  auto impl = std::make_shared<MockCompletionQueue>();
+  CompletionQueue cq(impl);
+
+  // The retry policy allows 5 failures, but the budget only has one retry.
+  auto budget = std::make_shared<RetryBudget>(1.0, 0.0);
+  auto fut = StartRetryAsyncUnaryRpc(
+      cq, __func__,
+      WithRetryBudget(RpcLimitedErrorCountRetryPolicy(5).clone(), budget),
+      RpcExponentialBackoffPolicy(10_us, 40_us, 2.0).clone(),
+      /*is_idempotent=*/true,
+      [&mock](grpc::ClientContext* context,
+              btadmin::GetTableRequest const& request,
+              grpc::CompletionQueue* cq) {
+        return mock.AsyncGetTable(context, request, cq);
+      },
+      btadmin::GetTableRequest{});
+
+  EXPECT_EQ(1, impl->size());  // simulate the call completing
+  impl->SimulateCompletion(true);
+  EXPECT_EQ(1, impl->size());  // simulate the timer completing
+  impl->SimulateCompletion(true);
+  EXPECT_EQ(1, impl->size());  // simulate the call completing
+  impl->SimulateCompletion(true);
+  EXPECT_TRUE(impl->empty());
+
+  EXPECT_EQ(std::future_status::ready, fut.wait_for(0_us));
+  auto result = fut.get();
+  EXPECT_EQ(StatusCode::kUnavailable, result.status().code());
+  EXPECT_THAT(result.status().message(), HasSubstr("retry policy exhausted"));
+  EXPECT_EQ(1, budget->counters().retries_allowed);
+  EXPECT_EQ(1, budget->counters().retries_denied);
+}
+
+class MockBackoffPolicy : public BackoffPolicy {
+ public:
+  MOCK_CONST_METHOD0(clone, std::unique_ptr<BackoffPolicy>());
+  MOCK_METHOD0(OnCompletion, std::chrono::microseconds());
+  MOCK_METHOD1(OnServerDelay,
+               std::chrono::microseconds(std::chrono::microseconds));
+  MOCK_CONST_METHOD0(maximum_delay, std::chrono::microseconds());
+};
+
+TEST(AsyncRetryUnaryRpcTest, UsesServerRetryDelay) {
+  using namespace google::cloud::testing_util::chrono_literals;
+
+  MockStub mock;
+
+  google::rpc::RetryInfo info;
+  info.mutable_retry_delay()->set_seconds(3);
+  google::rpc::Status details;
+  details.set_code(grpc::StatusCode::UNAVAILABLE);
+  details.set_message("try-again");
+  details.add_details()->PackFrom(info);
+
+  using ReaderType = MockAsyncResponseReader<btadmin::Table>;
+  auto r1 = google::cloud::internal::make_unique<ReaderType>();
+  EXPECT_CALL(*r1, Finish(_, _, _))
+      .WillOnce(Invoke([&details](btadmin::Table*, grpc::Status* status,
+                                  void*) {
+        *status = grpc::Status(grpc::StatusCode::UNAVAILABLE, "try-again",
+                               details.SerializeAsString());
+      }));
+  auto r2 = google::cloud::internal::make_unique<ReaderType>();
+  EXPECT_CALL(*r2, Finish(_, _, _))
+      .WillOnce(Invoke([](btadmin::Table* table, grpc::Status* status, void*) {
+        table->set_name("fake/table/name/response");
+        *status = grpc::Status::OK;
+      }));
+
+  EXPECT_CALL(mock, AsyncGetTable(_, _, _))
+      .WillOnce(Invoke([&r1](grpc::ClientContext*,
+                             btadmin::GetTableRequest const&,
+                             grpc::CompletionQueue*) {
+        return std::unique_ptr<
+            grpc::ClientAsyncResponseReaderInterface<btadmin::Table>>(r1.get());
+      }))
+      .WillOnce(Invoke([&r2](grpc::ClientContext*,
+                             btadmin::GetTableRequest const&,
+                             grpc::CompletionQueue*) {
+        return std::unique_ptr<
+            grpc::ClientAsyncResponseReaderInterface<btadmin::Table>>(r2.get());
+      }));
+
+  auto backoff = google::cloud::internal::make_unique<MockBackoffPolicy>();
+  EXPECT_CALL(*backoff, OnCompletion()).Times(0);
+  EXPECT_CALL(*backoff, OnServerDelay(std::chrono::microseconds(3_s)))
+      .WillOnce(Return(std::chrono::microseconds(10_us)));
+
+  auto impl = std::make_shared<MockCompletionQueue>();
+  CompletionQueue cq(impl);
+
+  auto fut = StartRetryAsyncUnaryRpc(
+      cq, __func__, RpcLimitedErrorCountRetryPolicy(3).clone(),
+      std::unique_ptr<RpcBackoffPolicy>(std::move(backoff)),
+      /*is_idempotent=*/true,
+      [&mock](grpc::ClientContext* context,
+              btadmin::GetTableRequest const& request,
+              grpc::CompletionQueue* cq) {
+        return mock.AsyncGetTable(context, request, cq);
+      },
+      btadmin::GetTableRequest{});
+
+  EXPECT_EQ(1, impl->size());  // simulate the call completing
+  impl->SimulateCompletion(true);
+  EXPECT_EQ(1, impl->size());  // simulate the timer completing
+  impl->SimulateCompletion(true);
+  EXPECT_EQ(1, impl->size());  // simulate the call completing
+  impl->SimulateCompletion(true);
+  EXPECT_TRUE(impl->empty());
+
+  EXPECT_EQ(std::future_status::ready, fut.wait_for(0_us));
+  auto result = fut.get();
+  ASSERT_STATUS_OK(result);
+  EXPECT_EQ("fake/table/name/response", result->name());
+}
+
+TEST(AsyncRetryUnaryRpcTest, AttemptDeadlineFromRetryPolicy) {
+  using namespace google::cloud::testing_util::chrono_literals;
+
+  MockStub mock;
+
+  using ReaderType = MockAsyncResponseReader<btadmin::Table>;
+  auto reader = google::cloud::internal::make_unique<ReaderType>();
+  EXPECT_CALL(*reader, Finish(_, _, _))
+      .WillOnce(Invoke([](btadmin::Table*, grpc::Status* status, void*) {
+        *status = grpc::Status::OK;
+      }));
+
+  auto const start = std::chrono::system_clock::now();
+  EXPECT_CALL(mock, AsyncGetTable(_, _, _))
+      .WillOnce(Invoke([&](grpc::ClientContext* context,
+                           btadmin::GetTableRequest const&,
+                           grpc::CompletionQueue*) {
+        // The remaining time in the retry loop is sent to the service.
+        EXPECT_LE(start + std::chrono::minutes(10), context->deadline());
+        EXPECT_GE(std::chrono::system_clock::now() + std::chrono::minutes(10),
+                  context->deadline());
+        return std::unique_ptr<
+            grpc::ClientAsyncResponseReaderInterface<btadmin::Table>>(
+            reader.get());
+      }));
+
+  auto impl = std::make_shared<MockCompletionQueue>();
+  CompletionQueue cq(impl);
+
+  auto fut = StartRetryAsyncUnaryRpc(
+      cq, __func__, RpcLimitedTimeRetryPolicy(std::chrono::minutes(10)).clone(),
+      RpcExponentialBackoffPolicy(10_us, 40_us, 2.0).clone(),
+      /*is_idempotent=*/true,
+      [&mock](grpc::ClientContext* context,
+              btadmin::GetTableRequest const& request,
+              grpc::CompletionQueue* cq) {
+        return mock.AsyncGetTable(context, request, cq);
+      },
+      btadmin::GetTableRequest{});
+
+  EXPECT_EQ(1, impl->size());
+  impl->SimulateCompletion(true);
+  EXPECT_TRUE(impl->empty());
+
+  EXPECT_EQ(std::future_status::ready, fut.wait_for(0_us));
+  ASSERT_STATUS_OK(fut.get());
+}
+
+TEST(AsyncRetryUnaryRpcTest, AttemptTimeoutIsRetried) {
+  using namespace google::cloud::testing_util::chrono_literals;
+
+  MockStub mock;
+
+  using ReaderType = MockAsyncResponseReader<btadmin::Table>;
+  auto r1 = google::cloud::internal::make_unique<ReaderType>();
+  EXPECT_CALL(*r1, Finish(_, _, _))
+      .WillOnce(Invoke([](btadmin::Table*, grpc::Status* status, void*) {
+        *status = grpc::Status(grpc::StatusCode::DEADLINE_EXCEEDED, "slow");
+      }));
+  auto r2 = google::cloud::internal::make_unique<ReaderType>();
+  EXPECT_CALL(*r2, Finish(_, _, _))
+      .WillOnce(Invoke([](btadmin::Table* table, grpc::Status* status, void*) {
+        table->set_name("fake/table/name/response");
+        *status = grpc::Status::OK;
+      }));
+
+  auto check_context = [](grpc::ClientContext* context) {
+    // The context factory is used for each attempt.
+    EXPECT_EQ(GRPC_COMPRESS_GZIP, context->compression_algorithm());
+    // The attempt timeout is shorter than the retry policy deadline.
+    auto const now = std::chrono::system_clock::now();
+    EXPECT_GE(now + std::chrono::seconds(1), context->deadline());
+  };
+  EXPECT_CALL(mock, AsyncGetTable(_, _, _))
+      .WillOnce(Invoke([&](grpc::ClientContext* context,
+                           btadmin::GetTableRequest const&,
+                           grpc::CompletionQueue*) {
+        check_context(context);
+        return std::unique_ptr<
+            grpc::ClientAsyncResponseReaderInterface<btadmin::Table>>(
+            r1.get());
+      }))
+      .WillOnce(Invoke([&](grpc::ClientContext* context,
+                           btadmin::GetTableRequest const&,
+                           grpc::CompletionQueue*) {
+        check_context(context);
+        return std::unique_ptr<
+            grpc::ClientAsyncResponseReaderInterface<btadmin::Table>>(
+            r2.get());
+      }));
+
+  auto impl = std::make_shared<MockCompletionQueue>();
+  CompletionQueue cq(impl);
+
+  int factory_calls = 0;
+  RpcAttemptOptions attempt_options;
+  attempt_options.set_attempt_timeout(std::chrono::milliseconds(1))
+      .set_context_factory([&factory_calls] {
+        ++factory_calls;
+        auto context = make_unique<grpc::ClientContext>();
+        context->set_compression_algorithm(GRPC_COMPRESS_GZIP);
+        return context;
+      });
+
+  auto fut = StartRetryAsyncUnaryRpc(
+      cq, __func__, RpcLimitedTimeRetryPolicy(std::chrono::minutes(10)).clone(),
+      RpcExponentialBackoffPolicy(10_us, 40_us, 2.0).clone(),
+      /*is_idempotent=*/true,
+      [&mock](grpc::ClientContext* context,
+              btadmin::GetTableRequest const& request,
+              grpc::CompletionQueue* cq) {
+        return mock.AsyncGetTable(context, request, cq);
+      },
+      btadmin::GetTableRequest{}, std::move(attempt_options));
+
+  // The error is rewritten only after the attempt deadline has passed.
+  std::this_thread::sleep_for(std::chrono::milliseconds(2));
+  EXPECT_EQ(1, impl->size());  // simulate the call completing
+  impl->SimulateCompletion(true);
+  EXPECT_EQ(1, impl->size());  // simulate the timer completing
+  impl->SimulateCompletion(true);
+  EXPECT_EQ(1, impl->size());  // simulate the call completing
+  impl->SimulateCompletion(true);
+  EXPECT_TRUE(impl->empty());
+  EXPECT_EQ(2, factory_calls);
+
+  EXPECT_EQ(std::future_status::ready, fut.wait_for(0_us));
+  auto result = fut.get();
+  ASSERT_STATUS_OK(result);
+  EXPECT_EQ("fake/table/name/response", result->name());
+}
+
+TEST(AsyncRetryUnaryRpcTest, DeadlineExceededWithoutAttemptTimeout) {
+  using namespace google::cloud::testing_util::chrono_literals;
+
+  MockStub mock;
+
+  using ReaderType = MockAsyncResponseReader<btadmin::Table>;
+  auto reader = google::cloud::internal::make_unique<ReaderType>();
+  EXPECT_CALL(*reader, Finish(_, _, _))
+      .WillOnce(Invoke([](btadmin::Table*, grpc::Status* status, void*) {
+        *status = grpc::Status(grpc::StatusCode::DEADLINE_EXCEEDED, "slow");
+      }));
+
+  EXPECT_CALL(mock, AsyncGetTable(_, _, _))
+      .WillOnce(Invoke([&reader](grpc::ClientContext* context,
+                                 btadmin::GetTableRequest const&,
+                                 grpc::CompletionQueue*) {
+        // Without a retry policy deadline or attempt timeout there is no
+        // deadline.
+        EXPECT_EQ(std::chrono::system_clock::time_point::max(),
+                  context->deadline());
+        return std::unique_ptr<
+            grpc::ClientAsyncResponseReaderInterface<btadmin::Table>>(
+            reader.get());
+      }));
+
+  auto impl = std::make_shared<MockCompletionQueue>();
+  CompletionQueue cq(impl);
+
+  auto fut = StartRetryAsyncUnaryRpc(
+      cq, __func__, RpcLimitedErrorCountRetryPolicy(3).clone(),
+      RpcExponentialBackoffPolicy(10_us, 40_us, 2.0).clone(),
+      /*is_idempotent=*/true,
+      [&mock](grpc::ClientContext* context,
+              btadmin::GetTableRequest const& request,
+              grpc::CompletionQueue* cq) {
+        return mock.AsyncGetTable(context, request, cq);
+      },
+      btadmin::GetTableRequest{});
+
+  EXPECT_EQ(1, impl->size());
+  impl->SimulateCompletion(true);
+  EXPECT_TRUE(impl->empty());
+
+  EXPECT_EQ(std::future_status::ready, fut.wait_for(0_us));
+  auto result = fut.get();
+  EXPECT_EQ(StatusCode::kDeadlineExceeded, result.status().code());
+  EXPECT_THAT(result.status().message(), HasSubstr("permanent failure"));
+}
+
+TEST(AsyncRetryUnaryRpcTest, DeadlineExceededBeforeAttemptTimeout) {
+  using namespace google::cloud::testing_util::chrono_literals;
+
+  MockStub mock;
+
+  using ReaderType = MockAsyncResponseReader<btadmin::Table>;
+  auto reader = google::cloud::internal::make_unique<ReaderType>();
+  EXPECT_CALL(*reader, Finish(_, _, _))
+      .WillOnce(Invoke([](btadmin::Table*, grpc::Status* status, void*) {
+        // The service reports an error before the attempt deadline, e.g.,
+        // from a deadline it propagated to another service.
+        *status = grpc::Status(grpc::StatusCode::DEADLINE_EXCEEDED, "slow");
+      }));
+
+  EXPECT_CALL(mock, AsyncGetTable(_, _, _))
+      .WillOnce(Invoke([&reader](grpc::ClientContext*,
+                                 btadmin::GetTableRequest const&,
+                                 grpc::CompletionQueue*) {
+        return std::unique_ptr<
+            grpc::ClientAsyncResponseReaderInterface<btadmin::Table>>(
+            reader.get());
+      }));
+
+  auto impl = std::make_shared<MockCompletionQueue>();
+  CompletionQueue cq(impl);
+
+  RpcAttemptOptions attempt_options;
+  attempt_options.set_attempt_timeout(std::chrono::minutes(5));
+
+  auto fut = StartRetryAsyncUnaryRpc(
+      cq, __func__, RpcLimitedTimeRetryPolicy(std::chrono::minutes(10)).clone(),
+      RpcExponentialBackoffPolicy(10_us, 40_us, 2.0).clone(),
+      /*is_idempotent=*/true,
+      [&mock](grpc::ClientContext* context,
+              btadmin::GetTableRequest const& request,
+              grpc::CompletionQueue* cq) {
+        return mock.AsyncGetTable(context, request, cq);
+      },
+      btadmin::GetTableRequest{}, std::move(attempt_options));
+
+  EXPECT_EQ(1, impl->size());
+  impl->SimulateCompletion(true);
+  EXPECT_TRUE(impl->empty());
+
+  EXPECT_EQ(std::future_status::ready, fut.wait_for(0_us));
+  auto result = fut.get();
+  EXPECT_EQ(StatusCode::kDeadlineExceeded, result.status().code());
+  EXPECT_THAT(result.status().message(), HasSubstr("permanent failure"));
+}
+
+TEST(AsyncRetryUnaryRpcTest, ThrottlerRecordsResponses) {
+  using namespace google::cloud::testing_util::chrono_literals;
+
+  MockStub mock;
+
+  using ReaderType = MockAsyncResponseReader<btadmin::Table>;
+  auto r1 = google::cloud::internal::make_unique<ReaderType>();
+  EXPECT_CALL(*r1, Finish(_, _, _))
+      .WillOnce(Invoke([](btadmin::Table*, grpc::Status* status, void*) {
+        *status = grpc::Status(grpc::StatusCode::UNAVAILABLE, "try-again");
+      }));
+  auto r2 = google::cloud::internal::make_unique<ReaderType>();
+  EXPECT_CALL(*r2, Finish(_, _, _))
+      .WillOnce(Invoke([](btadmin::Table*, grpc::Status* status, void*) {
+        *status = grpc::Status::OK;
+      }));
+
+  EXPECT_CALL(mock, AsyncGetTable(_, _, _))
+      .WillOnce(Invoke([&r1](grpc::ClientContext*,
+                             btadmin::GetTableRequest const&,
+                             grpc::CompletionQueue*) {
+        return std::unique_ptr<
+            grpc::ClientAsyncResponseReaderInterface<btadmin::Table>>(r1.get());
+      }))
+      .WillOnce(Invoke([&r2](grpc::ClientContext*,
+                             btadmin::GetTableRequest const&,
+                             grpc::CompletionQueue*) {
+        return std::unique_ptr<
+            grpc::ClientAsyncResponseReaderInterface<btadmin::Table>>(r2.get());
+      }));
+
+  auto impl = std::make_shared<MockCompletionQueue>();
+  CompletionQueue cq(impl);
+
+  // Prime the throttler so it does not reject any of the attempts.
+  auto throttler = std::make_shared<AdaptiveThrottler>();
+  for (int i = 0; i != 10; ++i) {
+    ASSERT_TRUE(throttler->Admit());
+    throttler->OnResponse(Status());
+  }
+  auto fut = StartRetryAsyncUnaryRpc(
+      cq, __func__, RpcLimitedErrorCountRetryPolicy(3).clone(),
+      RpcExponentialBackoffPolicy(10_us, 40_us, 2.0).clone(),
+      /*is_idempotent=*/true,
+      [&mock](grpc::ClientContext* context,
+              btadmin::GetTableRequest const& request,
+              grpc::CompletionQueue* cq) {
+        return mock.AsyncGetTable(context, request, cq);
+      },
+      btadmin::GetTableRequest{}, RpcAttemptOptions{}.set_throttler(throttler));
+
+  EXPECT_EQ(1, impl->size());  // simulate the call completing
+  impl->SimulateCompletion(true);
+  EXPECT_EQ(1, impl->size());  // simulate the timer completing
+  impl->SimulateCompletion(true);
+  EXPECT_EQ(1, impl->size());  // simulate the call completing
+  impl->SimulateCompletion(true);
+  EXPECT_TRUE(impl->empty());
+
+  EXPECT_EQ(std::future_status::ready, fut.wait_for(0_us));
+  ASSERT_STATUS_OK(fut.get());
+
+  // Only the successful attempt is an accept.
+  auto const counters = throttler->counters();
+  EXPECT_EQ(12, counters.requests);
+  EXPECT_EQ(11, counters.accepts);
+  EXPECT_EQ(0, counters.throttled);
+}
+
+TEST(AsyncRetryUnaryRpcTest, ThrottledLocally) {
+  using namespace google::cloud::testing_util::chrono_literals;
+
+  MockStub mock;
+  EXPECT_CALL(mock, AsyncGetTable(_, _, _)).Times(0);
+
+  // Simulate a long overload, the reject probability is 1 - 1e-6, so this is
+  // (almost) guaranteed to reject the next request.
+  auto throttler = std::make_shared<AdaptiveThrottler>(1.0);
+  for (int i = 0; i != 1000 * 1000 - 1; ++i) throttler->Admit();
+  ASSERT_LT(0.99, throttler->RejectProbability());
+
+  auto impl = std::make_shared<MockCompletionQueue>();
+  CompletionQueue cq(impl);
+
+  auto fut = StartRetryAsyncUnaryRpc(
+      cq, __func__, RpcLimitedErrorCountRetryPolicy(3).clone(),
+      RpcExponentialBackoffPolicy(10_us, 40_us, 2.0).clone(),
+      /*is_idempotent=*/false,
+      [&mock](grpc::ClientContext* context,
+              btadmin::GetTableRequest const& request,
+              grpc::CompletionQueue* cq) {
+        return mock.AsyncGetTable(context, request, cq);
+      },
+      btadmin::GetTableRequest{}, RpcAttemptOptions{}.set_throttler(throttler));
+
+  // The request fails without using the network.
+  EXPECT_TRUE(impl->empty());
+  EXPECT_EQ(std::future_status::ready, fut.wait_for(0_us));
+  auto result = fut.get();
+  EXPECT_EQ(StatusCode::kUnavailable, result.status().code());
+  EXPECT_THAT(result.status().message(), HasSubstr("throttled"));
+}
+
+TEST(AsyncRetryUnaryRpcTest, PoliciesByValue) {
+  using namespace google::cloud::testing_util::chrono_literals;
+
+  MockStub mock;
+
+  using ReaderType = MockAsyncResponseReader<btadmin::Table>;
+  auto r1 = google::cloud::internal::make_unique<ReaderType>();
+  EXPECT_CALL(*r1, Finish(_, _, _))
+      .WillOnce(Invoke([](btadmin::Table*, grpc::Status* status, void*) {
+        *status = grpc::Status(grpc::StatusCode::UNAVAILABLE, "try-again");
+      }));
+  auto r2 = google::cloud::internal::make_unique<ReaderType>();
+  EXPECT_CALL(*r2, Finish(_, _, _))
+      .WillOnce(Invoke([](btadmin::Table*, grpc::Status* status, void*) {
+        *status = grpc::Status(grpc::StatusCode::UNAVAILABLE, "try-again");
+      }));
+
+  EXPECT_CALL(mock, AsyncGetTable(_, _, _))
+      .WillOnce(Invoke([&r1](grpc::ClientContext*,
+                             btadmin::GetTableRequest const&,
+                             grpc::CompletionQueue*) {
+        return std::unique_ptr<
+            grpc::ClientAsyncResponseReaderInterface<btadmin::Table>>(r1.get());
+      }))
+      .WillOnce(Invoke([&r2](grpc::ClientContext*,
+                             btadmin::GetTableRequest const&,
+                             grpc::CompletionQueue*) {
+        return std::unique_ptr<
+            grpc::ClientAsyncResponseReaderInterface<btadmin::Table>>(r2.get());
+      }));
+
+  auto impl = std::make_shared<MockCompletionQueue>();
+  CompletionQueue cq(impl);
+
+  // The policies are copied from these prototypes, without calling clone().
+  RpcLimitedErrorCountRetryPolicy const retry_prototype(1);
+  RpcExponentialBackoffPolicy const backoff_prototype(10_us, 40_us, 2.0);
+  auto fut = StartRetryAsyncUnaryRpc(
+      cq, __func__, retry_prototype, backoff_prototype,
+      /*is_idempotent=*/true,
+      [&mock](grpc::ClientContext* context,
+              btadmin::GetTableRequest const& request,
+              grpc::CompletionQueue* cq) {
+        return mock.AsyncGetTable(context, request, cq);
+      },
+      btadmin::GetTableRequest{});
+
+  EXPECT_EQ(1, impl->size());  // simulate the call completing
+  impl->SimulateCompletion(true);
+  EXPECT_EQ(1, impl->size());  // simulate the timer completing
+  impl->SimulateCompletion(true);
+  EXPECT_EQ(1, impl->size());  // simulate the call completing
+  impl->SimulateCompletion(true);
+  EXPECT_TRUE(impl->empty());
+
+  EXPECT_EQ(std::future_status::ready, fut.wait_for(0_us));
+  auto result = fut.get();
+  EXPECT_EQ(StatusCode::kUnavailable, result.status().code());
+  EXPECT_THAT(result.status().message(), HasSubstr("retry policy exhausted"));
+
+  // The prototypes are unchanged.
+  EXPECT_FALSE(retry_prototype.IsExhausted());
+}
+
 }  // namespace
 }  // namespace internal
 }  // namespace GOOGLE_CLOUD_CPP_NS
@@ -14,48 +14,115 @@
 
 #include "google/cloud/internal/backoff_policy.h"
 #include "google/cloud/internal/make_unique.h"
+#include <algorithm>
 
 namespace google {
 namespace cloud {
 inline namespace GOOGLE_CLOUD_CPP_NS {
 namespace internal {
 
+std::chrono::microseconds BackoffPolicy::OnServerDelay(
+    std::chrono::microseconds server_delay) {
+  // Keep the policy state consistent, as if the policy had been used.
+  OnCompletion();
+  // Clamp to [minimum_delay(), maximum_delay()], the maximum wins if the
+  // limits are inconsistent. A delay shorter than the minimum would retry
+  // sooner than the policy allows.
+  auto const delay =
+      std::min(std::max(server_delay, minimum_delay()), maximum_delay());
+  return std::max(std::chrono::microseconds(0), delay);
+}
+
 std::unique_ptr<BackoffPolicy> ExponentialBackoffPolicy::clone() const {
-  auto tmp =
-      google::cloud::internal::make_unique<ExponentialBackoffPolicy>(*this);
-  // Force OnCompletion() to reseed the generator.
-  tmp->generator_.reset();
-  return std::unique_ptr<BackoffPolicy>(std::move(tmp));
+  return google::cloud::internal::make_unique<ExponentialBackoffPolicy>(*this);
 }
 
-std::chrono::milliseconds ExponentialBackoffPolicy::OnCompletion() {
-  using std::chrono::duration_cast;
+std::chrono::microseconds ExponentialBackoffPolicy::OnCompletion() {
   using std::chrono::microseconds;
-  using std::chrono::milliseconds;
-  // We do not want to copy the seed in `clone()` because then all operations
-  // will have the same sequence of backoffs. Nor do we want to use a shared
-  // PRNG because that would require locking and some more complicated lifecycle
-  // management of the shared PRNG.
-  //
-  // Instead we exploit the following observation: most requests never need to
-  // backoff, they succeed on the first call.
-  //
-  // So we delay the initialization of the PRNG until the first call that needs
-  // to, that is here:
-  if (!generator_) {
-    generator_ = google::cloud::internal::MakeDefaultPRNG();
-  }
   std::uniform_int_distribution<microseconds::rep> rng_distribution(
       current_delay_range_.count() / 2, current_delay_range_.count());
   // Randomized sleep period because it is possible that after some time all
   // client have same sleep period if we use only exponential backoff policy.
-  auto delay = microseconds(rng_distribution(*generator_));
+  // Clones do not copy a generator, so they do not repeat the same sequence of
+  // delays. The per-thread generator is small, seeded once, and needs no
+  // locking.
+  auto delay = microseconds(rng_distribution(ThreadLocalFastPRNG()));
   current_delay_range_ = microseconds(
       static_cast<microseconds::rep>(current_delay_range_.count() * scaling_));
   if (current_delay_range_ >= maximum_delay_) {
     current_delay_range_ = maximum_delay_;
   }
-  return duration_cast<milliseconds>(delay);
+  return delay;
+}
+
+std::unique_ptr<BackoffPolicy> FullJitterBackoffPolicy::clone() const {
+  return google::cloud::internal::make_unique<FullJitterBackoffPolicy>(*this);
+}
+
+std::chrono::microseconds FullJitterBackoffPolicy::OnCompletion() {
+  using std::chrono::microseconds;
+  std::uniform_int_distribution<microseconds::rep> rng_distribution(
+      0, current_delay_range_.count());
+  auto delay = microseconds(rng_distribution(ThreadLocalFastPRNG()));
+  current_delay_range_ = microseconds(
+      static_cast<microseconds::rep>(current_delay_range_.count() * scaling_));
+  if (current_delay_range_ >= maximum_delay_) {
+    current_delay_range_ = maximum_delay_;
+  }
+  return delay;
+}
+
+std::unique_ptr<BackoffPolicy> DecorrelatedJitterBackoffPolicy::clone() const {
+  return google::cloud::internal::make_unique<DecorrelatedJitterBackoffPolicy>(
+      *this);
+}
+
+std::chrono::microseconds DecorrelatedJitterBackoffPolicy::OnCompletion() {
+  using std::chrono::microseconds;
+  // Compute min(maximum_delay_, 3 * previous_delay_) without overflowing.
+  auto upper = previous_delay_ > maximum_delay_ / 3 ? maximum_delay_
+                                                    : 3 * previous_delay_;
+  upper = std::max(upper, initial_delay_);
+  std::uniform_int_distribution<microseconds::rep> rng_distribution(
+      initial_delay_.count(), upper.count());
+  previous_delay_ = microseconds(rng_distribution(ThreadLocalFastPRNG()));
+  return previous_delay_;
+}
+
+std::unique_ptr<BackoffPolicy> CappedTotalBackoffPolicy::clone() const {
+  return std::unique_ptr<BackoffPolicy>(
+      new CappedTotalBackoffPolicy(policy_->clone(), remaining_));
+}
+
+std::chrono::microseconds CappedTotalBackoffPolicy::OnCompletion() {
+  return Consume(policy_->OnCompletion());
+}
+
+std::chrono::microseconds CappedTotalBackoffPolicy::OnServerDelay(
+    std::chrono::microseconds server_delay) {
+  return Consume(policy_->OnServerDelay(server_delay));
+}
+
+std::chrono::microseconds CappedTotalBackoffPolicy::minimum_delay() const {
+  return policy_->minimum_delay();
+}
+
+std::chrono::microseconds CappedTotalBackoffPolicy::maximum_delay() const {
+  if (remaining_ == std::chrono::microseconds(0)) {
+    return policy_->minimum_delay();
+  }
+  return std::min(policy_->maximum_delay(), remaining_);
+}
+
+std::chrono::microseconds CappedTotalBackoffPolicy::Consume(
+    std::chrono::microseconds delay) {
+  // Once the budget is exhausted only the wrapped policy's minimum remains.
+  if (remaining_ == std::chrono::microseconds(0)) {
+    return policy_->minimum_delay();
+  }
+  delay = std::min(delay, remaining_);
+  remaining_ -= delay;
+  return delay;
 }
 
 }  // namespace internal
@@ -17,7 +17,7 @@
 
 #include "google/cloud/internal/random.h"
 #include "google/cloud/internal/throw_delegate.h"
-#include "google/cloud/optional.h"
+#include <algorithm>
 #include <chrono>
 #include <memory>
 
@@ -66,9 +66,43 @@ class BackoffPolicy {
    * the operation is handled by other policies. This separates the concerns
    * of how much to retry vs. how much delay to put between retries.
    *
-   * @return the delay to wait before the next retry attempt.
+   * @return the delay to wait before the next retry attempt. Policies may use
+   *     sub-millisecond delays, for services where retrying quickly is
+   *     appropriate.
    */
-  virtual std::chrono::milliseconds OnCompletion() = 0;
+  virtual std::chrono::microseconds OnCompletion() = 0;
+
+  /**
+   * Handle an operation completion where the service requested a delay.
+   *
+   * Services may ask the client to wait before retrying a request, typically
+   * when they are overloaded. This function updates the policy state as
+   * `OnCompletion()` does, but returns the delay requested by the service,
+   * bounded by `minimum_delay()` and `maximum_delay()`, instead of the
+   * policy's own delay.
+   *
+   * @param server_delay the delay requested by the service.
+   */
+  virtual std::chrono::microseconds OnServerDelay(
+      std::chrono::microseconds server_delay);
+
+  /**
+   * The minimum delay returned by this policy.
+   *
+   * A service cannot request a shorter delay, the default is zero.
+   */
+  virtual std::chrono::microseconds minimum_delay() const {
+    return std::chrono::microseconds(0);
+  }
+
+  /**
+   * The maximum delay returned by this policy.
+   *
+   * A service cannot request a longer delay, the default is unbounded.
+   */
+  virtual std::chrono::microseconds maximum_delay() const {
+    return std::chrono::microseconds::max();
+  }
 };
 
 /**
@@ -83,7 +117,7 @@ class BackoffPolicy {
  * [thundering herd
  * problem](https://en.wikipedia.org/wiki/Thundering_herd_problem).
  */
-class ExponentialBackoffPolicy : public BackoffPolicy {
+class ExponentialBackoffPolicy final : public BackoffPolicy {
  public:
   /**
    * Constructor for an exponential backoff policy.
@@ -125,9 +159,63 @@ class ExponentialBackoffPolicy : public BackoffPolicy {
   ExponentialBackoffPolicy(std::chrono::duration<Rep1, Period1> initial_delay,
                            std::chrono::duration<Rep2, Period2> maximum_delay,
                            double scaling)
+      : initial_delay_(std::chrono::duration_cast<std::chrono::microseconds>(
+            initial_delay)),
+        current_delay_range_(2 * initial_delay_),
+        maximum_delay_(std::chrono::duration_cast<std::chrono::microseconds>(
+            maximum_delay)),
+        scaling_(scaling) {
+    if (scaling_ <= 1.0) {
+      google::cloud::internal::ThrowInvalidArgument(
+          "scaling factor must be > 1.0");
+    }
+  }
+
+  std::unique_ptr<BackoffPolicy> clone() const override;
+  std::chrono::microseconds OnCompletion() override;
+  std::chrono::microseconds minimum_delay() const override {
+    return std::min(initial_delay_, maximum_delay_);
+  }
+  std::chrono::microseconds maximum_delay() const override {
+    return maximum_delay_;
+  }
+
+ private:
+  std::chrono::microseconds initial_delay_;
+  std::chrono::microseconds current_delay_range_;
+  std::chrono::microseconds maximum_delay_;
+  double scaling_;
+};
+
+/**
+ * Implements a truncated exponential backoff with "full jitter".
+ *
+ * Each delay is chosen uniformly at random between zero and the current delay
+ * range. The range starts at the initial delay, and grows by the scaling
+ * factor after each call, up to the maximum delay. Compared to
+ * `ExponentialBackoffPolicy`, the delays are spread over a wider interval,
+ * which better avoids synchronized retries from many clients, at the cost of
+ * some retries happening sooner.
+ *
+ * @see https://aws.amazon.com/blogs/architecture/exponential-backoff-and-jitter/
+ */
+class FullJitterBackoffPolicy final : public BackoffPolicy {
+ public:
+  /**
+   * Constructor for a full jitter backoff policy.
+   *
+   * @param initial_delay the range for the first delay.
+   * @param maximum_delay the maximum value for the delay between operations.
+   * @param scaling how fast does the delay range increase between iterations,
+   *     it must be greater than 1.0.
+   */
+  template <typename Rep1, typename Period1, typename Rep2, typename Period2>
+  FullJitterBackoffPolicy(std::chrono::duration<Rep1, Period1> initial_delay,
+                          std::chrono::duration<Rep2, Period2> maximum_delay,
+                          double scaling)
       : current_delay_range_(
             std::chrono::duration_cast<std::chrono::microseconds>(
-                2 * initial_delay)),
+                initial_delay)),
         maximum_delay_(std::chrono::duration_cast<std::chrono::microseconds>(
             maximum_delay)),
         scaling_(scaling) {
@@ -138,13 +226,108 @@ class ExponentialBackoffPolicy : public BackoffPolicy {
   }
 
   std::unique_ptr<BackoffPolicy> clone() const override;
-  std::chrono::milliseconds OnCompletion() override;
+  std::chrono::microseconds OnCompletion() override;
+  std::chrono::microseconds maximum_delay() const override {
+    return maximum_delay_;
+  }
 
  private:
   std::chrono::microseconds current_delay_range_;
   std::chrono::microseconds maximum_delay_;
   double scaling_;
-  optional<DefaultPRNG> generator_;
+};
+
+/**
+ * Implements a backoff policy with "decorrelated jitter".
+ *
+ * Each delay is chosen uniformly at random between the initial delay and three
+ * times the previous delay, and then truncated to the maximum delay. The
+ * delays grow on average, but each delay depends on the previous (random)
+ * delay, rather than on the number of attempts. This keeps clients that
+ * started retrying at the same time from staying synchronized.
+ *
+ * @see https://aws.amazon.com/blogs/architecture/exponential-backoff-and-jitter/
+ */
+class DecorrelatedJitterBackoffPolicy final : public BackoffPolicy {
+ public:
+  /**
+   * Constructor for a decorrelated jitter backoff policy.
+   *
+   * @param initial_delay the minimum delay, also used as the first "previous"
+   *     delay.
+   * @param maximum_delay the maximum value for the delay between operations.
+   */
+  template <typename Rep1, typename Period1, typename Rep2, typename Period2>
+  DecorrelatedJitterBackoffPolicy(
+      std::chrono::duration<Rep1, Period1> initial_delay,
+      std::chrono::duration<Rep2, Period2> maximum_delay)
+      : initial_delay_(std::chrono::duration_cast<std::chrono::microseconds>(
+            initial_delay)),
+        maximum_delay_(std::chrono::duration_cast<std::chrono::microseconds>(
+            maximum_delay)),
+        previous_delay_(initial_delay_) {
+    if (initial_delay_ > maximum_delay_) {
+      google::cloud::internal::ThrowInvalidArgument(
+          "initial delay must be <= maximum delay");
+    }
+  }
+
+  std::unique_ptr<BackoffPolicy> clone() const override;
+  std::chrono::microseconds OnCompletion() override;
+  std::chrono::microseconds minimum_delay() const override {
+    return initial_delay_;
+  }
+  std::chrono::microseconds maximum_delay() const override {
+    return maximum_delay_;
+  }
+
+ private:
+  std::chrono::microseconds initial_delay_;
+  std::chrono::microseconds maximum_delay_;
+  std::chrono::microseconds previous_delay_;
+};
+
+/**
+ * Limit the total delay of another backoff policy.
+ *
+ * This policy returns the delays computed by a wrapped policy, but the sum of
+ * the delays does not exceed `maximum_total_delay`. The last delay within the
+ * budget is truncated to the remaining budget.
+ *
+ * Once the budget is exhausted the policy returns the wrapped policy's
+ * `minimum_delay()`, so the remaining retries do not turn into a retry storm
+ * as long as that minimum is not zero. Each retry after that adds at most the
+ * minimum delay to the total.
+ */
+class CappedTotalBackoffPolicy : public BackoffPolicy {
+ public:
+  /**
+   * Constructor for a capped total delay policy.
+   *
+   * @param policy the wrapped policy, it computes the delays before capping.
+   * @param maximum_total_delay the maximum value for the sum of all delays.
+   */
+  template <typename Rep, typename Period>
+  CappedTotalBackoffPolicy(
+      std::unique_ptr<BackoffPolicy> policy,
+      std::chrono::duration<Rep, Period> maximum_total_delay)
+      : policy_(std::move(policy)),
+        remaining_(std::chrono::duration_cast<std::chrono::microseconds>(
+            maximum_total_delay)) {}
+
+  std::unique_ptr<BackoffPolicy> clone() const override;
+  std::chrono::microseconds OnCompletion() override;
+  std::chrono::microseconds OnServerDelay(
+      std::chrono::microseconds server_delay) override;
+  std::chrono::microseconds minimum_delay() const override;
+  std::chrono::microseconds maximum_delay() const override;
+
+ private:
+  /// Charge @p delay against the budget, return the (possibly capped) delay.
+  std::chrono::microseconds Consume(std::chrono::microseconds delay);
+
+  std::unique_ptr<BackoffPolicy> policy_;
+  std::chrono::microseconds remaining_;
 };
 
 }  // namespace internal
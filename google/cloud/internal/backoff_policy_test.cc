@@ -14,11 +14,16 @@
 
 #include "google/cloud/internal/backoff_policy.h"
 #include <gmock/gmock.h>
+#include <algorithm>
 #include <chrono>
 #include <vector>
 
+using google::cloud::internal::CappedTotalBackoffPolicy;
+using google::cloud::internal::DecorrelatedJitterBackoffPolicy;
 using google::cloud::internal::ExponentialBackoffPolicy;
+using google::cloud::internal::FullJitterBackoffPolicy;
 using ms = std::chrono::milliseconds;
+using us = std::chrono::microseconds;
 
 using ::testing::ElementsAreArray;
 using ::testing::Not;
@@ -61,14 +66,14 @@ TEST(ExponentialBackoffPolicy, DifferentParameters) {
   ExponentialBackoffPolicy tested(ms(100), std::chrono::seconds(10), 1.5);
 
   auto delay = tested.OnCompletion();
-  EXPECT_LE(ms(100), delay) << "delay=" << delay.count() << "ms";
-  EXPECT_GE(ms(200), delay) << "delay=" << delay.count() << "ms";
+  EXPECT_LE(ms(100), delay) << "delay=" << delay.count() << "us";
+  EXPECT_GE(ms(200), delay) << "delay=" << delay.count() << "us";
   delay = tested.OnCompletion();
-  EXPECT_LE(ms(150), delay) << "delay=" << delay.count() << "ms";
-  EXPECT_GE(ms(300), delay) << "delay=" << delay.count() << "ms";
+  EXPECT_LE(ms(150), delay) << "delay=" << delay.count() << "us";
+  EXPECT_GE(ms(300), delay) << "delay=" << delay.count() << "us";
   delay = tested.OnCompletion();
-  EXPECT_LE(ms(225), delay) << "delay=" << delay.count() << "ms";
-  EXPECT_GE(ms(450), delay) << "delay=" << delay.count() << "ms";
+  EXPECT_LE(ms(225), delay) << "delay=" << delay.count() << "us";
+  EXPECT_GE(ms(450), delay) << "delay=" << delay.count() << "us";
 }
 
 /// @test Test cloning for ExponentialBackoffPolicy.
@@ -136,3 +141,160 @@ TEST(ExponentialBackoffPolicy, ClonesHaveDifferentSequences) {
 
   EXPECT_THAT(sequence_1, Not(ElementsAreArray(sequence_2)));
 }
+
+/// @test Verify that delays below one millisecond are not truncated.
+TEST(ExponentialBackoffPolicy, SubMillisecondDelays) {
+  ExponentialBackoffPolicy tested(us(100), us(800), 2.0);
+
+  auto delay = tested.OnCompletion();
+  EXPECT_LE(us(100), delay);
+  EXPECT_GE(us(200), delay);
+  delay = tested.OnCompletion();
+  EXPECT_LE(us(200), delay);
+  EXPECT_GE(us(400), delay);
+}
+
+/// @test A simple test for the FullJitterBackoffPolicy.
+TEST(FullJitterBackoffPolicy, Simple) {
+  FullJitterBackoffPolicy tested(us(100), us(1000), 2.0);
+
+  for (auto range : {us(100), us(200), us(400), us(800), us(1000), us(1000)}) {
+    auto const delay = tested.OnCompletion();
+    EXPECT_LE(us(0), delay);
+    EXPECT_GE(range, delay);
+  }
+}
+
+/// @test Verify that the FullJitterBackoffPolicy scaling factor is validated.
+TEST(FullJitterBackoffPolicy, ValidateScaling) {
+#if GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+  EXPECT_THROW(FullJitterBackoffPolicy(ms(10), ms(50), 1.0),
+               std::invalid_argument);
+#else
+  EXPECT_DEATH_IF_SUPPORTED(FullJitterBackoffPolicy(ms(10), ms(50), 1.0),
+                            "exceptions are disabled");
+#endif  // GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+}
+
+/// @test A simple test for the DecorrelatedJitterBackoffPolicy.
+TEST(DecorrelatedJitterBackoffPolicy, Simple) {
+  DecorrelatedJitterBackoffPolicy tested(us(100), us(5000));
+
+  auto previous = us(100);
+  for (int i = 0; i != 100; ++i) {
+    auto const delay = tested.OnCompletion();
+    EXPECT_LE(us(100), delay);
+    EXPECT_GE(std::min(us(5000), 3 * previous), delay);
+    previous = delay;
+  }
+}
+
+/// @test Verify that the DecorrelatedJitterBackoffPolicy clones differ.
+TEST(DecorrelatedJitterBackoffPolicy, ClonesHaveDifferentSequences) {
+  DecorrelatedJitterBackoffPolicy original(us(100), ms(1000));
+  auto c1 = original.clone();
+  auto c2 = original.clone();
+  std::vector<us::rep> sequence_1(20);
+  std::generate(sequence_1.begin(), sequence_1.end(),
+                [&] { return c1->OnCompletion().count(); });
+  std::vector<us::rep> sequence_2(20);
+  std::generate(sequence_2.begin(), sequence_2.end(),
+                [&] { return c2->OnCompletion().count(); });
+  EXPECT_THAT(sequence_1, Not(ElementsAreArray(sequence_2)));
+}
+
+/// @test Verify that CappedTotalBackoffPolicy limits the sum of the delays.
+TEST(CappedTotalBackoffPolicy, Simple) {
+  CappedTotalBackoffPolicy tested(
+      ExponentialBackoffPolicy(ms(10), ms(10), 2.0).clone(), ms(25));
+
+  auto delay = tested.OnCompletion();
+  EXPECT_LE(ms(10), delay);
+  EXPECT_GE(ms(20), delay);
+  auto total = delay;
+  // The delays are at least 5ms, so this loop runs at most 3 times. The last
+  // delay is truncated, the total never overshoots the budget.
+  while (total < ms(25)) total += tested.OnCompletion();
+  EXPECT_EQ(ms(25), total);
+}
+
+/// @test Verify that CappedTotalBackoffPolicy returns the minimum delay of the
+/// wrapped policy once the budget is exhausted.
+TEST(CappedTotalBackoffPolicy, Exhausted) {
+  CappedTotalBackoffPolicy tested(
+      ExponentialBackoffPolicy(ms(5), ms(40), 2.0).clone(), ms(10));
+
+  // The delays are at least 5ms, at most two exhaust the budget.
+  auto total = tested.OnCompletion();
+  if (total < ms(10)) total += tested.OnCompletion();
+  EXPECT_EQ(ms(10), total);
+
+  // After that the delays are the wrapped policy's minimum delay, even as its
+  // own delays keep growing.
+  EXPECT_EQ(ms(5), tested.maximum_delay());
+  for (int i = 0; i != 5; ++i) EXPECT_EQ(ms(5), tested.OnCompletion());
+  EXPECT_EQ(ms(5), tested.OnServerDelay(std::chrono::seconds(1)));
+}
+
+/// @test Verify that the server delay is used, bounded by the policy.
+TEST(ExponentialBackoffPolicy, OnServerDelay) {
+  ExponentialBackoffPolicy tested(ms(10), ms(100), 2.0);
+
+  EXPECT_EQ(ms(75), tested.OnServerDelay(ms(75)));
+  EXPECT_EQ(ms(100), tested.OnServerDelay(std::chrono::seconds(30)));
+  // The service cannot request a delay shorter than the initial delay.
+  EXPECT_EQ(ms(10), tested.OnServerDelay(ms(2)));
+  EXPECT_EQ(ms(10), tested.OnServerDelay(ms(-5)));
+  EXPECT_EQ(ms(10), tested.minimum_delay());
+  EXPECT_EQ(ms(100), tested.maximum_delay());
+
+  // The server delays advance the policy state.
+  auto delay = tested.OnCompletion();
+  EXPECT_LE(ms(50), delay);
+  EXPECT_GE(ms(100), delay);
+}
+
+/// @test Verify that the server delay is bounded by the jitter policies.
+TEST(JitterBackoffPolicies, OnServerDelay) {
+  FullJitterBackoffPolicy full(ms(10), ms(100), 2.0);
+  EXPECT_EQ(us(0), full.minimum_delay());
+  EXPECT_EQ(ms(2), full.OnServerDelay(ms(2)));
+  EXPECT_EQ(us(0), full.OnServerDelay(ms(-5)));
+
+  DecorrelatedJitterBackoffPolicy decorrelated(ms(10), ms(100));
+  EXPECT_EQ(ms(10), decorrelated.minimum_delay());
+  EXPECT_EQ(ms(10), decorrelated.OnServerDelay(ms(2)));
+  EXPECT_EQ(ms(100), decorrelated.OnServerDelay(std::chrono::seconds(30)));
+}
+
+/// @test Verify the default limits for policies that do not override them.
+TEST(BackoffPolicy, DefaultLimits) {
+  class FixedBackoffPolicy : public google::cloud::internal::BackoffPolicy {
+   public:
+    std::unique_ptr<BackoffPolicy> clone() const override {
+      return std::unique_ptr<BackoffPolicy>(new FixedBackoffPolicy(*this));
+    }
+    std::chrono::microseconds OnCompletion() override { return ms(10); }
+  };
+
+  FixedBackoffPolicy tested;
+  EXPECT_EQ(us(0), tested.minimum_delay());
+  EXPECT_EQ(us::max(), tested.maximum_delay());
+  EXPECT_EQ(std::chrono::seconds(30),
+            tested.OnServerDelay(std::chrono::seconds(30)));
+  EXPECT_EQ(us(0), tested.OnServerDelay(ms(-5)));
+}
+
+/// @test Verify that server delays count towards the total delay.
+TEST(CappedTotalBackoffPolicy, OnServerDelay) {
+  CappedTotalBackoffPolicy tested(
+      ExponentialBackoffPolicy(ms(10), ms(100), 2.0).clone(), ms(150));
+
+  EXPECT_EQ(ms(100), tested.maximum_delay());
+  EXPECT_EQ(ms(100), tested.OnServerDelay(std::chrono::seconds(1)));
+  EXPECT_EQ(ms(50), tested.maximum_delay());
+  EXPECT_EQ(ms(50), tested.OnServerDelay(ms(80)));
+  // The budget is exhausted, only the minimum delay remains.
+  EXPECT_EQ(ms(10), tested.OnServerDelay(ms(80)));
+  EXPECT_EQ(ms(10), tested.minimum_delay());
+}
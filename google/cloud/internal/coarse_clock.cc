@@ -0,0 +1,73 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/internal/coarse_clock.h"
+#include <atomic>
+
+namespace google {
+namespace cloud {
+inline namespace GOOGLE_CLOUD_CPP_NS {
+namespace internal {
+namespace {
+std::atomic<CoarseSteadyClock::rep> cached_time{0};
+std::atomic<int> refreshers{0};
+
+/// Each thread checks the age of the cached value once every this many calls.
+auto constexpr kStalenessCheckPeriod = 32;
+
+void Update(CoarseSteadyClock::rep now) {
+  // Several threads may refresh the value, never move it backwards.
+  auto current = cached_time.load(std::memory_order_relaxed);
+  while (current < now && !cached_time.compare_exchange_weak(
+                              current, now, std::memory_order_relaxed)) {
+  }
+}
+}  // namespace
+
+constexpr bool CoarseSteadyClock::is_steady;
+
+CoarseSteadyClock::time_point CoarseSteadyClock::now() noexcept {
+  if (refreshers.load(std::memory_order_acquire) == 0) {
+    return std::chrono::steady_clock::now();
+  }
+  auto const cached =
+      time_point(duration(cached_time.load(std::memory_order_relaxed)));
+  static thread_local int calls = 0;
+  if (++calls < kStalenessCheckPeriod) return cached;
+  calls = 0;
+  auto const actual = std::chrono::steady_clock::now();
+  if (actual - cached < max_staleness()) return cached;
+  // The refreshers have stalled, use (and publish) the current time.
+  Update(actual.time_since_epoch().count());
+  return actual;
+}
+
+void CoarseSteadyClock::Refresh() noexcept {
+  Update(std::chrono::steady_clock::now().time_since_epoch().count());
+}
+
+CoarseSteadyClock::Refresher::Refresher() noexcept {
+  // Initialize the cached time before `now()` starts using it.
+  Refresh();
+  refreshers.fetch_add(1, std::memory_order_release);
+}
+
+CoarseSteadyClock::Refresher::~Refresher() {
+  refreshers.fetch_sub(1, std::memory_order_release);
+}
+
+}  // namespace internal
+}  // namespace GOOGLE_CLOUD_CPP_NS
+}  // namespace cloud
+}  // namespace google
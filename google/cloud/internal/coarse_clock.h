@@ -0,0 +1,88 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_INTERNAL_COARSE_CLOCK_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_INTERNAL_COARSE_CLOCK_H
+
+#include "google/cloud/version.h"
+#include <chrono>
+
+namespace google {
+namespace cloud {
+inline namespace GOOGLE_CLOUD_CPP_NS {
+namespace internal {
+/**
+ * A steady clock that returns a cached value, for time checks in hot paths.
+ *
+ * Reading `std::chrono::steady_clock` is cheap, but not free, and some checks
+ * (e.g. selecting the time bucket for a request) only need a coarse time. The
+ * threads running a completion queue refresh a cached value each time they
+ * wake up, and `now()` returns this cached value. While the completion queue
+ * is idle its threads wake up every few tens of milliseconds, so the cached
+ * value may be that old.
+ *
+ * If no thread is refreshing the cached value `now()` falls back to
+ * `std::chrono::steady_clock::now()`.
+ *
+ * A refresher may also stall, for example if a completion queue thread runs a
+ * long callback. To bound the error, each thread compares the cached value
+ * against `std::chrono::steady_clock` once every few calls to `now()`. If the
+ * cached value is older than `max_staleness()` the thread refreshes it, and
+ * returns the current time. Between these checks a thread may still observe a
+ * stale value, for at most a few calls.
+ *
+ * This satisfies the `Clock` requirements, with the same `time_point` as
+ * `std::chrono::steady_clock`, so values from both clocks can be compared.
+ */
+class CoarseSteadyClock {
+ public:
+  using duration = std::chrono::steady_clock::duration;
+  using rep = duration::rep;
+  using period = duration::period;
+  using time_point = std::chrono::steady_clock::time_point;
+  static constexpr bool is_steady = true;
+
+  /// The cached time, or the current time if there is no refresher.
+  static time_point now() noexcept;
+
+  /// Update the cached time.
+  static void Refresh() noexcept;
+
+  /// The age of the cached value that triggers a refresh in `now()`.
+  static std::chrono::milliseconds max_staleness() noexcept {
+    return std::chrono::milliseconds(200);
+  }
+
+  /**
+   * Register the current thread as a refresher while this object lives.
+   *
+   * The thread must call `Refresh()` periodically, typically each time it
+   * wakes up.
+   */
+  class Refresher {
+   public:
+    Refresher() noexcept;
+    ~Refresher();
+
+    Refresher(Refresher const&) = delete;
+    Refresher& operator=(Refresher const&) = delete;
+  };
+};
+
+}  // namespace internal
+}  // namespace GOOGLE_CLOUD_CPP_NS
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_INTERNAL_COARSE_CLOCK_H
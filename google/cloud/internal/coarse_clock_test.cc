@@ -0,0 +1,88 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/internal/coarse_clock.h"
+#include <gmock/gmock.h>
+#include <thread>
+#include <vector>
+
+namespace google {
+namespace cloud {
+inline namespace GOOGLE_CLOUD_CPP_NS {
+namespace internal {
+namespace {
+
+TEST(CoarseSteadyClock, FallbackWithoutRefresher) {
+  auto const start = std::chrono::steady_clock::now();
+  auto const now = CoarseSteadyClock::now();
+  EXPECT_LE(start, now);
+  EXPECT_GE(std::chrono::steady_clock::now(), now);
+}
+
+TEST(CoarseSteadyClock, CachedWithRefresher) {
+  auto const start = std::chrono::steady_clock::now();
+  CoarseSteadyClock::Refresher refresher;
+  auto const cached = CoarseSteadyClock::now();
+  EXPECT_LE(start, cached);
+
+  // The value does not change until it is refreshed.
+  std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  EXPECT_EQ(cached, CoarseSteadyClock::now());
+
+  CoarseSteadyClock::Refresh();
+  auto const refreshed = CoarseSteadyClock::now();
+  EXPECT_LE(cached + std::chrono::milliseconds(5), refreshed);
+  EXPECT_GE(std::chrono::steady_clock::now(), refreshed);
+}
+
+TEST(CoarseSteadyClock, StaleRefresher) {
+  CoarseSteadyClock::Refresher refresher;
+  auto const cached = CoarseSteadyClock::now();
+
+  // Simulate a refresher that stopped calling `Refresh()`, after a few calls
+  // `now()` returns the current time.
+  std::this_thread::sleep_for(CoarseSteadyClock::max_staleness() +
+                              std::chrono::milliseconds(10));
+  auto now = CoarseSteadyClock::now();
+  for (int i = 0; i != 1000 && now == cached; ++i) {
+    now = CoarseSteadyClock::now();
+  }
+  EXPECT_LE(cached + CoarseSteadyClock::max_staleness(), now);
+  EXPECT_GE(std::chrono::steady_clock::now(), now);
+  // The fresh value is published to all the threads.
+  EXPECT_LE(now, CoarseSteadyClock::now());
+}
+
+TEST(CoarseSteadyClock, Monotonic) {
+  CoarseSteadyClock::Refresher refresher;
+  std::vector<std::thread> threads;
+  for (int t = 0; t != 4; ++t) {
+    threads.emplace_back([] {
+      auto last = CoarseSteadyClock::now();
+      for (int i = 0; i != 1000; ++i) {
+        CoarseSteadyClock::Refresh();
+        auto const now = CoarseSteadyClock::now();
+        EXPECT_LE(last, now);
+        last = now;
+      }
+    });
+  }
+  for (auto& t : threads) t.join();
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace GOOGLE_CLOUD_CPP_NS
+}  // namespace cloud
+}  // namespace google
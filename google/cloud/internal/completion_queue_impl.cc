@@ -13,8 +13,10 @@
 // limitations under the License.
 
 #include "google/cloud/internal/completion_queue_impl.h"
+#include "google/cloud/internal/coarse_clock.h"
 #include "google/cloud/internal/make_unique.h"
 #include "google/cloud/internal/throw_delegate.h"
+#include <grpc/support/time.h>
 
 // There is no wait to unblock the gRPC event loop, not even calling Shutdown(),
 // so we periodically wake up from the loop to check if the application has
@@ -25,6 +27,96 @@ namespace google {
 namespace cloud {
 inline namespace GOOGLE_CLOUD_CPP_NS {
 namespace internal {
+namespace {
+/**
+ * Wrap a gRPC timer into an `AsyncOperation`.
+ *
+ * Applications (or more likely, other components in the client library) will
+ * associate timers with a completion queue. gRPC timers require applications to
+ * create a unique `grpc::Alarm` object for each timer, and then to associate
+ * them with the completion queue using a `void*` tag.
+ *
+ * This class collaborates with our wrapper for `CompletionQueue` to associate
+ * a `future<AsyncTimerResult>` for each timer. This class takes care of
+ * allocating the `grpc::Alarm`, creating a unique `void*` associated with the
+ * timer, and satisfying the future when the timer expires.
+ *
+ * Note that this class is an implementation detail, hidden from the application
+ * developers.
+ */
+class AsyncTimerFuture : public AsyncGrpcOperation {
+ public:
+  explicit AsyncTimerFuture(std::unique_ptr<grpc::Alarm> alarm)
+      : alarm_(std::move(alarm)),
+        promise_(/*cancellation_callback=*/MakeCancellationCallback(alarm_)) {}
+
+  future<StatusOr<std::chrono::system_clock::time_point>> GetFuture() {
+    return promise_.get_future();
+  }
+
+  void Set(grpc::CompletionQueue& cq,
+           std::chrono::system_clock::time_point deadline, void* tag) {
+    deadline_ = deadline;
+
+    if (alarm_) {
+      alarm_->Set(&cq, deadline, tag);
+    }
+  }
+
+  /// Set a timer using the monotonic clock, unaffected by system clock changes.
+  void Set(grpc::CompletionQueue& cq, std::chrono::nanoseconds duration,
+           void* tag) {
+    deadline_ = std::chrono::system_clock::now() +
+                std::chrono::duration_cast<
+                    std::chrono::system_clock::duration>(duration);
+
+    if (alarm_) {
+      alarm_->Set(&cq,
+                  gpr_time_add(gpr_now(GPR_CLOCK_MONOTONIC),
+                               gpr_time_from_nanos(duration.count(),
+                                                   GPR_TIMESPAN)),
+                  tag);
+    }
+  }
+
+  void Cancel() override {
+    if (alarm_) {
+      alarm_->Cancel();
+    }
+  }
+
+ private:
+  bool Notify(bool ok) override {
+    if (!ok) {
+      promise_.set_value(Status(StatusCode::kCancelled, "timer canceled"));
+    } else {
+      promise_.set_value(deadline_);
+    }
+    return true;
+  }
+
+  /**
+   * Cancel the alarm when the future is cancelled.
+   *
+   * The future may outlive this object, so the callback cannot capture `this`.
+   * A weak reference to the alarm is safe even if the timer already expired.
+   */
+  static std::function<void()> MakeCancellationCallback(
+      std::shared_ptr<grpc::Alarm> const& alarm) {
+    std::weak_ptr<grpc::Alarm> w = alarm;
+    return [w] {
+      if (auto a = w.lock()) a->Cancel();
+    };
+  }
+
+  /// Holds the underlying handle. It might be a nullptr in tests.
+  std::shared_ptr<grpc::Alarm> alarm_;
+  promise<StatusOr<std::chrono::system_clock::time_point>> promise_;
+  std::chrono::system_clock::time_point deadline_;
+};
+
+}  // namespace
+
 void CompletionQueueImpl::Run() {
   void* tag;
   bool ok;
@@ -32,9 +124,12 @@ void CompletionQueueImpl::Run() {
     return std::chrono::system_clock::now() + kLoopTimeout;
   };
 
+  // Refresh the coarse clock each time this thread wakes up.
+  CoarseSteadyClock::Refresher refresher;
   for (auto status = cq_.AsyncNext(&tag, &ok, deadline());
        status != grpc::CompletionQueue::SHUTDOWN;
        status = cq_.AsyncNext(&tag, &ok, deadline())) {
+    CoarseSteadyClock::Refresh();
     if (status == grpc::CompletionQueue::TIMEOUT) continue;
     if (status != grpc::CompletionQueue::GOT_EVENT) {
       google::cloud::internal::ThrowRuntimeError(
@@ -95,6 +190,21 @@ void CompletionQueueImpl::ForgetOperation(void* tag) {
   }
 }
 
+future<StatusOr<std::chrono::system_clock::time_point>>
+CompletionQueueImpl::MakeDeadlineTimer(
+    std::chrono::system_clock::time_point deadline) {
+  auto op = std::make_shared<AsyncTimerFuture>(CreateAlarm());
+  StartOperation(op, [&](void* tag) { op->Set(cq_, deadline, tag); });
+  return op->GetFuture();
+}
+
+future<StatusOr<std::chrono::system_clock::time_point>>
+CompletionQueueImpl::MakeRelativeTimer(std::chrono::nanoseconds duration) {
+  auto op = std::make_shared<AsyncTimerFuture>(CreateAlarm());
+  StartOperation(op, [&](void* tag) { op->Set(cq_, duration, tag); });
+  return op->GetFuture();
+}
+
 // This function is used in unit tests to simulate the completion of an
 // operation. The unit test is expected to create a class derived from
 // `CompletionQueueImpl`, wrap it in a `CompletionQueue` and call this function
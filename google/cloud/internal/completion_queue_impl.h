@@ -25,8 +25,10 @@
 #include <grpcpp/alarm.h>
 #include <grpcpp/support/async_stream.h>
 #include <grpcpp/support/async_unary_call.h>
+#include <chrono>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 namespace google {
 namespace cloud {
@@ -84,16 +86,17 @@ class AsyncGrpcOperation : public AsyncOperation {
 template <typename Request, typename Response>
 class AsyncUnaryRpcFuture : public AsyncGrpcOperation {
  public:
-  AsyncUnaryRpcFuture() = default;
+  explicit AsyncUnaryRpcFuture(std::unique_ptr<grpc::ClientContext> context)
+      : context_(std::move(context)),
+        promise_(/*cancellation_callback=*/MakeCancellationCallback(context_)) {
+  }
 
   future<StatusOr<Response>> GetFuture() { return promise_.get_future(); }
 
   /// Prepare the operation to receive the response and start the RPC.
   template <typename AsyncFunctionType>
-  void Start(AsyncFunctionType async_call,
-             std::unique_ptr<grpc::ClientContext> context,
-             Request const& request, grpc::CompletionQueue* cq, void* tag) {
-    context_ = std::move(context);
+  void Start(AsyncFunctionType async_call, Request const& request,
+             grpc::CompletionQueue* cq, void* tag) {
     auto rpc = async_call(context_.get(), request, cq);
     rpc->Finish(&response_, &status_, tag);
   }
@@ -119,12 +122,27 @@ class AsyncUnaryRpcFuture : public AsyncGrpcOperation {
     return true;
   }
 
+  /**
+   * Cancel the RPC when the future is cancelled.
+   *
+   * The future may outlive this object, so the callback holds a weak reference
+   * to the context. Calling `TryCancel()` on a completed RPC has no effect.
+   */
+  static std::function<void()> MakeCancellationCallback(
+      std::shared_ptr<grpc::ClientContext> const& context) {
+    std::weak_ptr<grpc::ClientContext> w = context;
+    return [w] {
+      if (auto c = w.lock()) c->TryCancel();
+    };
+  }
+
   // These are the parameters for the RPC, most of them have obvious semantics.
-  // `context_` is stored as a `unique_ptr` because (a) we need to receive it
-  // as a parameter, otherwise the caller could not set timeouts, metadata, or
-  // any other attributes, and (b) there is no move or assignment operator for
-  // `grpc::ClientContext`.
-  std::unique_ptr<grpc::ClientContext> context_;
+  // `context_` is stored as a pointer because (a) we need to receive it as a
+  // parameter, otherwise the caller could not set timeouts, metadata, or any
+  // other attributes, and (b) there is no move or assignment operator for
+  // `grpc::ClientContext`. It is a `shared_ptr` so the cancellation callback
+  // can hold a weak reference to it.
+  std::shared_ptr<grpc::ClientContext> context_;
   grpc::Status status_;
   Response response_;
 
@@ -247,6 +265,14 @@ class CompletionQueueImpl {
   /// The underlying gRPC completion queue.
   grpc::CompletionQueue& cq() { return cq_; }
 
+  /// Create a timer that expires at @p deadline.
+  future<StatusOr<std::chrono::system_clock::time_point>> MakeDeadlineTimer(
+      std::chrono::system_clock::time_point deadline);
+
+  /// Create a timer that expires after @p duration, using a monotonic clock.
+  future<StatusOr<std::chrono::system_clock::time_point>> MakeRelativeTimer(
+      std::chrono::nanoseconds duration);
+
   /// Atomically add a new operation to the completion queue and start it.
   template <typename Callable,
             typename std::enable_if<
@@ -272,6 +298,29 @@ class CompletionQueueImpl {
         "assertion failure: insertion should succeed");
   }
 
+  /**
+   * Start a new asynchronous call using an operation that is still pending.
+   *
+   * Streaming operations can reuse the same operation (and tag) for each call,
+   * avoiding the allocations and map updates in `StartOperation()`. The
+   * operation must have been started with `StartOperation()`, and its last
+   * `Notify()` call must have returned `false`.
+   */
+  template <typename Callable,
+            typename std::enable_if<
+                google::cloud::internal::is_invocable<Callable, void*>::value,
+                int>::type = 0>
+  void RestartOperation(AsyncGrpcOperation& op, Callable&& start) {
+    void* tag = &op;
+    std::unique_lock<std::mutex> lk(mu_);
+    if (shutdown_) {
+      lk.unlock();
+      if (op.Notify(/*ok=*/false)) ForgetOperation(tag);
+      return;
+    }
+    start(tag);
+  }
+
  protected:
   /// Return the asynchronous operation associated with @p tag.
   std::shared_ptr<AsyncGrpcOperation> FindOperation(void* tag);
@@ -296,6 +345,17 @@ class CompletionQueueImpl {
     return pending_ops_.size();
   }
 
+  /// The tags of the pending operations, provided only to support unit tests.
+  std::vector<void*> pending_tags() const {
+    std::unique_lock<std::mutex> lk(mu_);
+    std::vector<void*> tags;
+    tags.reserve(pending_ops_.size());
+    for (auto const& kv : pending_ops_) {
+      tags.push_back(reinterpret_cast<void*>(kv.first));
+    }
+    return tags;
+  }
+
  private:
   grpc::CompletionQueue cq_;
   mutable std::mutex mu_;
@@ -304,6 +364,73 @@ class CompletionQueueImpl {
       pending_ops_;  // GUARDED_BY(mu_)
 };
 
+#if GOOGLE_CLOUD_CPP_HAVE_COROUTINES
+/**
+ * Resume a suspended coroutine on a thread running the completion queue.
+ *
+ * This uses a `grpc::Alarm` that expires immediately, gRPC delivers the alarm
+ * to a thread blocked in `CompletionQueue::Run()`.
+ */
+class AsyncResumeOperation final : public AsyncGrpcOperation {
+ public:
+  AsyncResumeOperation(std::coroutine_handle<> handle,
+                       std::unique_ptr<grpc::Alarm> alarm)
+      : handle_(handle), alarm_(std::move(alarm)) {}
+
+  void Set(grpc::CompletionQueue& cq, void* tag) {
+    // Holds the underlying handle. It might be a nullptr in tests.
+    if (alarm_) alarm_->Set(&cq, std::chrono::system_clock::now(), tag);
+  }
+
+  void Cancel() override {}  // LCOV_EXCL_LINE
+
+ private:
+  bool Notify(bool) override {
+    // Even if the completion queue is shutting down we must resume the
+    // coroutine, otherwise it would never release its resources.
+    handle_.resume();
+    return true;
+  }
+
+  std::coroutine_handle<> handle_;
+  std::unique_ptr<grpc::Alarm> alarm_;
+};
+
+/**
+ * Await a `future<T>` and resume the coroutine on a completion queue thread.
+ *
+ * Unlike `future_awaiter<T>` this always suspends the coroutine, even if the
+ * future is already satisfied, so the coroutine always resumes on a thread
+ * running the completion queue.
+ */
+template <typename T>
+class CompletionQueueAwaiter : public future_awaiter<T> {
+ public:
+  CompletionQueueAwaiter(std::shared_ptr<CompletionQueueImpl> cq, future<T> f)
+      : future_awaiter<T>(std::move(f)), cq_(std::move(cq)) {}
+
+  bool await_ready() const { return false; }
+
+  void await_suspend(std::coroutine_handle<> h) {
+    if (future_awaiter<T>::await_suspend(h)) return;
+    // Already satisfied, but we still need to hop to the completion queue.
+    execute();
+  }
+
+ private:
+  void execute() override {
+    // The coroutine may be resumed, and `*this` destroyed, before
+    // `StartOperation()` returns. Only use local variables after this point.
+    auto cq = cq_;
+    auto op = std::make_shared<AsyncResumeOperation>(this->handle(),
+                                                     cq->CreateAlarm());
+    cq->StartOperation(op, [&](void* tag) { op->Set(cq->cq(), tag); });
+  }
+
+  std::shared_ptr<CompletionQueueImpl> cq_;
+};
+#endif  // GOOGLE_CLOUD_CPP_HAVE_COROUTINES
+
 }  // namespace internal
 }  // namespace GOOGLE_CLOUD_CPP_NS
 }  // namespace cloud
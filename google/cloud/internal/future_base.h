@@ -150,8 +150,12 @@ template <typename T>
 class promise_base {
  public:
   explicit promise_base(std::function<void()> cancellation_callback)
-      : shared_state_(
-            std::make_shared<shared_state_type>(cancellation_callback)) {}
+      : promise_base(DefaultMemoryResource(),
+                     std::move(cancellation_callback)) {}
+  promise_base(MemoryResource* resource,
+               std::function<void()> cancellation_callback)
+      : shared_state_(make_shared_state<T>(resource,
+                                           std::move(cancellation_callback))) {}
   promise_base(promise_base&&) noexcept = default;
 
   ~promise_base() {
@@ -0,0 +1,157 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_INTERNAL_FUTURE_COROUTINES_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_INTERNAL_FUTURE_COROUTINES_H
+/**
+ * @file
+ *
+ * Define the C++20 coroutine support for `google::cloud::future<T>`.
+ *
+ * With this support applications can `co_await` a `future<T>`, and can write
+ * coroutines that return `future<T>`. The support is only enabled if the
+ * compiler and the standard library support coroutines, that is, when
+ * `GOOGLE_CLOUD_CPP_HAVE_COROUTINES` is defined.
+ */
+
+#include "google/cloud/internal/future_then_impl.h"
+#include "google/cloud/version.h"
+
+#if GOOGLE_CLOUD_CPP_HAVE_COROUTINES
+#include <coroutine>
+
+namespace google {
+namespace cloud {
+inline namespace GOOGLE_CLOUD_CPP_NS {
+namespace internal {
+/**
+ * Suspend a coroutine until a `future<T>` is satisfied.
+ *
+ * The awaiter lives in the coroutine frame for as long as the coroutine is
+ * suspended, so it can serve as the continuation for the future's shared
+ * state. Awaiting a future does not allocate: there is no `.then()` call, no
+ * new shared state, and no heap-allocated continuation.
+ *
+ * The coroutine is resumed by whatever thread satisfies the future. If the
+ * future is already satisfied the coroutine does not suspend at all.
+ *
+ * @tparam T the value type of the awaited future.
+ */
+template <typename T>
+class future_awaiter : public continuation_base {
+ public:
+  explicit future_awaiter(future<T> f) : state_(std::move(f.shared_state_)) {
+    if (!state_) ThrowFutureError(std::future_errc::no_state, __func__);
+  }
+
+  bool await_ready() const { return state_->is_ready(); }
+
+  bool await_suspend(std::coroutine_handle<> h) {
+    handle_ = h;
+    continuation_ptr self(this);
+    if (state_->try_set_continuation(self)) return true;
+    // The shared state was satisfied after `await_ready()`, just resume.
+    (void)self.release();
+    return false;
+  }
+
+  T await_resume() {
+    auto state = std::move(state_);
+    return state->get();
+  }
+
+ protected:
+  void execute() override { handle_.resume(); }
+
+  // The coroutine frame owns this object, and resuming the coroutine may
+  // destroy it. Nothing can touch `*this` after `execute()`.
+  void execute_and_dispose() override { execute(); }
+  void dispose() override {}
+
+  std::coroutine_handle<> handle() const { return handle_; }
+
+ private:
+  std::shared_ptr<future_shared_state<T>> state_;
+  std::coroutine_handle<> handle_;
+};
+
+/**
+ * The common implementation for `future<T>` and `future<void>` coroutines.
+ *
+ * The coroutine starts eagerly and runs until its first suspension point, the
+ * returned future is satisfied when the coroutine body completes.
+ */
+template <typename T>
+class future_coroutine_promise_base {
+ public:
+  future<T> get_return_object() { return promise_.get_future(); }
+
+  std::suspend_never initial_suspend() noexcept { return {}; }
+  std::suspend_never final_suspend() noexcept { return {}; }
+
+  void unhandled_exception() {
+#if GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+    promise_.set_exception(std::current_exception());
+#else
+    google::cloud::Terminate(
+        "unhandled exception in coroutine but exceptions are disabled");
+#endif  // GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+  }
+
+ protected:
+  promise<T> promise_;
+};
+
+/// The promise type for coroutines returning `future<T>`.
+template <typename T>
+class future_coroutine_promise : public future_coroutine_promise_base<T> {
+ public:
+  void return_value(T value) { this->promise_.set_value(std::move(value)); }
+};
+
+/// The promise type for coroutines returning `future<void>`.
+template <>
+class future_coroutine_promise<void>
+    : public future_coroutine_promise_base<void> {
+ public:
+  void return_void() { this->promise_.set_value(); }
+};
+
+}  // namespace internal
+
+/**
+ * Make `future<T>` awaitable in C++20 coroutines.
+ *
+ * Awaiting a future consumes it, just like `.get()` or `.then()`. The
+ * coroutine resumes on the thread that satisfies the future, or does not
+ * suspend at all if the future is already satisfied.
+ */
+template <typename T>
+internal::future_awaiter<T> operator co_await(future<T> f) {
+  return internal::future_awaiter<T>(std::move(f));
+}
+
+}  // namespace GOOGLE_CLOUD_CPP_NS
+}  // namespace cloud
+}  // namespace google
+
+/// Allow coroutines to return `google::cloud::future<T>`.
+template <typename T, typename... Args>
+struct std::coroutine_traits<google::cloud::future<T>, Args...> {
+  using promise_type = google::cloud::internal::future_coroutine_promise<T>;
+};
+
+#endif  // GOOGLE_CLOUD_CPP_HAVE_COROUTINES
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_INTERNAL_FUTURE_COROUTINES_H
@@ -39,6 +39,12 @@ template <>
 class promise<void>;
 template <>
 class future<void>;
+
+namespace internal {
+// Forward declare the awaiter for C++20 coroutines, `future<T>` befriends it.
+template <typename T>
+class future_awaiter;
+}  // namespace internal
 }  // namespace GOOGLE_CLOUD_CPP_NS
 }  // namespace cloud
 }  // namespace google
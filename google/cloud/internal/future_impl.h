@@ -22,8 +22,10 @@
 
 #include "google/cloud/internal/future_then_meta.h"
 #include "google/cloud/internal/make_unique.h"
+#include "google/cloud/memory_resource.h"
 #include "google/cloud/terminate_handler.h"
 #include <condition_variable>
+#include <cstdint>
 #include <exception>
 #include <future>
 #include <mutex>
@@ -51,8 +53,35 @@ class continuation_base {
 
   /// Invoke the continuation.
   virtual void execute() = 0;
+
+  /**
+   * Invoke the continuation and then release it.
+   *
+   * Most continuations are allocated by `.then()` and owned by the shared
+   * state. Some continuations, notably the awaiters for C++20 coroutines, live
+   * in storage owned by somebody else, and may even be destroyed as a side
+   * effect of `execute()`. Those override this function and `dispose()`.
+   */
+  virtual void execute_and_dispose();
+
+  /// Release a continuation that is no longer needed.
+  virtual void dispose() { delete this; }
 };
 
+/// Release continuations via `continuation_base::dispose()`.
+struct continuation_deleter {
+  void operator()(continuation_base* c) const { c->dispose(); }
+};
+
+/// The type used by shared states to hold (and release) their continuations.
+using continuation_ptr = std::unique_ptr<continuation_base, continuation_deleter>;
+
+inline void continuation_base::execute_and_dispose() {
+  // Release the continuation even if `execute()` raises.
+  continuation_ptr self(this);
+  execute();
+}
+
 /**
  * Common base class for all shared state classes.
  *
@@ -68,12 +97,38 @@ class continuation_base {
  */
 class future_shared_state_base {
  public:
-  future_shared_state_base() : future_shared_state_base([] {}) {}
-  explicit future_shared_state_base(std::function<void()> cancellation_callback)
-      : mu_(),
-        cv_(),
-        current_state_(state::not_ready),
-        cancellation_callback_(std::move(cancellation_callback)) {}
+  /**
+   * Holds the cancellation callback, if any.
+   *
+   * Most shared states cannot be cancelled, storing the (rarely used) callback
+   * out of line keeps the shared state small.
+   */
+  using cancellation_slot = std::unique_ptr<std::function<void()>>;
+
+  /// Create a slot for @p callback, returns `nullptr` if it is empty.
+  static cancellation_slot make_cancellation_slot(
+      std::function<void()> callback) {
+    if (!callback) return cancellation_slot{};
+    return internal::make_unique<std::function<void()>>(std::move(callback));
+  }
+
+  future_shared_state_base() : future_shared_state_base(cancellation_slot{}) {}
+  explicit future_shared_state_base(
+      std::function<void()> cancellation_callback,
+      MemoryResource* resource = DefaultMemoryResource())
+      : future_shared_state_base(
+            make_cancellation_slot(std::move(cancellation_callback)),
+            resource) {}
+  explicit future_shared_state_base(
+      cancellation_slot cancellation_callback,
+      MemoryResource* resource = DefaultMemoryResource())
+      : cancellation_callback_(std::move(cancellation_callback)),
+        memory_resource_(resource),
+        current_state_(state::not_ready) {}
+
+  /// The resource used to allocate this shared state and its continuations.
+  MemoryResource* memory_resource() const { return memory_resource_; }
+
   /// Return true if the shared state has a value or an exception.
   bool is_ready() const {
     std::unique_lock<std::mutex> lk(mu_);
@@ -81,12 +136,15 @@ class future_shared_state_base {
   }
 
   /// Return true if the shared state can be cancelled.
-  bool cancellable() const { return !is_ready() && !cancelled_; }
+  bool cancellable() const {
+    std::unique_lock<std::mutex> lk(mu_);
+    return !is_ready_unlocked() && !cancelled_;
+  }
 
   /// Block until is_ready() returns true ...
   void wait() {
     std::unique_lock<std::mutex> lk(mu_);
-    cv_.wait(lk, [this] { return is_ready_unlocked(); });
+    wait_unlocked(lk);
   }
 
   /**
@@ -114,8 +172,10 @@ class future_shared_state_base {
   template <typename Rep, typename Period>
   std::future_status wait_for(std::chrono::duration<Rep, Period> duration) {
     std::unique_lock<std::mutex> lk(mu_);
-    bool result =
-        cv_.wait_for(lk, duration, [this] { return is_ready_unlocked(); });
+    bool result = is_ready_unlocked() ||
+                  waiters(lk).wait_for(lk, duration, [this] {
+                    return is_ready_unlocked();
+                  });
     if (result) {
       return std::future_status::ready;
     }
@@ -147,8 +207,10 @@ class future_shared_state_base {
     if (!lk.owns_lock()) {
       return std::future_status::timeout;
     }
-    bool result =
-        cv_.wait_until(lk, deadline, [this] { return is_ready_unlocked(); });
+    bool result = is_ready_unlocked() ||
+                  waiters(lk).wait_until(lk, deadline, [this] {
+                    return is_ready_unlocked();
+                  });
     if (result) {
       return std::future_status::ready;
     }
@@ -185,10 +247,14 @@ class future_shared_state_base {
 #else
     set_exception(nullptr, lk);
 #endif
-    cv_.notify_all();
+    if (cv_) cv_->notify_all();
   }
 
   void set_continuation(std::unique_ptr<continuation_base> c) {
+    set_continuation(continuation_ptr(c.release()));
+  }
+
+  void set_continuation(continuation_ptr c) {
     std::unique_lock<std::mutex> lk(mu_);
     if (continuation_) {
       ThrowFutureError(std::future_errc::future_already_retrieved, __func__);
@@ -198,32 +264,105 @@ class future_shared_state_base {
       // Release the lock before calling the user's code, holding locks during
       // callbacks is a bad practice.
       lk.unlock();
-      c->execute();
+      c.release()->execute_and_dispose();
       return;
     }
     continuation_ = std::move(c);
   }
 
-  std::function<void()> release_cancellation_callback() {
+  /**
+   * Set the continuation unless the shared state is already satisfied.
+   *
+   * Unlike `set_continuation()` this function never invokes @p c. If the shared
+   * state is already satisfied it returns `false` and @p c is not modified.
+   * Coroutine awaiters use this function because they cannot be resumed from
+   * their own `await_suspend()` member function.
+   */
+  bool try_set_continuation(continuation_ptr& c) {
+    std::unique_lock<std::mutex> lk(mu_);
+    if (continuation_) {
+      ThrowFutureError(std::future_errc::future_already_retrieved, __func__);
+    }
+    if (is_ready_unlocked()) return false;
+    continuation_ = std::move(c);
+    return true;
+  }
+
+  cancellation_slot release_cancellation_callback() {
+    std::unique_lock<std::mutex> lk(mu_);
     return std::move(cancellation_callback_);
   }
 
+  /**
+   * Replace the cancellation callback.
+   *
+   * Unwrapping continuations use this function to forward cancellation
+   * requests to the future returned by their functor. If the shared state was
+   * already cancelled, and it is not satisfied, @p callback is invoked
+   * immediately, that is, cancellation requests are "sticky".
+   */
+  void set_cancellation_callback(std::function<void()> callback) {
+    auto slot = make_cancellation_slot(std::move(callback));
+    std::unique_lock<std::mutex> lk(mu_);
+    if (!cancelled_ || is_ready_unlocked()) {
+      cancellation_callback_.swap(slot);
+      return;
+    }
+    lk.unlock();
+    if (slot) (*slot)();
+  }
+
   // Try to cancel the task by invoking the cancellation_callback.
   bool cancel() {
-    if (!cancellable()) {
+    std::unique_lock<std::mutex> lk(mu_);
+    if (is_ready_unlocked() || cancelled_) {
       return false;
     }
-    cancellation_callback_();
-    // If the callback fails with an exception we assume it had no effect.
-    // Incidentally this means we provide the strong exception guarantee for
-    // this function.
+    // The callback is invoked at most once, and it may satisfy the shared
+    // state, take ownership and call it without holding the lock.
+    auto callback = std::move(cancellation_callback_);
     cancelled_ = true;
+    lk.unlock();
+    if (!callback) return true;
+#if GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+    try {
+      (*callback)();
+    } catch (...) {
+      // If the callback fails with an exception we assume it had no effect.
+      // Incidentally this means we provide the strong exception guarantee for
+      // this function.
+      lk.lock();
+      cancelled_ = false;
+      if (!cancellation_callback_) cancellation_callback_ = std::move(callback);
+      throw;
+    }
+#else
+    (*callback)();
+#endif  // GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
     return true;
   }
 
  protected:
   bool is_ready_unlocked() const { return current_state_ != state::not_ready; }
 
+  /**
+   * Return the condition variable used by blocked threads.
+   *
+   * Most shared states are consumed via `.then()`, or are already satisfied
+   * when `.get()` is called. The condition variable is created only when a
+   * thread actually needs to block.
+   */
+  std::condition_variable& waiters(std::unique_lock<std::mutex>&) {
+    if (!cv_) cv_ = internal::make_unique<std::condition_variable>();
+    return *cv_;
+  }
+
+  /// Block until the shared state is satisfied, @p lk must hold `mu_`.
+  void wait_unlocked(std::unique_lock<std::mutex>& lk) {
+    if (is_ready_unlocked()) return;
+    waiters(lk).wait(lk, [this] { return is_ready_unlocked(); });
+  }
+
   /// Satisfy the shared state using an exception.
   void set_exception(std::exception_ptr ex, std::unique_lock<std::mutex>&) {
     if (is_ready_unlocked()) {
@@ -238,14 +377,18 @@ class future_shared_state_base {
     if (continuation_) {
       // Release the lock before calling the continuation because the
       // continuation will likely call get() to fetch the state of the future.
+      // The continuation is no longer needed after this point, and some
+      // continuations (e.g. coroutine awaiters) are destroyed by `execute()`,
+      // so transfer ownership before invoking it.
+      auto continuation = std::move(continuation_);
       lk.unlock();
-      continuation_->execute();
+      continuation.release()->execute_and_dispose();
       // If there is a continuation there can be no threads blocked on get() or
       // wait() because then() invalidates the future. Therefore we can return
       // without notifying any other threads.
       return;
     }
-    cv_.notify_all();
+    if (cv_) cv_->notify_all();
   }
 
   /**
@@ -272,6 +415,27 @@ class future_shared_state_base {
     }
   }
 
+  // The data members are ordered to minimize padding, some applications create
+  // millions of shared states.
+  mutable std::mutex mu_;
+  /// Created on demand by `waiters()`.
+  std::unique_ptr<std::condition_variable> cv_;
+  std::exception_ptr exception_;
+
+  /**
+   * The continuation, if any, associated with this shared state.
+   *
+   * Note that continuations may be set independently of having a value or
+   * exception. Setting a continuation does not change the `current_state_`
+   * member variable and does not satisfy the shared state.
+   */
+  continuation_ptr continuation_;
+
+  // Allow users "cancel" the future with the given callback.
+  cancellation_slot cancellation_callback_;
+
+  MemoryResource* memory_resource_;
+
   // My (@coryan) reading of the spec is that calling get_future() on a promise
   // should succeed exactly once, even when used from multiple threads. This
   // requires some kind of flag and synchronization primitive. The obvious
@@ -284,29 +448,14 @@ class future_shared_state_base {
   // a bool, but that is more overhead than just a flag here.
   /// Keep track of whether `get_future()` has been called.
   std::atomic_flag retrieved_ = ATOMIC_FLAG_INIT;
-
-  mutable std::mutex mu_;
-  std::condition_variable cv_;
-  enum class state {
+  enum class state : std::uint8_t {
     not_ready,
     has_exception,
     has_value,
   };
   state current_state_;
-  std::exception_ptr exception_;
-
-  /**
-   * The continuation, if any, associated with this shared state.
-   *
-   * Note that continuations may be set independently of having a value or
-   * exception. Setting a continuation does not change the `current_state_`
-   * member variable and does not satisfy the shared state.
-   */
-  std::unique_ptr<continuation_base> continuation_;
-
-  // Allow users "cancel" the future with the given callback.
-  std::atomic<bool> cancelled_ = ATOMIC_VAR_INIT(false);
-  std::function<void()> cancellation_callback_;
+  /// Set by `cancel()`, guarded by `mu_`.
+  bool cancelled_ = false;
 };
 
 /**
@@ -334,8 +483,16 @@ template <typename T>
 class future_shared_state final : private future_shared_state_base {
  public:
   future_shared_state() : future_shared_state_base(), buffer_() {}
-  explicit future_shared_state(std::function<void()> cancellation_callback)
-      : future_shared_state_base(std::move(cancellation_callback)), buffer_() {}
+  explicit future_shared_state(
+      std::function<void()> cancellation_callback,
+      MemoryResource* resource = DefaultMemoryResource())
+      : future_shared_state_base(std::move(cancellation_callback), resource),
+        buffer_() {}
+  explicit future_shared_state(
+      cancellation_slot cancellation_callback,
+      MemoryResource* resource = DefaultMemoryResource())
+      : future_shared_state_base(std::move(cancellation_callback), resource),
+        buffer_() {}
   ~future_shared_state() {
     if (current_state_ == state::has_value) {
       // Recall that state::has_value is a terminal state, once a value is
@@ -348,11 +505,15 @@ class future_shared_state final : private future_shared_state_base {
   }
 
   using future_shared_state_base::abandon;
+  using typename future_shared_state_base::cancellation_slot;
   using future_shared_state_base::cancel;
   using future_shared_state_base::is_ready;
+  using future_shared_state_base::memory_resource;
   using future_shared_state_base::release_cancellation_callback;
+  using future_shared_state_base::set_cancellation_callback;
   using future_shared_state_base::set_continuation;
   using future_shared_state_base::set_exception;
+  using future_shared_state_base::try_set_continuation;
   using future_shared_state_base::wait;
   using future_shared_state_base::wait_for;
   using future_shared_state_base::wait_until;
@@ -360,7 +521,7 @@ class future_shared_state final : private future_shared_state_base {
   /// The implementation details for `future<T>::get()`
   T get() {
     std::unique_lock<std::mutex> lk(mu_);
-    cv_.wait(lk, [this] { return is_ready_unlocked(); });
+    wait_unlocked(lk);
     if (current_state_ == state::has_exception) {
 #if GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
       std::rethrow_exception(exception_);
@@ -403,18 +564,52 @@ class future_shared_state final : private future_shared_state_base {
     notify_now(std::move(lk));
   }
 
+  /**
+   * Satisfy @p dest with the value or exception stored in this shared state.
+   *
+   * Unwrapping continuations use this function to transfer the result of an
+   * inner future to the outer future. Unlike `get()` this does not rethrow
+   * (and then catch) the stored exception, if any. The shared state must be
+   * satisfied.
+   */
+  void forward_to(future_shared_state& dest) {
+    std::unique_lock<std::mutex> lk(mu_);
+    if (current_state_ == state::has_exception) {
+      auto ex = exception_;
+      lk.unlock();
+      dest.set_exception(std::move(ex));
+      return;
+    }
+    // The state is terminal, and only the continuation (which is running this
+    // function) can consume the value, it is safe to release the lock.
+    lk.unlock();
+    dest.set_value(std::move(*reinterpret_cast<T*>(&buffer_)));
+  }
+
   /**
    * Create a continuation object wrapping the given functor.
    *
    * @tparam F the functor type.
    * @param self the object that will hold the continuation.
    * @param functor the continuation type.
+   * @param resource allocate the continuation and its shared state using this
+   *     resource.
    * @return A shared pointer to the shared state that will store the results
    *     of the continuation.
    */
   template <typename F>
   static std::shared_ptr<typename internal::continuation_helper<F, T>::state_t>
-  make_continuation(std::shared_ptr<future_shared_state> self, F&& functor);
+  make_continuation(std::shared_ptr<future_shared_state> self, F&& functor,
+                    MemoryResource* resource);
+
+  /// Create a continuation using the same resource as @p self.
+  template <typename F>
+  static std::shared_ptr<typename internal::continuation_helper<F, T>::state_t>
+  make_continuation(std::shared_ptr<future_shared_state> self, F&& functor) {
+    auto* resource = self->memory_resource();
+    return make_continuation(std::move(self), std::forward<F>(functor),
+                             resource);
+  }
 
   /**
    * Create a continuation object wrapping the given functor.
@@ -422,6 +617,8 @@ class future_shared_state final : private future_shared_state_base {
    * @tparam F the functor type.
    * @param self the object that will hold the continuation.
    * @param functor the continuation type.
+   * @param resource allocate the continuation and its shared state using this
+   *     resource.
    * @param requires_unwrapping the functor returns a `future<U>`, and must be
    *   implicitly unwrapped to return the `U`.
    * @return A shared pointer to the shared state that will store the results
@@ -431,6 +628,7 @@ class future_shared_state final : private future_shared_state_base {
   static std::shared_ptr<
       typename internal::unwrapping_continuation_helper<F, T>::state_t>
   make_continuation(std::shared_ptr<future_shared_state> self, F&& functor,
+                    MemoryResource* resource,
                     std::true_type requires_unwrapping);
 
   /**
@@ -473,15 +671,25 @@ template <>
 class future_shared_state<void> final : private future_shared_state_base {
  public:
   future_shared_state() : future_shared_state_base() {}
-  explicit future_shared_state(std::function<void()> cancellation_callback)
-      : future_shared_state_base(std::move(cancellation_callback)) {}
+  explicit future_shared_state(
+      std::function<void()> cancellation_callback,
+      MemoryResource* resource = DefaultMemoryResource())
+      : future_shared_state_base(std::move(cancellation_callback), resource) {}
+  explicit future_shared_state(
+      cancellation_slot cancellation_callback,
+      MemoryResource* resource = DefaultMemoryResource())
+      : future_shared_state_base(std::move(cancellation_callback), resource) {}
 
   using future_shared_state_base::abandon;
+  using typename future_shared_state_base::cancellation_slot;
   using future_shared_state_base::cancel;
   using future_shared_state_base::is_ready;
+  using future_shared_state_base::memory_resource;
   using future_shared_state_base::release_cancellation_callback;
+  using future_shared_state_base::set_cancellation_callback;
   using future_shared_state_base::set_continuation;
   using future_shared_state_base::set_exception;
+  using future_shared_state_base::try_set_continuation;
   using future_shared_state_base::wait;
   using future_shared_state_base::wait_for;
   using future_shared_state_base::wait_until;
@@ -489,7 +697,7 @@ class future_shared_state<void> final : private future_shared_state_base {
   /// The implementation details for `future<void>::get()`
   void get() {
     std::unique_lock<std::mutex> lk(mu_);
-    cv_.wait(lk, [this] { return is_ready_unlocked(); });
+    wait_unlocked(lk);
     if (current_state_ == state::has_exception) {
 #if GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
       std::rethrow_exception(exception_);
@@ -507,6 +715,19 @@ class future_shared_state<void> final : private future_shared_state_base {
     notify_now(std::move(lk));
   }
 
+  /// Satisfy @p dest with the result of this (satisfied) shared state.
+  void forward_to(future_shared_state& dest) {
+    std::unique_lock<std::mutex> lk(mu_);
+    if (current_state_ == state::has_exception) {
+      auto ex = exception_;
+      lk.unlock();
+      dest.set_exception(std::move(ex));
+      return;
+    }
+    lk.unlock();
+    dest.set_value();
+  }
+
   /**
    * Create a continuation object wrapping the given functor.
    *
@@ -520,13 +741,26 @@ class future_shared_state<void> final : private future_shared_state_base {
    * @tparam F the functor type.
    * @param self the object that will hold the continuation.
    * @param functor the continuation type.
+   * @param resource allocate the continuation and its shared state using this
+   *     resource.
    * @return A shared pointer to the shared state that will store the results
    *     of the continuation.
    */
   template <typename F>
   static std::shared_ptr<
       typename internal::continuation_helper<F, void>::state_t>
-  make_continuation(std::shared_ptr<future_shared_state> self, F&& functor);
+  make_continuation(std::shared_ptr<future_shared_state> self, F&& functor,
+                    MemoryResource* resource);
+
+  /// Create a continuation using the same resource as @p self.
+  template <typename F>
+  static std::shared_ptr<
+      typename internal::continuation_helper<F, void>::state_t>
+  make_continuation(std::shared_ptr<future_shared_state> self, F&& functor) {
+    auto* resource = self->memory_resource();
+    return make_continuation(std::move(self), std::forward<F>(functor),
+                             resource);
+  }
 
   /**
    * Create a continuation object wrapping the given functor.
@@ -541,6 +775,8 @@ class future_shared_state<void> final : private future_shared_state_base {
    * @tparam F the functor type.
    * @param self the object that will hold the continuation.
    * @param functor the continuation type.
+   * @param resource allocate the continuation and its shared state using this
+   *     resource.
    * @return A shared pointer to the shared state that will store the results
    *     of the continuation.
    */
@@ -548,7 +784,7 @@ class future_shared_state<void> final : private future_shared_state_base {
   static std::shared_ptr<
       typename internal::unwrapping_continuation_helper<F, void>::state_t>
   make_continuation(std::shared_ptr<future_shared_state> self, F&& functor,
-                    std::true_type);
+                    MemoryResource* resource, std::true_type);
 
   /**
    * The implementation details for `promise<void>::get_future()`.
@@ -578,6 +814,74 @@ class future_shared_state<void> final : private future_shared_state_base {
   }
 };
 
+/**
+ * Create a shared state allocated with @p resource.
+ *
+ * The shared state also uses @p resource for any continuations attached to it,
+ * unless the application provides a different resource to `.then()`.
+ */
+template <typename T>
+std::shared_ptr<future_shared_state<T>> make_shared_state(
+    MemoryResource* resource,
+    future_shared_state_base::cancellation_slot cancellation_callback) {
+  return std::allocate_shared<future_shared_state<T>>(
+      MemoryResourceAllocator<future_shared_state<T>>(resource),
+      std::move(cancellation_callback), resource);
+}
+
+/// Create a shared state allocated with @p resource.
+template <typename T>
+std::shared_ptr<future_shared_state<T>> make_shared_state(
+    MemoryResource* resource, std::function<void()> cancellation_callback) {
+  return make_shared_state<T>(resource,
+                              future_shared_state_base::make_cancellation_slot(
+                                  std::move(cancellation_callback)));
+}
+
+/**
+ * A continuation allocated from a `MemoryResource`.
+ *
+ * Continuations are released via `dispose()`, which knows the most derived
+ * type and can therefore return the memory to the right resource, with the
+ * right size.
+ *
+ * @tparam Derived the most derived continuation type.
+ */
+template <typename Derived>
+class resource_continuation : public continuation_base {
+ public:
+  /// Allocate a new `Derived` object using @p resource.
+  template <typename... Args>
+  static std::unique_ptr<Derived, continuation_deleter> make(
+      MemoryResource* resource, Args&&... args) {
+    void* buffer = resource->Allocate(sizeof(Derived), alignof(Derived));
+#if GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+    try {
+      auto* c = new (buffer) Derived(std::forward<Args>(args)...);
+      c->resource_ = resource;
+      return std::unique_ptr<Derived, continuation_deleter>(c);
+    } catch (...) {
+      resource->Deallocate(buffer, sizeof(Derived), alignof(Derived));
+      throw;
+    }
+#else
+    auto* c = new (buffer) Derived(std::forward<Args>(args)...);
+    c->resource_ = resource;
+    return std::unique_ptr<Derived, continuation_deleter>(c);
+#endif  // GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+  }
+
+  void dispose() override {
+    auto* resource = resource_;
+    auto* self = static_cast<Derived*>(this);
+    self->~Derived();
+    resource->Deallocate(self, sizeof(Derived), alignof(Derived));
+  }
+
+ private:
+  MemoryResource* resource_ = nullptr;
+};
+
 /**
  * Calls a functor passing `future<T>` as an argument and stores the results in
  * a `future_shared_state<R>`.
@@ -662,22 +966,20 @@ void continuation_execute_delegate(
  *   `is_invocable<Functor, future_shared_state<R>>` requirement.
  */
 template <typename Functor, typename R>
-struct continuation : public continuation_base {
+struct continuation
+    : public resource_continuation<continuation<Functor, R>> {
   using result_t = typename continuation_helper<Functor, R>::result_t;
   using input_shared_state_t = future_shared_state<R>;
   using output_shared_state_t = future_shared_state<result_t>;
   using requires_unwrap_t =
       typename continuation_helper<Functor, R>::requires_unwrap_t;
 
-  continuation(Functor&& f, std::shared_ptr<input_shared_state_t> s)
+  continuation(Functor&& f, std::shared_ptr<input_shared_state_t> s,
+               MemoryResource* resource = DefaultMemoryResource())
       : functor(std::move(f)),
         input(std::move(s)),
-        output(std::make_shared<future_shared_state<result_t>>(
-            input.lock()->release_cancellation_callback())) {}
-
-  continuation(Functor&& f, std::shared_ptr<input_shared_state_t> s,
-               std::shared_ptr<output_shared_state_t> o)
-      : functor(std::move(f)), input(std::move(s)), output(std::move(o)) {}
+        output(make_shared_state<result_t>(
+            resource, input.lock()->release_cancellation_callback())) {}
 
   void execute() override {
     auto tmp = input.lock();
@@ -718,20 +1020,35 @@ struct continuation : public continuation_base {
  *   `is_invocable<Functor, future_shared_state<R>>` requirement.
  */
 template <typename Functor, typename T>
-struct unwrapping_continuation : public continuation_base {
+struct unwrapping_continuation
+    : public resource_continuation<unwrapping_continuation<Functor, T>> {
   using R = typename unwrapping_continuation_helper<Functor, T>::result_t;
   using input_shared_state_t = future_shared_state<T>;
   using output_shared_state_t = future_shared_state<R>;
   using intermediate_shared_state_t = future_shared_state<R>;
 
-  unwrapping_continuation(Functor&& f, std::shared_ptr<input_shared_state_t> s)
+  unwrapping_continuation(Functor&& f, std::shared_ptr<input_shared_state_t> s,
+                          MemoryResource* resource)
       : functor(std::move(f)),
         input(std::move(s)),
-        intermediate(),
-        output(std::make_shared<output_shared_state_t>(
-            input.lock()->release_cancellation_callback())) {}
+        output(make_shared_state<R>(
+            resource, input.lock()->release_cancellation_callback())) {}
 
   void execute() override {
+    if (forwarding) {
+      // The future returned by `functor` is satisfied, transfer its result
+      // directly into `output`.
+      auto source = intermediate.lock();
+      if (!source) {
+        output->set_exception(std::make_exception_ptr(
+            std::future_error(std::future_errc::no_state)));
+        return;
+      }
+      source->forward_to(*output);
+      output.reset();
+      return;
+    }
+
     auto tmp = input.lock();
     if (!tmp) {
       output->set_exception(std::make_exception_ptr(
@@ -740,34 +1057,46 @@ struct unwrapping_continuation : public continuation_base {
     }
     // The transfer of the state depends on the types involved, delegate to
     // some helper functions.
+    std::shared_ptr<intermediate_shared_state_t> next;
 #if GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
     try {
-      intermediate = functor(std::move(tmp));
+      next = functor(std::move(tmp));
     } catch (...) {
       output->set_exception(std::current_exception());
       return;
     }
 #else
-    intermediate = functor(std::move(tmp));
+    next = functor(std::move(tmp));
 #endif  // GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
 
-    if (!intermediate) {
+    if (!next) {
       output->set_exception(std::make_exception_ptr(
           std::future_error(std::future_errc::broken_promise)));
       return;
     }
+    // From now on, cancelling `output` cancels the future returned by
+    // `functor`.
+    std::weak_ptr<intermediate_shared_state_t> w = next;
+    output->set_cancellation_callback([w] {
+      if (auto s = w.lock()) s->cancel();
+    });
+    intermediate = next;
+    pending = std::move(next);
+    forwarding = true;
+  }
 
-    auto unwrapper = [](std::shared_ptr<intermediate_shared_state_t> r) {
-      return r->get();
-    };
-    using continuation_type = internal::continuation<decltype(unwrapper), R>;
-    auto continuation = google::cloud::internal::make_unique<continuation_type>(
-        std::move(unwrapper), intermediate, output);
-    // assert(intermediate->continuation_ == nullptr)
-    // If intermediate has a continuation then the associated future would have
-    // been invalid, and we never get here.
-    intermediate->set_continuation(
-        std::unique_ptr<continuation_base>(std::move(continuation)));
+  void execute_and_dispose() override {
+    continuation_ptr self(this);
+    this->execute();
+    if (!pending) return;
+    // Reuse this object as the continuation for the future returned by
+    // `functor`. This avoids allocating a new continuation, and avoids an
+    // additional hop through `get()` when the result is available.
+    // assert(next->continuation_ == nullptr)
+    // If `next` had a continuation then the associated future would have been
+    // invalid, and we never get here.
+    auto next = std::move(pending);
+    next->set_continuation(std::move(self));
   }
 
   /// The functor called when `input` is satisfied.
@@ -776,11 +1105,22 @@ struct unwrapping_continuation : public continuation_base {
   /// The shared state that must be satisfied before calling `functor`.
   std::weak_ptr<input_shared_state_t> input;
 
-  /// The shared state that will hold the results of calling `functor`.
-  std::shared_ptr<output_shared_state_t> intermediate;
+  /**
+   * The shared state returned by `functor`.
+   *
+   * This object is the continuation for this shared state, and thus owned by
+   * it. A `std::weak_ptr<>` avoids a cycle.
+   */
+  std::weak_ptr<intermediate_shared_state_t> intermediate;
+
+  /// Keeps `intermediate` alive until this object becomes its continuation.
+  std::shared_ptr<intermediate_shared_state_t> pending;
 
-  /// The shared state that will hold the unwrapped of calling `functor`.
+  /// The shared state that will hold the unwrapped result of `functor`.
   std::shared_ptr<output_shared_state_t> output;
+
+  /// Set when `functor` has been called, and the continuation is forwarding.
+  bool forwarding = false;
 };
 
 // Implement the helper function to create a shared state for continuations.
@@ -788,13 +1128,13 @@ template <typename T>
 template <typename F>
 std::shared_ptr<typename internal::continuation_helper<F, T>::state_t>
 future_shared_state<T>::make_continuation(
-    std::shared_ptr<future_shared_state<T>> self, F&& functor) {
+    std::shared_ptr<future_shared_state<T>> self, F&& functor,
+    MemoryResource* resource) {
   using continuation_type = internal::continuation<F, T>;
-  auto continuation = google::cloud::internal::make_unique<continuation_type>(
-      std::forward<F>(functor), self);
+  auto continuation = continuation_type::make(
+      resource, std::forward<F>(functor), self, resource);
   auto result = continuation->output;
-  self->set_continuation(
-      std::unique_ptr<continuation_base>(std::move(continuation)));
+  self->set_continuation(continuation_ptr(continuation.release()));
   return result;
 }
 
@@ -804,7 +1144,8 @@ template <typename F>
 std::shared_ptr<
     typename internal::unwrapping_continuation_helper<F, T>::state_t>
 future_shared_state<T>::make_continuation(
-    std::shared_ptr<future_shared_state<T>> self, F&& functor, std::true_type) {
+    std::shared_ptr<future_shared_state<T>> self, F&& functor,
+    MemoryResource* resource, std::true_type) {
   // This is the unwrapped result type.
   using R = typename internal::unwrapping_continuation_helper<F, T>::result_t;
   // The type continuation that executes `F` on `self`:
@@ -812,13 +1153,12 @@ future_shared_state<T>::make_continuation(
 
   // First create a continuation that calls the functor, and stores the result
   // in a `future_shared_state<future_shared_state<R>>`
-  auto continuation = google::cloud::internal::make_unique<continuation_type>(
-      std::forward<F>(functor), self);
+  auto continuation = continuation_type::make(
+      resource, std::forward<F>(functor), self, resource);
   // Save the value of `continuation->output`, because the move will make it
   // inaccessible.
   std::shared_ptr<future_shared_state<R>> result = continuation->output;
-  self->set_continuation(
-      std::unique_ptr<continuation_base>(std::move(continuation)));
+  self->set_continuation(continuation_ptr(continuation.release()));
   return result;
 }
 
@@ -826,15 +1166,15 @@ future_shared_state<T>::make_continuation(
 template <typename F>
 std::shared_ptr<typename internal::continuation_helper<F, void>::state_t>
 future_shared_state<void>::make_continuation(
-    std::shared_ptr<future_shared_state<void>> self, F&& functor) {
+    std::shared_ptr<future_shared_state<void>> self, F&& functor,
+    MemoryResource* resource) {
   using continuation_type = internal::continuation<F, void>;
-  auto continuation = google::cloud::internal::make_unique<continuation_type>(
-      std::forward<F>(functor), self);
+  auto continuation = continuation_type::make(
+      resource, std::forward<F>(functor), self, resource);
   // Save the value of `continuation->output`, because the move will make it
   // inaccessible.
   auto result = continuation->output;
-  self->set_continuation(
-      std::unique_ptr<continuation_base>(std::move(continuation)));
+  self->set_continuation(continuation_ptr(continuation.release()));
   return result;
 }
 
@@ -845,7 +1185,7 @@ std::shared_ptr<
     typename internal::unwrapping_continuation_helper<F, void>::state_t>
 future_shared_state<void>::make_continuation(
     std::shared_ptr<future_shared_state<void>> self, F&& functor,
-    std::true_type) {
+    MemoryResource* resource, std::true_type) {
   // This is the unwrapped result type.
   using R =
       typename internal::unwrapping_continuation_helper<F, void>::result_t;
@@ -854,13 +1194,12 @@ future_shared_state<void>::make_continuation(
 
   // First create a continuation that calls the functor, and stores the result
   // in a `future_shared_state<future_shared_state<R>>`
-  auto continuation = google::cloud::internal::make_unique<continuation_type>(
-      std::forward<F>(functor), self);
+  auto continuation = continuation_type::make(
+      resource, std::forward<F>(functor), self, resource);
   // Save the value of `continuation->output`, because the move will make it
   // inaccessible.
   std::shared_ptr<future_shared_state<R>> result = continuation->output;
-  self->set_continuation(
-      std::unique_ptr<continuation_base>(std::move(continuation)));
+  self->set_continuation(continuation_ptr(continuation.release()));
   return result;
 }
 
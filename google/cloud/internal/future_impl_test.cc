@@ -108,6 +108,45 @@ TEST(FutureImplBaseTest, AbandonReady) {
   EXPECT_TRUE(shared_state.is_ready());
 }
 
+TEST(FutureImplBaseTest, Footprint) {
+  // A mutex, the exception, and 5 pointer-sized members, which include all the
+  // flags. The condition variable and cancellation callback are out of line.
+  auto constexpr kExpectedMax =
+      sizeof(std::mutex) + sizeof(std::exception_ptr) + 5 * sizeof(void*);
+  EXPECT_GE(kExpectedMax, sizeof(future_shared_state_base));
+  EXPECT_GE(kExpectedMax, sizeof(future_shared_state<void>));
+}
+
+TEST(FutureImplBaseTest, CancelWithoutCallback) {
+  future_shared_state_base shared_state;
+  EXPECT_TRUE(shared_state.cancellable());
+  EXPECT_TRUE(shared_state.cancel());
+  EXPECT_FALSE(shared_state.cancellable());
+  EXPECT_FALSE(shared_state.cancel());
+}
+
+TEST(FutureImplBaseTest, CancelCallsCallbackOnce) {
+  int count = 0;
+  future_shared_state_base shared_state([&count] { ++count; });
+  EXPECT_TRUE(shared_state.cancel());
+  EXPECT_FALSE(shared_state.cancel());
+  EXPECT_EQ(1, count);
+}
+
+#if GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+TEST(FutureImplBaseTest, CancelCallbackThrows) {
+  int count = 0;
+  future_shared_state_base shared_state([&count] {
+    if (++count == 1) throw std::runtime_error("cannot cancel");
+  });
+  EXPECT_THROW(shared_state.cancel(), std::runtime_error);
+  // The callback had no effect, the shared state can still be cancelled.
+  EXPECT_TRUE(shared_state.cancellable());
+  EXPECT_TRUE(shared_state.cancel());
+  EXPECT_EQ(2, count);
+}
+#endif  // GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+
 // @test Verify that we can create continuations.
 TEST(ContinuationVoidTest, Constructor) {
   auto functor = [](std::shared_ptr<future_shared_state<void>>) {};
@@ -45,7 +45,7 @@ inline future<T>::future(future<future<T>>&& rhs)
 template <typename T>
 template <typename F>
 typename internal::then_helper<F, T>::future_t future<T>::then_impl(
-    F&& functor, std::false_type) {
+    F&& functor, MemoryResource* resource, std::false_type) {
   // g++-4.9 gets confused about the use of a protected type alias here, so
   // create a non-protected one:
   using local_state_type = typename internal::future_shared_state<T>;
@@ -74,7 +74,7 @@ typename internal::then_helper<F, T>::future_t future<T>::then_impl(
   };
 
   auto output_shared_state = local_state_type::make_continuation(
-      this->shared_state_, adapter(std::forward<F>(functor)));
+      this->shared_state_, adapter(std::forward<F>(functor)), resource);
 
   // Nothing throws after this point, and we have not changed the state if
   // anything did throw.
@@ -85,7 +85,7 @@ typename internal::then_helper<F, T>::future_t future<T>::then_impl(
 template <typename T>
 template <typename F>
 typename internal::then_helper<F, T>::future_t future<T>::then_impl(
-    F&& functor, std::true_type) {
+    F&& functor, MemoryResource* resource, std::true_type) {
   // g++-4.9 gets confused about the use of a protected type alias here, so
   // create a non-protected one:
   using local_state_type = internal::future_shared_state<T>;
@@ -115,7 +115,8 @@ typename internal::then_helper<F, T>::future_t future<T>::then_impl(
   };
 
   auto output_shared_state = local_state_type::make_continuation(
-      this->shared_state_, adapter(std::forward<F>(functor)), std::true_type{});
+      this->shared_state_, adapter(std::forward<F>(functor)), resource,
+      std::true_type{});
 
   // Nothing throws after this point, and we have not changed the state if
   // anything did throw.
@@ -128,7 +129,7 @@ inline future<void>::future(future<future<void>>&& rhs)
 
 template <typename F>
 typename internal::then_helper<F, void>::future_t future<void>::then_impl(
-    F&& functor, std::false_type) {
+    F&& functor, MemoryResource* resource, std::false_type) {
   // g++-4.9 gets confused about the use of a protected type alias here, so
   // create a non-protected one:
   using local_state_type = typename internal::future_shared_state<void>;
@@ -157,7 +158,7 @@ typename internal::then_helper<F, void>::future_t future<void>::then_impl(
   };
 
   auto output_shared_state = shared_state_type::make_continuation(
-      shared_state_, adapter(std::forward<F>(functor)));
+      shared_state_, adapter(std::forward<F>(functor)), resource);
 
   // Nothing throws after this point, and we have not changed the state if
   // anything did throw.
@@ -167,7 +168,7 @@ typename internal::then_helper<F, void>::future_t future<void>::then_impl(
 
 template <typename F>
 typename internal::then_helper<F, void>::future_t future<void>::then_impl(
-    F&& functor, std::true_type) {
+    F&& functor, MemoryResource* resource, std::true_type) {
   // g++-4.9 gets confused about the use of a protected type alias here, so
   // create a non-protected one:
   using local_state_type = internal::future_shared_state<void>;
@@ -197,7 +198,8 @@ typename internal::then_helper<F, void>::future_t future<void>::then_impl(
   };
 
   auto output_shared_state = local_state_type::make_continuation(
-      this->shared_state_, adapter(std::forward<F>(functor)), std::true_type{});
+      this->shared_state_, adapter(std::forward<F>(functor)), resource,
+      std::true_type{});
 
   // Nothing throws after this point, and we have not changed the state if
   // anything did throw.
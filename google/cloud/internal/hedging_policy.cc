@@ -0,0 +1,89 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/internal/hedging_policy.h"
+#include <algorithm>
+#include <cmath>
+
+namespace google {
+namespace cloud {
+inline namespace GOOGLE_CLOUD_CPP_NS {
+namespace internal {
+
+LatencyTracker::LatencyTracker(std::size_t window_size, std::size_t min_samples)
+    : window_size_(std::max<std::size_t>(window_size, 1)),
+      min_samples_(std::max<std::size_t>(
+          std::min(min_samples, window_size_), 1)) {
+  samples_.reserve(window_size_);
+}
+
+void LatencyTracker::Record(std::chrono::microseconds latency) {
+  std::lock_guard<std::mutex> lk(mu_);
+  if (samples_.size() < window_size_) {
+    samples_.push_back(latency);
+    return;
+  }
+  samples_[next_] = latency;
+  next_ = (next_ + 1) % window_size_;
+}
+
+optional<std::chrono::microseconds> LatencyTracker::Percentile(
+    double percentile) const {
+  std::vector<std::chrono::microseconds> samples;
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    if (samples_.size() < min_samples_) return {};
+    samples = samples_;
+  }
+  auto const n = static_cast<double>(samples.size());
+  auto index = static_cast<std::size_t>(std::ceil(percentile * n));
+  index = std::min(std::max<std::size_t>(index, 1), samples.size()) - 1;
+  std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+  return samples[index];
+}
+
+HedgingPolicy& HedgingPolicy::set_latency_tracker(
+    std::shared_ptr<LatencyTracker> tracker, double percentile) {
+  if (percentile <= 0.0 || percentile > 1.0) {
+    google::cloud::internal::ThrowInvalidArgument(
+        "percentile must be in (0.0, 1.0]");
+  }
+  tracker_ = std::move(tracker);
+  percentile_ = percentile;
+  return *this;
+}
+
+HedgingPolicy& HedgingPolicy::set_budget(std::shared_ptr<RetryBudget> budget) {
+  budget_ = std::move(budget);
+  return *this;
+}
+
+std::chrono::microseconds HedgingPolicy::hedging_delay() const {
+  if (!tracker_) return hedging_delay_;
+  auto delay = tracker_->Percentile(percentile_);
+  if (!delay) return hedging_delay_;
+  return *delay;
+}
+
+bool HedgingPolicy::OnHedge() { return !budget_ || budget_->TryRetry(); }
+
+void HedgingPolicy::OnSuccess(std::chrono::microseconds latency) {
+  if (tracker_) tracker_->Record(latency);
+  if (budget_) budget_->OnSuccess();
+}
+
+}  // namespace internal
+}  // namespace GOOGLE_CLOUD_CPP_NS
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,159 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_INTERNAL_HEDGING_POLICY_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_INTERNAL_HEDGING_POLICY_H
+
+#include "google/cloud/internal/throw_delegate.h"
+#include "google/cloud/optional.h"
+#include "google/cloud/retry_budget.h"
+#include "google/cloud/version.h"
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace google {
+namespace cloud {
+inline namespace GOOGLE_CLOUD_CPP_NS {
+namespace internal {
+
+/**
+ * Keep track of the latency for recent requests.
+ *
+ * The tracker keeps a fixed-size window with the most recent samples, and
+ * computes percentiles over that window. It is typically shared by all the
+ * requests for the same RPC. This class is thread-safe.
+ */
+class LatencyTracker {
+ public:
+  /**
+   * Create a tracker.
+   *
+   * @param window_size the number of samples kept by the tracker.
+   * @param min_samples the number of samples required before `Percentile()`
+   *     returns a value.
+   */
+  explicit LatencyTracker(std::size_t window_size = 128,
+                          std::size_t min_samples = 16);
+
+  /// Record the latency of a successful call.
+  void Record(std::chrono::microseconds latency);
+
+  /**
+   * Return the @p percentile latency (a value in `(0.0, 1.0]`) for the recent
+   * samples.
+   *
+   * Returns an unset optional until the tracker has enough samples.
+   */
+  optional<std::chrono::microseconds> Percentile(double percentile) const;
+
+ private:
+  std::size_t const window_size_;
+  std::size_t const min_samples_;
+  mutable std::mutex mu_;
+  std::vector<std::chrono::microseconds> samples_;
+  std::size_t next_ = 0;
+};
+
+/**
+ * Control how idempotent unary RPCs are hedged.
+ *
+ * A hedged RPC starts a new attempt if the previous attempts have not completed
+ * after a delay, without cancelling them. The first successful attempt wins,
+ * and the other attempts are cancelled. This reduces the tail latency, at the
+ * cost of additional load on the service.
+ *
+ * The delay is fixed, unless the policy has a `LatencyTracker`. In that case
+ * the delay is a percentile of the observed latency (e.g. the p95), using the
+ * fixed delay until the tracker has enough samples.
+ *
+ * The policy can also use a `RetryBudget` to limit the additional load: each
+ * hedged attempt withdraws a token from the budget, and each successful call
+ * deposits into the budget. If the budget is exhausted the call waits for the
+ * attempts in progress.
+ *
+ * Copies of this class share the latency tracker and the budget, if any.
+ */
+class HedgingPolicy {
+ public:
+  /**
+   * Create a policy with a fixed delay.
+   *
+   * @param max_attempts the maximum number of attempts for each call,
+   *     including the initial attempt. It must be at least 1.
+   * @param hedging_delay how long to wait before starting a new attempt.
+   */
+  template <typename Rep, typename Period>
+  HedgingPolicy(int max_attempts,
+                std::chrono::duration<Rep, Period> hedging_delay)
+      : max_attempts_(max_attempts),
+        hedging_delay_(std::chrono::duration_cast<std::chrono::microseconds>(
+            hedging_delay)) {
+    if (max_attempts_ < 1) {
+      google::cloud::internal::ThrowInvalidArgument(
+          "max_attempts must be >= 1");
+    }
+  }
+
+  /**
+   * Use the @p percentile latency observed by @p tracker as the delay.
+   *
+   * @param tracker the latency tracker, successful calls record their latency
+   *     in this tracker.
+   * @param percentile the percentile used as the delay, a value in
+   *     `(0.0, 1.0]`.
+   */
+  HedgingPolicy& set_latency_tracker(std::shared_ptr<LatencyTracker> tracker,
+                                     double percentile = 0.95);
+
+  /// Limit the hedged attempts using @p budget.
+  HedgingPolicy& set_budget(std::shared_ptr<RetryBudget> budget);
+
+  /// The maximum number of attempts for each call.
+  int max_attempts() const { return max_attempts_; }
+
+  /// How long to wait before starting a new attempt.
+  std::chrono::microseconds hedging_delay() const;
+
+  /**
+   * Called before starting a hedged attempt.
+   *
+   * @return true if the budget (if any) allows a new attempt.
+   */
+  bool OnHedge();
+
+  /**
+   * Called when a call succeeds.
+   *
+   * @param latency the latency of the call, measured from the start of its
+   *     first attempt.
+   */
+  void OnSuccess(std::chrono::microseconds latency);
+
+ private:
+  int max_attempts_;
+  std::chrono::microseconds hedging_delay_;
+  std::shared_ptr<LatencyTracker> tracker_;
+  double percentile_ = 0.95;
+  std::shared_ptr<RetryBudget> budget_;
+};
+
+}  // namespace internal
+}  // namespace GOOGLE_CLOUD_CPP_NS
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_INTERNAL_HEDGING_POLICY_H
@@ -0,0 +1,113 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/internal/hedging_policy.h"
+#include <gmock/gmock.h>
+#include <stdexcept>
+
+namespace google {
+namespace cloud {
+inline namespace GOOGLE_CLOUD_CPP_NS {
+namespace internal {
+namespace {
+
+using ms = std::chrono::milliseconds;
+using us = std::chrono::microseconds;
+
+TEST(LatencyTracker, NotEnoughSamples) {
+  LatencyTracker tested(10, 3);
+  EXPECT_FALSE(tested.Percentile(0.5).has_value());
+  tested.Record(ms(1));
+  tested.Record(ms(2));
+  EXPECT_FALSE(tested.Percentile(0.5).has_value());
+  tested.Record(ms(3));
+  EXPECT_TRUE(tested.Percentile(0.5).has_value());
+}
+
+TEST(LatencyTracker, Percentile) {
+  LatencyTracker tested(100, 1);
+  for (int i = 100; i != 0; --i) tested.Record(ms(i));
+  EXPECT_EQ(ms(95), *tested.Percentile(0.95));
+  EXPECT_EQ(ms(50), *tested.Percentile(0.5));
+  EXPECT_EQ(ms(100), *tested.Percentile(1.0));
+  EXPECT_EQ(ms(1), *tested.Percentile(0.001));
+}
+
+TEST(LatencyTracker, KeepsRecentSamples) {
+  LatencyTracker tested(4, 1);
+  for (int i = 0; i != 4; ++i) tested.Record(ms(100));
+  for (int i = 0; i != 4; ++i) tested.Record(ms(10));
+  EXPECT_EQ(ms(10), *tested.Percentile(1.0));
+}
+
+TEST(HedgingPolicy, FixedDelay) {
+  HedgingPolicy tested(3, ms(20));
+  EXPECT_EQ(3, tested.max_attempts());
+  EXPECT_EQ(ms(20), tested.hedging_delay());
+  EXPECT_TRUE(tested.OnHedge());
+  tested.OnSuccess(ms(5));
+  EXPECT_EQ(ms(20), tested.hedging_delay());
+}
+
+TEST(HedgingPolicy, AdaptiveDelay) {
+  auto tracker = std::make_shared<LatencyTracker>(16, 4);
+  HedgingPolicy tested(2, ms(20));
+  tested.set_latency_tracker(tracker, 0.75);
+  // Use the fixed delay until the tracker has enough samples.
+  tested.OnSuccess(ms(1));
+  tested.OnSuccess(ms(2));
+  tested.OnSuccess(ms(3));
+  EXPECT_EQ(ms(20), tested.hedging_delay());
+  tested.OnSuccess(ms(4));
+  EXPECT_EQ(ms(3), tested.hedging_delay());
+
+  // Copies share the tracker.
+  auto copy = tested;
+  copy.OnSuccess(us(4500));
+  EXPECT_EQ(ms(4), tested.hedging_delay());
+}
+
+TEST(HedgingPolicy, Budget) {
+  auto budget = std::make_shared<RetryBudget>(1.0, 0.5);
+  HedgingPolicy tested(3, ms(20));
+  tested.set_budget(budget);
+  EXPECT_TRUE(tested.OnHedge());
+  EXPECT_FALSE(tested.OnHedge());
+  tested.OnSuccess(ms(1));
+  tested.OnSuccess(ms(1));
+  EXPECT_TRUE(tested.OnHedge());
+
+  auto const counters = budget->counters();
+  EXPECT_EQ(2, counters.successes);
+  EXPECT_EQ(2, counters.retries_allowed);
+  EXPECT_EQ(1, counters.retries_denied);
+}
+
+TEST(HedgingPolicy, ValidateParameters) {
+#if GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+  EXPECT_THROW(HedgingPolicy(0, ms(10)), std::invalid_argument);
+  HedgingPolicy tested(2, ms(10));
+  EXPECT_THROW(tested.set_latency_tracker({}, 0.0), std::invalid_argument);
+  EXPECT_THROW(tested.set_latency_tracker({}, 1.5), std::invalid_argument);
+#else
+  EXPECT_DEATH_IF_SUPPORTED(HedgingPolicy(0, ms(10)),
+                            "exceptions are disabled");
+#endif  // GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace GOOGLE_CLOUD_CPP_NS
+}  // namespace cloud
+}  // namespace google
@@ -19,8 +19,11 @@
 #include "google/cloud/version.h"
 #include <google/protobuf/util/message_differencer.h>
 #include <functional>
+#include <future>
 #include <iterator>
 #include <string>
+#include <system_error>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -113,6 +116,19 @@ class PaginationIterator {
  * token returns the next "page". We want to expose these APIs as input ranges
  * in the C++ client libraries. This class performs that work.
  *
+ * Optionally, the range can prefetch the next page: as soon as a page is
+ * received, a background thread starts loading the next one, while the
+ * application consumes the items in the current page. This hides the latency
+ * of the `List*()` RPC when iterating over large collections. The iteration
+ * and error semantics are the same, with or without prefetching.
+ *
+ * Each prefetch runs in a new thread, created with `std::async()`, so every
+ * page (after the first) costs a thread creation. This is small compared to
+ * the latency of a `List*()` RPC, but prefetching is not a good fit for
+ * collections with many small pages. If the thread cannot be created the
+ * range loads the page synchronously. Copies of a range share any pending
+ * prefetch.
+ *
  * @tparam T the type of the items, typically a proto describing the resources
  * @tparam Request the type of the request object for the `List` RPC.
  * @tparam Response the type of the response object for the `List` RPC.
@@ -128,14 +144,20 @@ class PaginationRange {
    * @param loader makes the RPC request to fetch a new page of items.
    * @param get_items extracts the items from the response using native C++
    *     types (as opposed to the proto types used in `Response`).
+   * @param prefetch if true, start loading the next page (if any) in a
+   *     background thread as soon as a page is received. @p loader must be
+   *     safe to call from a different thread. At most one page is prefetched.
+   *     Destroying the range blocks until any pending prefetch completes.
    */
   PaginationRange(Request request,
                   std::function<StatusOr<Response>(Request const& r)> loader,
-                  std::function<std::vector<T>(Response r)> get_items)
+                  std::function<std::vector<T>(Response r)> get_items,
+                  bool prefetch = false)
       : request_(std::move(request)),
         next_page_loader_(std::move(loader)),
         get_items_(std::move(get_items)),
-        on_last_page_(false) {
+        on_last_page_(false),
+        prefetch_(prefetch) {
     current_ = current_page_.begin();
   }
 
@@ -174,8 +196,7 @@ class PaginationRange {
       if (on_last_page_) {
         return iterator(nullptr, kPastTheEndError);
       }
-      request_.set_page_token(std::move(next_page_token_));
-      auto response = next_page_loader_(request_);
+      auto response = LoadNextPage();
       if (!response.ok()) {
         next_page_token_.clear();
         current_page_.clear();
@@ -188,6 +209,8 @@ class PaginationRange {
       current_ = current_page_.begin();
       if (next_page_token_.empty()) {
         on_last_page_ = true;
+      } else if (prefetch_) {
+        StartPrefetch();
       }
       if (current_page_.end() == current_) {
         return iterator(nullptr, kPastTheEndError);
@@ -197,6 +220,39 @@ class PaginationRange {
   }
 
  private:
+  /// Load the next page, or wait for the prefetched page.
+  StatusOr<Response> LoadNextPage() {
+    if (prefetched_page_.valid()) {
+      // Moving leaves `prefetched_page_` empty.
+      auto page = std::move(prefetched_page_);
+      return page.get();
+    }
+    request_.set_page_token(std::move(next_page_token_));
+    return next_page_loader_(request_);
+  }
+
+  /// Start loading the next page in a background thread.
+  void StartPrefetch() {
+    request_.set_page_token(next_page_token_);
+    // The range may be moved while the page loads, so the background thread
+    // uses copies of the loader and request.
+    auto loader = next_page_loader_;
+    auto request = request_;
+    auto load = [loader, request] { return loader(request); };
+#ifdef GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+    try {
+      prefetched_page_ =
+          std::async(std::launch::async, std::move(load)).share();
+    } catch (std::system_error const&) {
+      // Could not create a thread, `LoadNextPage()` loads the page instead.
+      return;
+    }
+#else
+    prefetched_page_ = std::async(std::launch::async, std::move(load)).share();
+#endif  // GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+    next_page_token_.clear();
+  }
+
   Request request_;
   std::function<StatusOr<Response>(Request const& r)> next_page_loader_;
   std::function<std::vector<T>(Response r)> get_items_;
@@ -204,8 +260,201 @@ class PaginationRange {
   typename std::vector<T>::iterator current_;
   std::string next_page_token_;
   bool on_last_page_;
+  bool prefetch_;
+  // Empty unless a prefetch is pending. Unlike `std::future<>` this is
+  // copyable, so is the range.
+  std::shared_future<StatusOr<Response>> prefetched_page_;
+};
+
+/**
+ * A page of items returned by `PaginationPageRange`.
+ *
+ * The items are swapped out of the response when the page is created, so
+ * they are never copied. Use `items()` (or `begin()` and `end()`) to read them
+ * in place, or `TakeItems()` to move them out of the page.
+ *
+ * @tparam Items the container of items, typically a
+ *     `google::protobuf::RepeatedPtrField<T>`.
+ * @tparam Response the type of the response object for the `List` RPC.
+ */
+template <typename Items, typename Response>
+class PaginationPage {
+ public:
+  using const_iterator = typename Items::const_iterator;
+
+  PaginationPage(Items items, Response response)
+      : items_(std::move(items)), response_(std::move(response)) {}
+
+  /// The items in this page.
+  Items const& items() const { return items_; }
+
+  const_iterator begin() const { return items_.begin(); }
+  const_iterator end() const { return items_.end(); }
+  bool empty() const { return items_.empty(); }
+  std::size_t size() const { return static_cast<std::size_t>(items_.size()); }
+
+  /// Move the items out of the page, leaving it empty.
+  Items TakeItems() {
+    Items result;
+    result.Swap(&items_);
+    return result;
+  }
+
+  /// The rest of the response, for example, any `unreachable` locations.
+  Response const& response() const { return response_; }
+
+ private:
+  Items items_;
+  Response response_;
+};
+
+/**
+ * An input iterator for `PaginationPageRange`.
+ */
+template <typename Page, typename Range>
+class PaginationPageIterator {
+ public:
+  //@{
+  /// @name Iterator traits
+  using iterator_category = std::input_iterator_tag;
+  using value_type = StatusOr<Page>;
+  using difference_type = std::ptrdiff_t;
+  using pointer = value_type*;
+  using reference = value_type&;
+  //@}
+
+  PaginationPageIterator() : owner_(nullptr) {}
+
+  PaginationPageIterator& operator++() {
+    *this = owner_->GetNext();
+    return *this;
+  }
+
+  value_type const* operator->() const { return &value_; }
+  value_type* operator->() { return &value_; }
+
+  value_type const& operator*() const& { return value_; }
+  value_type& operator*() & { return value_; }
+#if GOOGLE_CLOUD_CPP_HAVE_CONST_REF_REF
+  value_type const&& operator*() const&& { return std::move(value_); }
+#endif  // GOOGLE_CLOUD_CPP_HAVE_CONST_REF_REF
+  value_type&& operator*() && { return std::move(value_); }
+
+ private:
+  friend Range;
+
+  // This is a single-pass iterator, only the end iterators and the iterators
+  // on the same range are equal.
+  friend bool operator==(PaginationPageIterator const& lhs,
+                         PaginationPageIterator const& rhs) {
+    return lhs.owner_ == rhs.owner_;
+  }
+
+  friend bool operator!=(PaginationPageIterator const& lhs,
+                         PaginationPageIterator const& rhs) {
+    return !(lhs == rhs);
+  }
+
+  PaginationPageIterator(Range* owner, value_type value)
+      : owner_(owner), value_(std::move(value)) {}
+
+  Range* owner_;
+  value_type value_;
 };
 
+/**
+ * Adapt pagination APIs to look like input ranges of pages.
+ *
+ * Like `PaginationRange`, but each element of the range is a page of items.
+ * The items are swapped out of the response's repeated field, instead of
+ * copied into a `std::vector<T>` and then moved into a `StatusOr<T>` one at
+ * a time. Prefer this class for bulk listings.
+ *
+ * The loader and the items accessor are template parameters, use
+ * `MakePaginationPageRange()` to deduce them.
+ *
+ * Every page returned by the service is returned by the range, including
+ * empty pages. An error terminates the iteration, after the error itself.
+ *
+ * @tparam Request the type of the request object for the `List` RPC.
+ * @tparam Response the type of the response object for the `List` RPC.
+ * @tparam Loader makes the RPC request to fetch a new page of items, it must be
+ *     invocable as `StatusOr<Response>(Request const&)`.
+ * @tparam ItemsAccessor returns a pointer to the items in the response, it
+ *     must be invocable as `Items*(Response&)`, typically returning one of
+ *     the `mutable_*()` repeated fields.
+ */
+template <typename Request, typename Response, typename Loader,
+          typename ItemsAccessor>
+class PaginationPageRange {
+ public:
+  using items_type = typename std::remove_pointer<decltype(
+      std::declval<ItemsAccessor&>()(std::declval<Response&>()))>::type;
+  using page_type = PaginationPage<items_type, Response>;
+
+  /// The iterator type for this Range.
+  using iterator = PaginationPageIterator<page_type, PaginationPageRange>;
+
+  /**
+   * Create a new range to paginate over some elements.
+   *
+   * @param request the first request to start the iteration, the library may
+   *    initialize this request with any filtering constraints.
+   * @param loader makes the RPC request to fetch a new page of items.
+   * @param items_accessor returns a pointer to the items in the response.
+   */
+  PaginationPageRange(Request request, Loader loader,
+                      ItemsAccessor items_accessor)
+      : request_(std::move(request)),
+        loader_(std::move(loader)),
+        items_accessor_(std::move(items_accessor)) {}
+
+  /**
+   * Return an iterator over the range of pages.
+   *
+   * The returned iterator is a single-pass input iterator that loads a new
+   * page when incremented.
+   */
+  iterator begin() { return GetNext(); }
+
+  /// Return an iterator pointing to the end of the stream.
+  iterator end() { return iterator{}; }
+
+ private:
+  friend iterator;
+
+  iterator GetNext() {
+    if (on_last_page_) return iterator{};
+    auto response = loader_(request_);
+    if (!response) {
+      on_last_page_ = true;
+      return iterator(this, std::move(response).status());
+    }
+    request_.set_page_token(std::move(*response->mutable_next_page_token()));
+    response->clear_next_page_token();
+    on_last_page_ = request_.page_token().empty();
+    items_type items;
+    items.Swap(items_accessor_(*response));
+    return iterator(this, page_type(std::move(items), *std::move(response)));
+  }
+
+  Request request_;
+  Loader loader_;
+  ItemsAccessor items_accessor_;
+  bool on_last_page_ = false;
+};
+
+/// Create a `PaginationPageRange`, deducing the loader and accessor types.
+template <typename Request, typename Loader, typename ItemsAccessor,
+          typename Response = typename std::decay<decltype(
+              *std::declval<Loader&>()(std::declval<Request const&>()))>::type>
+PaginationPageRange<Request, Response, Loader, ItemsAccessor>
+MakePaginationPageRange(Request request, Loader loader,
+                        ItemsAccessor items_accessor) {
+  return PaginationPageRange<Request, Response, Loader, ItemsAccessor>(
+      std::move(request), std::move(loader), std::move(items_accessor));
+}
+
 }  // namespace internal
 }  // namespace GOOGLE_CLOUD_CPP_NS
 }  // namespace cloud
@@ -13,8 +13,11 @@
 // limitations under the License.
 
 #include "google/cloud/internal/pagination_range.h"
+#include "google/cloud/testing_util/assert_ok.h"
 #include <google/bigtable/admin/v2/bigtable_instance_admin.grpc.pb.h>
 #include <gmock/gmock.h>
+#include <future>
+#include <type_traits>
 
 namespace google {
 namespace cloud {
@@ -178,6 +181,197 @@ TEST(RangeFromPagination, IteratorCoverage) {
   EXPECT_TRUE(i1 == range.end());
 }
 
+TEST(RangeFromPagination, PrefetchTwoPagesWithError) {
+  MockRpc mock;
+  std::promise<void> prefetch_started;
+  EXPECT_CALL(mock, Loader(_))
+      .WillOnce(Invoke([](Request const& request) {
+        EXPECT_TRUE(request.page_token().empty());
+        Response response;
+        response.set_next_page_token("t1");
+        response.add_app_profiles()->set_name("p1");
+        response.add_app_profiles()->set_name("p2");
+        return response;
+      }))
+      .WillOnce(Invoke([&prefetch_started](Request const& request) {
+        EXPECT_EQ("t1", request.page_token());
+        prefetch_started.set_value();
+        Response response;
+        response.set_next_page_token("t2");
+        response.add_app_profiles()->set_name("p3");
+        return response;
+      }))
+      .WillOnce(Invoke([](Request const& request) {
+        EXPECT_EQ("t2", request.page_token());
+        return Status(StatusCode::kAborted, "bad-luck");
+      }));
+
+  TestedRange range(
+      Request{}, [&](Request const& r) { return mock.Loader(r); }, GetItems,
+      /*prefetch=*/true);
+  auto i = range.begin();
+  ASSERT_FALSE(i == range.end());
+  ASSERT_STATUS_OK(*i);
+  EXPECT_EQ("p1", (*i)->name());
+
+  // The second page is requested before the application consumes the first.
+  EXPECT_EQ(std::future_status::ready,
+            prefetch_started.get_future().wait_for(std::chrono::seconds(30)));
+
+  std::vector<std::string> names;
+  for (; i != range.end(); ++i) {
+    auto& p = *i;
+    if (!p) {
+      EXPECT_EQ(StatusCode::kAborted, p.status().code());
+      EXPECT_THAT(p.status().message(), HasSubstr("bad-luck"));
+      break;
+    }
+    names.push_back(p->name());
+  }
+  EXPECT_THAT(names, ElementsAre("p1", "p2", "p3"));
+}
+
+TEST(RangeFromPagination, Copyable) {
+  static_assert(std::is_copy_constructible<TestedRange>::value,
+                "PaginationRange should be copyable");
+  MockRpc mock;
+  EXPECT_CALL(mock, Loader(_)).WillOnce(Invoke([](Request const&) {
+    Response response;
+    response.add_app_profiles()->set_name("p1");
+    return response;
+  }));
+
+  TestedRange range(
+      Request{}, [&](Request const& r) { return mock.Loader(r); }, GetItems);
+  auto copy = range;
+  std::vector<std::string> names;
+  for (auto& p : copy) {
+    if (!p) break;
+    names.push_back(p->name());
+  }
+  EXPECT_THAT(names, ElementsAre("p1"));
+}
+
+TEST(RangeFromPagination, PrefetchStopsOnLastPage) {
+  MockRpc mock;
+  EXPECT_CALL(mock, Loader(_))
+      .WillOnce(Invoke([](Request const& request) {
+        EXPECT_TRUE(request.page_token().empty());
+        Response response;
+        response.set_next_page_token("t1");
+        response.add_app_profiles()->set_name("p1");
+        return response;
+      }))
+      .WillOnce(Invoke([](Request const& request) {
+        EXPECT_EQ("t1", request.page_token());
+        Response response;
+        response.clear_next_page_token();
+        response.add_app_profiles()->set_name("p2");
+        return response;
+      }));
+
+  TestedRange range(
+      Request{}, [&](Request const& r) { return mock.Loader(r); }, GetItems,
+      /*prefetch=*/true);
+  std::vector<std::string> names;
+  for (auto& p : range) {
+    if (!p) break;
+    names.push_back(p->name());
+  }
+  EXPECT_THAT(names, ElementsAre("p1", "p2"));
+}
+
+std::vector<std::string> Names(
+    google::protobuf::RepeatedPtrField<ItemType> const& items) {
+  std::vector<std::string> names;
+  for (auto const& i : items) names.push_back(i.name());
+  return names;
+}
+
+TEST(PaginationPageRange, TwoPagesWithError) {
+  MockRpc mock;
+  ItemType const* first_item = nullptr;
+  EXPECT_CALL(mock, Loader(_))
+      .WillOnce(Invoke([&first_item](Request const& request) {
+        EXPECT_TRUE(request.page_token().empty());
+        Response response;
+        response.set_next_page_token("t1");
+        response.add_app_profiles()->set_name("p1");
+        response.add_app_profiles()->set_name("p2");
+        response.add_failed_locations("l1");
+        first_item = &response.app_profiles(0);
+        return response;
+      }))
+      .WillOnce(Invoke([](Request const& request) {
+        EXPECT_EQ("t1", request.page_token());
+        Response response;
+        response.set_next_page_token("t2");
+        return response;
+      }))
+      .WillOnce(Invoke([](Request const& request) {
+        EXPECT_EQ("t2", request.page_token());
+        return Status(StatusCode::kAborted, "bad-luck");
+      }));
+
+  auto range = MakePaginationPageRange(
+      Request{}, [&](Request const& r) { return mock.Loader(r); },
+      [](Response& r) { return r.mutable_app_profiles(); });
+  auto i = range.begin();
+  ASSERT_FALSE(i == range.end());
+  ASSERT_STATUS_OK(*i);
+  EXPECT_THAT(Names((*i)->items()), ElementsAre("p1", "p2"));
+  EXPECT_EQ(2U, (*i)->size());
+  // The items are not copied out of the response.
+  EXPECT_EQ(first_item, &*(*i)->begin());
+  // The rest of the response is available, without the items.
+  EXPECT_EQ(0, (*i)->response().app_profiles_size());
+  EXPECT_THAT((*i)->response().failed_locations(), ElementsAre("l1"));
+
+  // Empty pages are returned too.
+  ++i;
+  ASSERT_FALSE(i == range.end());
+  ASSERT_STATUS_OK(*i);
+  EXPECT_TRUE((*i)->empty());
+
+  ++i;
+  ASSERT_FALSE(i == range.end());
+  EXPECT_EQ(StatusCode::kAborted, i->status().code());
+  EXPECT_THAT(i->status().message(), HasSubstr("bad-luck"));
+
+  ++i;
+  EXPECT_TRUE(i == range.end());
+}
+
+TEST(PaginationPageRange, TakeItems) {
+  MockRpc mock;
+  EXPECT_CALL(mock, Loader(_))
+      .WillOnce(Invoke([](Request const&) {
+        Response response;
+        response.set_next_page_token("t1");
+        response.add_app_profiles()->set_name("p1");
+        return response;
+      }))
+      .WillOnce(Invoke([](Request const&) {
+        Response response;
+        response.clear_next_page_token();
+        response.add_app_profiles()->set_name("p2");
+        response.add_app_profiles()->set_name("p3");
+        return response;
+      }));
+
+  auto range = MakePaginationPageRange(
+      Request{}, [&](Request const& r) { return mock.Loader(r); },
+      [](Response& r) { return r.mutable_app_profiles(); });
+  google::protobuf::RepeatedPtrField<ItemType> all;
+  for (auto& page : range) {
+    ASSERT_STATUS_OK(page);
+    auto items = page->TakeItems();
+    EXPECT_TRUE(page->empty());
+    for (auto& item : items) *all.Add() = std::move(item);
+  }
+  EXPECT_THAT(Names(all), ElementsAre("p1", "p2", "p3"));
+}
+
 }  // namespace
 }  // namespace internal
 }  // namespace GOOGLE_CLOUD_CPP_NS
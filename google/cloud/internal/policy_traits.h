@@ -0,0 +1,61 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_INTERNAL_POLICY_TRAITS_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_INTERNAL_POLICY_TRAITS_H
+
+#include "google/cloud/version.h"
+#include <memory>
+
+namespace google {
+namespace cloud {
+inline namespace GOOGLE_CLOUD_CPP_NS {
+namespace internal {
+/**
+ * Access a retry or backoff policy held by value or by `std::unique_ptr<>`.
+ *
+ * The retry loops accept a `std::unique_ptr<>` to the virtual interfaces (such
+ * as `RetryPolicy` and `BackoffPolicy`), which requires a `clone()` and a heap
+ * allocation for each request. They also accept the concrete policies (such as
+ * `LimitedErrorCountRetryPolicy` and `ExponentialBackoffPolicy`) by value.
+ * These are stored inline in the retry loop. The concrete policies are
+ * `final`, so the compiler can statically dispatch the calls.
+ *
+ * @tparam Holder the type stored by the retry loop, either the policy or a
+ *     `std::unique_ptr<>` to the policy.
+ */
+template <typename Holder>
+struct PolicyTraits {
+  /// The type of the policy.
+  using type = Holder;
+
+  static type& Get(Holder& p) { return p; }
+  static type const& Get(Holder const& p) { return p; }
+};
+
+/// Specialize `PolicyTraits` for policies held by `std::unique_ptr<>`.
+template <typename Policy>
+struct PolicyTraits<std::unique_ptr<Policy>> {
+  /// The type of the policy.
+  using type = Policy;
+
+  static type& Get(std::unique_ptr<Policy> const& p) { return *p; }
+};
+
+}  // namespace internal
+}  // namespace GOOGLE_CLOUD_CPP_NS
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_INTERNAL_POLICY_TRAITS_H
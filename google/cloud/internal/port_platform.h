@@ -99,6 +99,17 @@
 #else
 #    define GOOGLE_CLOUD_CPP_HAVE_CONST_REF_REF 1
 #endif  // GOOGLE_CLOUD_CPP_HAVE_CONST_REF_REF
+
+// Discover if the compiler and the standard library support C++20 coroutines.
+// Both are needed: some compilers implement the language feature before the
+// library ships a `<coroutine>` header.
+#ifdef GOOGLE_CLOUD_CPP_HAVE_COROUTINES
+#  error "GOOGLE_CLOUD_CPP_HAVE_COROUTINES should not be set directly."
+#elif defined(__cpp_impl_coroutine) && defined(__has_include)
+#  if __cpp_impl_coroutine >= 201902L && __has_include(<coroutine>)
+#    define GOOGLE_CLOUD_CPP_HAVE_COROUTINES 1
+#  endif  // __cpp_impl_coroutine >= 201902L && __has_include(<coroutine>)
+#endif  // GOOGLE_CLOUD_CPP_HAVE_COROUTINES
 // clang-format on
 
 #endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_INTERNAL_PORT_PLATFORM_H
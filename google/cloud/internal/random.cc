@@ -80,6 +80,31 @@ std::vector<unsigned int> FetchEntropy(std::size_t desired_bits) {
   return entropy;
 }
 
+FastPRNG::FastPRNG(std::uint64_t seed) {
+  for (auto& s : state_) {
+    // The authors of xoshiro256++ recommend SplitMix64 to initialize the
+    // state. It makes an all-zero state, which the generator cannot leave,
+    // practically impossible.
+    seed += 0x9e3779b97f4a7c15ULL;
+    auto z = seed;
+    z = (z ^ (z >> 30U)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27U)) * 0x94d049bb133111ebULL;
+    s = z ^ (z >> 31U);
+  }
+}
+
+FastPRNG& ThreadLocalFastPRNG() {
+  static thread_local FastPRNG generator([] {
+    std::uint64_t seed = 0;
+    for (auto v : FetchEntropy(std::numeric_limits<std::uint64_t>::digits)) {
+      // Mix each word into the seed, `unsigned int` may be as wide as `seed`.
+      seed = (seed * 0x100000001b3ULL) ^ v;
+    }
+    return seed;
+  }());
+  return generator;
+}
+
 std::string Sample(DefaultPRNG& gen, int n, std::string const& population) {
   std::uniform_int_distribution<std::size_t> rd(0, population.size() - 1);
 
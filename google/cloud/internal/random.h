@@ -16,7 +16,11 @@
 #define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_INTERNAL_RANDOM_H
 
 #include "google/cloud/version.h"
+#include <cstdint>
+#include <limits>
 #include <random>
+#include <string>
+#include <vector>
 
 namespace google {
 namespace cloud {
@@ -56,6 +60,60 @@ Generator MakePRNG() {
 /// Create a new PRNG.
 inline DefaultPRNG MakeDefaultPRNG() { return MakePRNG<DefaultPRNG>(); }
 
+/**
+ * A small and fast PRNG, using the xoshiro256++ algorithm.
+ *
+ * `DefaultPRNG` has 2.5KiB of state, and fully seeding it reads about 20,000
+ * bits from `std::random_device`. That is too expensive for code that only
+ * needs a few random numbers, such as the jitter in backoff policies. This
+ * generator has 32 bytes of state and is seeded from a single 64-bit value.
+ *
+ * This satisfies the `UniformRandomBitGenerator` requirements, so it can be
+ * used with the distributions in `<random>`. It is not suitable for
+ * cryptographic purposes.
+ *
+ * @see http://prng.di.unimi.it/ for a description of the algorithm.
+ */
+class FastPRNG {
+ public:
+  using result_type = std::uint64_t;
+
+  /// Initialize the state from @p seed, using the SplitMix64 generator.
+  explicit FastPRNG(std::uint64_t seed);
+
+  static constexpr result_type min() { return 0; }
+  static constexpr result_type max() {
+    return std::numeric_limits<result_type>::max();
+  }
+
+  result_type operator()() {
+    auto const result = Rotl(state_[0] + state_[3], 23) + state_[0];
+    auto const t = state_[1] << 17U;
+    state_[2] ^= state_[0];
+    state_[3] ^= state_[1];
+    state_[1] ^= state_[2];
+    state_[0] ^= state_[3];
+    state_[2] ^= t;
+    state_[3] = Rotl(state_[3], 45);
+    return result;
+  }
+
+ private:
+  static std::uint64_t Rotl(std::uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+  }
+
+  std::uint64_t state_[4];
+};
+
+/**
+ * Return a `FastPRNG` for the calling thread.
+ *
+ * The generator is seeded, with a single read from `std::random_device`, the
+ * first time each thread calls this function.
+ */
+FastPRNG& ThreadLocalFastPRNG();
+
 /**
  * Take @p n samples out of @p population, using the @p gen PRNG.
  *
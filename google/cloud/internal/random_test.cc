@@ -14,6 +14,8 @@
 
 #include "google/cloud/internal/random.h"
 #include <gmock/gmock.h>
+#include <algorithm>
+#include <cstdint>
 #include <future>
 #include <vector>
 
@@ -32,6 +34,53 @@ TEST(Random, Basic) {
   EXPECT_NE(s0, s1);
 }
 
+TEST(Random, FastPRNG) {
+  // The same seed produces the same sequence, different seeds produce
+  // different sequences.
+  FastPRNG g0(42);
+  FastPRNG g1(42);
+  FastPRNG g2(43);
+  std::vector<FastPRNG::result_type> s0(16);
+  std::vector<FastPRNG::result_type> s1(16);
+  std::vector<FastPRNG::result_type> s2(16);
+  std::generate(s0.begin(), s0.end(), g0);
+  std::generate(s1.begin(), s1.end(), g1);
+  std::generate(s2.begin(), s2.end(), g2);
+  EXPECT_EQ(s0, s1);
+  EXPECT_NE(s0, s2);
+
+  // A zero seed must not produce a degenerate sequence.
+  FastPRNG zero(0);
+  EXPECT_NE(zero(), zero());
+}
+
+TEST(Random, FastPRNGKnownAnswer) {
+  // The expected values come from the reference implementations of
+  // SplitMix64 and xoshiro256++ (https://prng.di.unimi.it/), seeding the
+  // xoshiro256++ state with the first four SplitMix64 outputs for a zero seed.
+  std::vector<FastPRNG::result_type> const expected{
+      0x53175d61490b23dfULL, 0x61da6f3dc380d507ULL, 0x5c0fdf91ec9a7bfcULL,
+      0x02eebf8c3bbe5e1aULL, 0x7eca04ebaf4a5eeaULL, 0x0543c37757f08d9aULL,
+  };
+  FastPRNG g(0);
+  std::vector<FastPRNG::result_type> actual(expected.size());
+  std::generate(actual.begin(), actual.end(), g);
+  EXPECT_EQ(expected, actual);
+}
+
+TEST(Random, ThreadLocalFastPRNG) {
+  // Each thread has its own generator, seeded independently.
+  auto sample = [] {
+    std::uniform_int_distribution<std::uint64_t> d;
+    return d(ThreadLocalFastPRNG());
+  };
+  auto const s0 = std::async(std::launch::async, sample).get();
+  auto const s1 = std::async(std::launch::async, sample).get();
+  EXPECT_NE(s0, s1);
+  // The generator is reused within a thread.
+  EXPECT_EQ(&ThreadLocalFastPRNG(), &ThreadLocalFastPRNG());
+}
+
 #if GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
 /**
  * @test verify that multiple threads can call MakeDefaultPRNG() simultaneously.
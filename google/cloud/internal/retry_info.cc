@@ -0,0 +1,51 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/internal/retry_info.h"
+#include <google/rpc/error_details.pb.h>
+#include <google/rpc/status.pb.h>
+#include <limits>
+
+namespace google {
+namespace cloud {
+inline namespace GOOGLE_CLOUD_CPP_NS {
+namespace internal {
+
+optional<std::chrono::microseconds> RetryInfoDelay(Status const& status) {
+  if (status.error_details().empty()) return {};
+  google::rpc::Status proto;
+  if (!proto.ParseFromString(status.error_details())) return {};
+  for (auto const& any : proto.details()) {
+    if (!any.Is<google::rpc::RetryInfo>()) continue;
+    google::rpc::RetryInfo info;
+    if (!any.UnpackTo(&info) || !info.has_retry_delay()) continue;
+    auto const& delay = info.retry_delay();
+    using std::chrono::microseconds;
+    // Saturate instead of overflowing, the policy bounds the result anyway.
+    auto constexpr kMaxSeconds =
+        std::numeric_limits<microseconds::rep>::max() / 1000000 - 1;
+    if (delay.seconds() < 0 || delay.nanos() < 0) return microseconds(0);
+    if (delay.seconds() > kMaxSeconds) return microseconds::max();
+    // Convert each field on its own, `nanoseconds` overflows much sooner.
+    return microseconds(delay.seconds() * 1000000) +
+           std::chrono::duration_cast<microseconds>(
+               std::chrono::nanoseconds(delay.nanos()));
+  }
+  return {};
+}
+
+}  // namespace internal
+}  // namespace GOOGLE_CLOUD_CPP_NS
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,61 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_INTERNAL_RETRY_INFO_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_INTERNAL_RETRY_INFO_H
+
+#include "google/cloud/internal/backoff_policy.h"
+#include "google/cloud/optional.h"
+#include "google/cloud/status.h"
+#include "google/cloud/version.h"
+#include <chrono>
+
+namespace google {
+namespace cloud {
+inline namespace GOOGLE_CLOUD_CPP_NS {
+namespace internal {
+
+/**
+ * Returns the delay requested by the service in a `google.rpc.RetryInfo`.
+ *
+ * The error details in @p status are parsed on each call, this is only
+ * intended for the (relatively rare) error paths. Returns an unset optional if
+ * the status has no details, the details cannot be parsed, or they do not
+ * contain a `google.rpc.RetryInfo` with a delay.
+ */
+optional<std::chrono::microseconds> RetryInfoDelay(Status const& status);
+
+/**
+ * Returns how long to wait before retrying a request that failed with
+ * @p status.
+ *
+ * If the service requested a delay, this delay is used, bounded by the limits
+ * in @p policy. Otherwise the delay is computed by @p policy.
+ *
+ * @tparam Policy a `BackoffPolicy`, or a concrete policy type, in which case
+ *     the calls are statically dispatched.
+ */
+template <typename Policy>
+std::chrono::microseconds BackoffDelay(Policy& policy, Status const& status) {
+  auto server_delay = RetryInfoDelay(status);
+  if (!server_delay) return policy.OnCompletion();
+  return policy.OnServerDelay(*server_delay);
+}
+
+}  // namespace internal
+}  // namespace GOOGLE_CLOUD_CPP_NS
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_INTERNAL_RETRY_INFO_H
@@ -0,0 +1,115 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/internal/retry_info.h"
+#include "google/cloud/grpc_error_delegate.h"
+#include <google/rpc/error_details.pb.h>
+#include <gmock/gmock.h>
+#include <limits>
+
+namespace google {
+namespace cloud {
+inline namespace GOOGLE_CLOUD_CPP_NS {
+namespace internal {
+namespace {
+
+using ms = std::chrono::milliseconds;
+using us = std::chrono::microseconds;
+
+Status MakeStatusWithRetryDelay(std::int64_t seconds, std::int32_t nanos) {
+  google::rpc::RetryInfo info;
+  info.mutable_retry_delay()->set_seconds(seconds);
+  info.mutable_retry_delay()->set_nanos(nanos);
+  google::rpc::Status proto;
+  proto.set_code(grpc::StatusCode::UNAVAILABLE);
+  proto.set_message("try-again");
+  // Include other details to verify they are skipped.
+  google::rpc::Status other;
+  other.set_message("some other detail");
+  proto.add_details()->PackFrom(other);
+  proto.add_details()->PackFrom(info);
+  return MakeStatusFromRpcError(proto);
+}
+
+TEST(RetryInfoDelay, NoDetails) {
+  EXPECT_FALSE(RetryInfoDelay(Status()));
+  EXPECT_FALSE(RetryInfoDelay(Status(StatusCode::kUnavailable, "try-again")));
+  EXPECT_FALSE(RetryInfoDelay(
+      Status(StatusCode::kUnavailable, "try-again", "not-a-proto")));
+}
+
+TEST(RetryInfoDelay, NoRetryInfo) {
+  google::rpc::Status proto;
+  proto.set_code(grpc::StatusCode::UNAVAILABLE);
+  proto.set_message("try-again");
+  google::rpc::Status other;
+  other.set_message("some other detail");
+  proto.add_details()->PackFrom(other);
+  EXPECT_FALSE(RetryInfoDelay(MakeStatusFromRpcError(proto)));
+}
+
+TEST(RetryInfoDelay, FromProto) {
+  auto delay = RetryInfoDelay(MakeStatusWithRetryDelay(2, 500000000));
+  ASSERT_TRUE(delay.has_value());
+  EXPECT_EQ(ms(2500), *delay);
+}
+
+TEST(RetryInfoDelay, FromGrpcStatus) {
+  auto const details = MakeStatusWithRetryDelay(1, 0).error_details();
+  grpc::Status status(grpc::StatusCode::UNAVAILABLE, "try-again", details);
+  auto delay = RetryInfoDelay(MakeStatusFromRpcError(status));
+  ASSERT_TRUE(delay.has_value());
+  EXPECT_EQ(ms(1000), *delay);
+}
+
+TEST(RetryInfoDelay, Saturates) {
+  auto delay = RetryInfoDelay(MakeStatusWithRetryDelay(-1, 0));
+  ASSERT_TRUE(delay.has_value());
+  EXPECT_EQ(us(0), *delay);
+
+  delay = RetryInfoDelay(
+      MakeStatusWithRetryDelay(std::numeric_limits<std::int64_t>::max(), 0));
+  ASSERT_TRUE(delay.has_value());
+  EXPECT_EQ(us::max(), *delay);
+}
+
+TEST(RetryInfoDelay, BeyondNanosecondsRange) {
+  // Too large for `std::chrono::nanoseconds`, but fits in microseconds.
+  auto const delay =
+      RetryInfoDelay(MakeStatusWithRetryDelay(100000000000, 500000000));
+  ASSERT_TRUE(delay.has_value());
+  EXPECT_EQ(std::chrono::seconds(100000000000) + us(500000), *delay);
+}
+
+TEST(BackoffDelay, UsesServerDelay) {
+  ExponentialBackoffPolicy policy(ms(10), ms(5000), 2.0);
+  EXPECT_EQ(ms(2500),
+            BackoffDelay(policy, MakeStatusWithRetryDelay(2, 500000000)));
+  // The server delay is bounded by the policy.
+  EXPECT_EQ(ms(5000), BackoffDelay(policy, MakeStatusWithRetryDelay(60, 0)));
+}
+
+TEST(BackoffDelay, UsesPolicyWithoutServerDelay) {
+  ExponentialBackoffPolicy policy(ms(10), ms(5000), 2.0);
+  auto delay =
+      BackoffDelay(policy, Status(StatusCode::kUnavailable, "try-again"));
+  EXPECT_LE(ms(10), delay);
+  EXPECT_GE(ms(20), delay);
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace GOOGLE_CLOUD_CPP_NS
+}  // namespace cloud
+}  // namespace google
@@ -15,6 +15,7 @@
 #ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_INTERNAL_RETRY_POLICY_H
 #define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_INTERNAL_RETRY_POLICY_H
 
+#include "google/cloud/retry_budget.h"
 #include "google/cloud/version.h"
 #include <chrono>
 #include <memory>
@@ -58,8 +59,31 @@ class RetryPolicy {
   }
   virtual bool IsExhausted() const = 0;
 
+  /**
+   * Handle a successful operation.
+   *
+   * Most policies only track failures. Policies that limit retries across
+   * requests, such as `RetryBudgetPolicy`, use this to track the successful
+   * requests.
+   */
+  virtual void OnSuccess() {}
+
+  /**
+   * The deadline for the operation, including all its retries.
+   *
+   * Policies without a deadline return `time_point::max()`. The retry loops
+   * use this value to set the deadline for each attempt, so the service can
+   * stop working on requests the client has abandoned.
+   */
+  virtual std::chrono::system_clock::time_point deadline() const {
+    return std::chrono::system_clock::time_point::max();
+  }
+
  protected:
   virtual void OnFailureImpl() = 0;
+
+  /// Let policies that wrap other policies call `OnFailureImpl()`.
+  static void OnFailureImpl(RetryPolicy& policy) { policy.OnFailureImpl(); }
 };
 
 /**
@@ -70,7 +94,7 @@ class RetryPolicy {
  *     permanent failure.
  */
 template <typename StatusType, typename RetryablePolicy>
-class LimitedErrorCountRetryPolicy
+class LimitedErrorCountRetryPolicy final
     : public RetryPolicy<StatusType, RetryablePolicy> {
  public:
   using BaseType = RetryPolicy<StatusType, RetryablePolicy>;
@@ -102,12 +126,17 @@ class LimitedErrorCountRetryPolicy
 /**
  * Implement a simple "keep trying for this time" retry policy.
  *
+ * The policy measures time using `std::chrono::steady_clock`, so changes to
+ * the system clock (e.g. NTP adjustments) do not stretch or shrink the time
+ * allowed for the operation.
+ *
  * @tparam StatusType the type used to represent success/failures.
  * @tparam RetryablePolicy the policy to decide if a status represents a
  *     permanent failure.
  */
 template <typename StatusType, typename RetryablePolicy>
-class LimitedTimeRetryPolicy : public RetryPolicy<StatusType, RetryablePolicy> {
+class LimitedTimeRetryPolicy final
+    : public RetryPolicy<StatusType, RetryablePolicy> {
  public:
   using BaseType = RetryPolicy<StatusType, RetryablePolicy>;
 
@@ -133,7 +162,7 @@ class LimitedTimeRetryPolicy : public RetryPolicy<StatusType, RetryablePolicy> {
       std::chrono::duration<DurationRep, DurationPeriod> maximum_duration)
       : maximum_duration_(std::chrono::duration_cast<std::chrono::milliseconds>(
             maximum_duration)),
-        deadline_(std::chrono::system_clock::now() + maximum_duration_) {}
+        deadline_(std::chrono::steady_clock::now() + maximum_duration_) {}
 
   LimitedTimeRetryPolicy(LimitedTimeRetryPolicy&& rhs) noexcept
       : LimitedTimeRetryPolicy(rhs.maximum_duration_) {}
@@ -145,19 +174,97 @@ class LimitedTimeRetryPolicy : public RetryPolicy<StatusType, RetryablePolicy> {
         new LimitedTimeRetryPolicy(maximum_duration_));
   }
   bool IsExhausted() const override {
-    return std::chrono::system_clock::now() >= deadline_;
+    return std::chrono::steady_clock::now() >= deadline_;
   }
 
-  std::chrono::system_clock::time_point deadline() const { return deadline_; }
+  /**
+   * The deadline in terms of the system clock, as required by gRPC.
+   *
+   * This is computed from the time remaining on each call, so it tracks any
+   * changes to the system clock.
+   */
+  std::chrono::system_clock::time_point deadline() const override {
+    auto const remaining = deadline_ - std::chrono::steady_clock::now();
+    return std::chrono::system_clock::now() +
+           std::chrono::duration_cast<std::chrono::system_clock::duration>(
+               remaining);
+  }
 
  protected:
   void OnFailureImpl() override {}
 
  private:
   std::chrono::milliseconds maximum_duration_;
-  std::chrono::system_clock::time_point deadline_;
+  std::chrono::steady_clock::time_point deadline_;
+};
+
+/**
+ * Limit the retries of a policy using a (typically shared) `RetryBudget`.
+ *
+ * The wrapped policy decides if an operation can be retried. If it can, the
+ * retry also needs a token from the budget. Once the budget rejects a retry
+ * this policy is exhausted, the operation fails with its last error.
+ *
+ * @tparam StatusType the type used to represent success/failures.
+ * @tparam RetryablePolicy the policy to decide if a status represents a
+ *     permanent failure.
+ */
+template <typename StatusType, typename RetryablePolicy>
+class RetryBudgetPolicy : public RetryPolicy<StatusType, RetryablePolicy> {
+ public:
+  using BaseType = RetryPolicy<StatusType, RetryablePolicy>;
+
+  RetryBudgetPolicy(std::unique_ptr<BaseType> policy,
+                    std::shared_ptr<RetryBudget> budget)
+      : policy_(std::move(policy)), budget_(std::move(budget)) {}
+
+  std::unique_ptr<BaseType> clone() const override {
+    return std::unique_ptr<BaseType>(
+        new RetryBudgetPolicy(policy_->clone(), budget_));
+  }
+  bool IsExhausted() const override {
+    return budget_exhausted_ || policy_->IsExhausted();
+  }
+  void OnSuccess() override {
+    policy_->OnSuccess();
+    budget_->OnSuccess();
+  }
+  std::chrono::system_clock::time_point deadline() const override {
+    return policy_->deadline();
+  }
+
+  std::shared_ptr<RetryBudget> const& budget() const { return budget_; }
+
+ protected:
+  void OnFailureImpl() override {
+    BaseType::OnFailureImpl(*policy_);
+    // Only withdraw from the budget if the operation would be retried.
+    if (budget_exhausted_ || policy_->IsExhausted()) return;
+    budget_exhausted_ = !budget_->TryRetry();
+  }
+
+ private:
+  std::unique_ptr<BaseType> policy_;
+  std::shared_ptr<RetryBudget> budget_;
+  bool budget_exhausted_ = false;
 };
 
+/**
+ * Wrap @p policy with a `RetryBudgetPolicy` if @p budget is not null.
+ *
+ * Connections typically call this with the `ConnectionOptions::retry_budget()`
+ * value when creating their retry policies.
+ */
+template <typename StatusType, typename RetryablePolicy>
+std::unique_ptr<RetryPolicy<StatusType, RetryablePolicy>> WithRetryBudget(
+    std::unique_ptr<RetryPolicy<StatusType, RetryablePolicy>> policy,
+    std::shared_ptr<RetryBudget> budget) {
+  if (!budget) return policy;
+  return std::unique_ptr<RetryPolicy<StatusType, RetryablePolicy>>(
+      new RetryBudgetPolicy<StatusType, RetryablePolicy>(std::move(policy),
+                                                         std::move(budget)));
+}
+
 }  // namespace internal
 }  // namespace GOOGLE_CLOUD_CPP_NS
 }  // namespace cloud
@@ -74,6 +74,20 @@ TEST(LimitedTimeRetryPolicy, OnNonRetryable) {
   EXPECT_FALSE(tested.OnFailure(CreatePermanentError()));
 }
 
+/// @test Verify that the deadline() is reported via the base class.
+TEST(LimitedTimeRetryPolicy, Deadline) {
+  auto const start = std::chrono::system_clock::now();
+  LimitedTimeRetryPolicyForTest tested(kLimitedTimeTestPeriod);
+  RetryPolicyForTest const& base = tested;
+  EXPECT_LE(start + kLimitedTimeTestPeriod, base.deadline());
+  EXPECT_GE(std::chrono::system_clock::now() + kLimitedTimeTestPeriod,
+            base.deadline());
+
+  auto budgeted = google::cloud::internal::WithRetryBudget(
+      tested.clone(), std::make_shared<google::cloud::RetryBudget>());
+  EXPECT_LE(start + kLimitedTimeTestPeriod, budgeted->deadline());
+}
+
 /// @test A simple test for the LimitedErrorCountRetryPolicy.
 TEST(LimitedErrorCountRetryPolicy, Simple) {
   LimitedErrorCountRetryPolicyForTest tested(3);
@@ -100,3 +114,54 @@ TEST(LimitedErrorCountRetryPolicy, OnNonRetryable) {
   LimitedErrorCountRetryPolicyForTest tested(3);
   EXPECT_FALSE(tested.OnFailure(CreatePermanentError()));
 }
+
+/// @test Verify that LimitedErrorCountRetryPolicy has no deadline.
+TEST(LimitedErrorCountRetryPolicy, Deadline) {
+  LimitedErrorCountRetryPolicyForTest tested(3);
+  EXPECT_EQ(std::chrono::system_clock::time_point::max(), tested.deadline());
+}
+
+/// @test Verify that RetryBudgetPolicy stops retrying when the budget is empty.
+TEST(RetryBudgetPolicy, Simple) {
+  auto budget = std::make_shared<google::cloud::RetryBudget>(2.0, 0.5);
+  auto tested = google::cloud::internal::WithRetryBudget(
+      LimitedErrorCountRetryPolicyForTest(5).clone(), budget);
+  EXPECT_TRUE(tested->OnFailure(CreateTransientError()));
+  EXPECT_TRUE(tested->OnFailure(CreateTransientError()));
+  EXPECT_FALSE(tested->OnFailure(CreateTransientError()));
+  EXPECT_TRUE(tested->IsExhausted());
+
+  // Clones share the budget, two successes deposit enough for one retry.
+  auto cloned = tested->clone();
+  EXPECT_FALSE(cloned->IsExhausted());
+  cloned->OnSuccess();
+  cloned->OnSuccess();
+  EXPECT_TRUE(cloned->OnFailure(CreateTransientError()));
+  EXPECT_FALSE(cloned->OnFailure(CreateTransientError()));
+
+  auto const counters = budget->counters();
+  EXPECT_EQ(2, counters.successes);
+  EXPECT_EQ(3, counters.retries_allowed);
+  EXPECT_EQ(2, counters.retries_denied);
+}
+
+/// @test Verify that RetryBudgetPolicy respects the wrapped policy.
+TEST(RetryBudgetPolicy, WrappedPolicyExhausted) {
+  auto budget = std::make_shared<google::cloud::RetryBudget>(10.0, 0.1);
+  auto tested = google::cloud::internal::WithRetryBudget(
+      LimitedErrorCountRetryPolicyForTest(1).clone(), budget);
+  EXPECT_FALSE(tested->OnFailure(CreatePermanentError()));
+  EXPECT_TRUE(tested->OnFailure(CreateTransientError()));
+  EXPECT_FALSE(tested->OnFailure(CreateTransientError()));
+  // Only the allowed retry withdraws from the budget.
+  EXPECT_EQ(9.0, budget->tokens());
+  EXPECT_EQ(0, budget->counters().retries_denied);
+}
+
+/// @test Verify that WithRetryBudget() does nothing without a budget.
+TEST(RetryBudgetPolicy, NoBudget) {
+  auto tested = google::cloud::internal::WithRetryBudget(
+      LimitedErrorCountRetryPolicyForTest(1).clone(), {});
+  EXPECT_TRUE(tested->OnFailure(CreateTransientError()));
+  EXPECT_FALSE(tested->OnFailure(CreateTransientError()));
+}
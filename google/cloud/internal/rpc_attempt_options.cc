@@ -0,0 +1,43 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/internal/rpc_attempt_options.h"
+#include "google/cloud/internal/make_unique.h"
+#include <algorithm>
+
+namespace google {
+namespace cloud {
+inline namespace GOOGLE_CLOUD_CPP_NS {
+namespace internal {
+
+std::unique_ptr<grpc::ClientContext> RpcAttemptOptions::MakeContext(
+    std::chrono::system_clock::time_point retry_deadline) const {
+  auto context = context_factory_ ? context_factory_()
+                                 : make_unique<grpc::ClientContext>();
+  auto deadline = std::min(context->deadline(), retry_deadline);
+  if (attempt_timeout_.count() > 0) {
+    auto const timeout = std::chrono::duration_cast<
+        std::chrono::system_clock::duration>(attempt_timeout_);
+    deadline = std::min(deadline, std::chrono::system_clock::now() + timeout);
+  }
+  if (deadline != std::chrono::system_clock::time_point::max()) {
+    context->set_deadline(deadline);
+  }
+  return context;
+}
+
+}  // namespace internal
+}  // namespace GOOGLE_CLOUD_CPP_NS
+}  // namespace cloud
+}  // namespace google
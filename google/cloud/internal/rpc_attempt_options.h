@@ -0,0 +1,110 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_INTERNAL_RPC_ATTEMPT_OPTIONS_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_INTERNAL_RPC_ATTEMPT_OPTIONS_H
+
+#include "google/cloud/adaptive_throttler.h"
+#include "google/cloud/version.h"
+#include <grpcpp/grpcpp.h>
+#include <chrono>
+#include <functional>
+#include <memory>
+
+namespace google {
+namespace cloud {
+inline namespace GOOGLE_CLOUD_CPP_NS {
+namespace internal {
+
+/**
+ * Create the `grpc::ClientContext` for each attempt of a RPC.
+ *
+ * Connections use this to set the metadata, compression, and any other
+ * attributes of the context. Each attempt needs a new context, as
+ * `grpc::ClientContext` objects cannot be reused.
+ */
+using ClientContextFactory =
+    std::function<std::unique_ptr<grpc::ClientContext>()>;
+
+/**
+ * Configure each attempt in a retry loop.
+ *
+ * By default each attempt uses a new `grpc::ClientContext` with the deadline
+ * set by the retry policy (if any). With a per-attempt timeout, slow attempts
+ * are abandoned and retried, instead of consuming the time allotted to the
+ * whole retry loop. With a throttler, attempts may be rejected locally while
+ * the service is overloaded.
+ */
+class RpcAttemptOptions {
+ public:
+  RpcAttemptOptions() = default;
+
+  /**
+   * Abandon attempts that take longer than @p timeout.
+   *
+   * The attempt deadline is capped at the retry loop deadline. A zero (the
+   * default) timeout disables the per-attempt timeout. The timeout is kept in
+   * milliseconds, rounded up, so sub-millisecond timeouts become 1ms instead
+   * of disabling the timeout.
+   */
+  template <typename Rep, typename Period>
+  RpcAttemptOptions& set_attempt_timeout(
+      std::chrono::duration<Rep, Period> timeout) {
+    using std::chrono::milliseconds;
+    attempt_timeout_ = std::chrono::duration_cast<milliseconds>(timeout);
+    if (attempt_timeout_ < timeout) attempt_timeout_ += milliseconds(1);
+    return *this;
+  }
+
+  /// The per-attempt timeout, zero if there is no timeout.
+  std::chrono::milliseconds attempt_timeout() const { return attempt_timeout_; }
+
+  /// Use @p factory to create the context for each attempt.
+  RpcAttemptOptions& set_context_factory(ClientContextFactory factory) {
+    context_factory_ = std::move(factory);
+    return *this;
+  }
+
+  /// Use @p throttler to reject attempts locally.
+  RpcAttemptOptions& set_throttler(std::shared_ptr<AdaptiveThrottler> v) {
+    throttler_ = std::move(v);
+    return *this;
+  }
+
+  /// The throttler for each attempt, if any.
+  std::shared_ptr<AdaptiveThrottler> const& throttler() const {
+    return throttler_;
+  }
+
+  /**
+   * Create the context for a new attempt.
+   *
+   * The context deadline is the earliest of: the deadline set by the context
+   * factory (if any), @p retry_deadline, and the per-attempt timeout (if any).
+   */
+  std::unique_ptr<grpc::ClientContext> MakeContext(
+      std::chrono::system_clock::time_point retry_deadline) const;
+
+ private:
+  std::chrono::milliseconds attempt_timeout_{0};
+  ClientContextFactory context_factory_;
+  std::shared_ptr<AdaptiveThrottler> throttler_;
+};
+
+}  // namespace internal
+}  // namespace GOOGLE_CLOUD_CPP_NS
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_INTERNAL_RPC_ATTEMPT_OPTIONS_H
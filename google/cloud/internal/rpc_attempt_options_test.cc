@@ -0,0 +1,107 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/internal/rpc_attempt_options.h"
+#include "google/cloud/internal/make_unique.h"
+#include <gmock/gmock.h>
+
+namespace google {
+namespace cloud {
+inline namespace GOOGLE_CLOUD_CPP_NS {
+namespace internal {
+namespace {
+
+using ::std::chrono::system_clock;
+
+TEST(RpcAttemptOptionsTest, Defaults) {
+  RpcAttemptOptions options;
+  EXPECT_EQ(0, options.attempt_timeout().count());
+
+  auto context = options.MakeContext(system_clock::time_point::max());
+  ASSERT_NE(nullptr, context);
+  EXPECT_EQ(system_clock::time_point::max(), context->deadline());
+}
+
+TEST(RpcAttemptOptionsTest, RetryDeadline) {
+  RpcAttemptOptions options;
+  auto const deadline = system_clock::now() + std::chrono::minutes(5);
+  auto context = options.MakeContext(deadline);
+  EXPECT_EQ(deadline, context->deadline());
+}
+
+TEST(RpcAttemptOptionsTest, AttemptTimeout) {
+  RpcAttemptOptions options;
+  options.set_attempt_timeout(std::chrono::seconds(2));
+  EXPECT_EQ(std::chrono::milliseconds(2000), options.attempt_timeout());
+
+  auto const start = system_clock::now();
+  auto context = options.MakeContext(start + std::chrono::minutes(5));
+  EXPECT_LE(start + std::chrono::seconds(2), context->deadline());
+  EXPECT_GE(system_clock::now() + std::chrono::seconds(2),
+            context->deadline());
+
+  context = options.MakeContext(system_clock::time_point::max());
+  EXPECT_GE(system_clock::now() + std::chrono::seconds(2),
+            context->deadline());
+}
+
+TEST(RpcAttemptOptionsTest, AttemptTimeoutRoundsUp) {
+  RpcAttemptOptions options;
+  options.set_attempt_timeout(std::chrono::microseconds(100));
+  EXPECT_EQ(std::chrono::milliseconds(1), options.attempt_timeout());
+  options.set_attempt_timeout(std::chrono::microseconds(1500));
+  EXPECT_EQ(std::chrono::milliseconds(2), options.attempt_timeout());
+  options.set_attempt_timeout(std::chrono::microseconds(2000));
+  EXPECT_EQ(std::chrono::milliseconds(2), options.attempt_timeout());
+  options.set_attempt_timeout(std::chrono::microseconds(0));
+  EXPECT_EQ(0, options.attempt_timeout().count());
+}
+
+TEST(RpcAttemptOptionsTest, AttemptTimeoutCappedByRetryDeadline) {
+  RpcAttemptOptions options;
+  options.set_attempt_timeout(std::chrono::minutes(10));
+  auto const deadline = system_clock::now() + std::chrono::seconds(1);
+  auto context = options.MakeContext(deadline);
+  EXPECT_EQ(deadline, context->deadline());
+}
+
+TEST(RpcAttemptOptionsTest, ContextFactory) {
+  auto const factory_deadline = system_clock::now() + std::chrono::seconds(1);
+  int calls = 0;
+  RpcAttemptOptions options;
+  options.set_context_factory([&] {
+    ++calls;
+    auto context = make_unique<grpc::ClientContext>();
+    context->set_compression_algorithm(GRPC_COMPRESS_GZIP);
+    context->set_deadline(factory_deadline);
+    return context;
+  });
+
+  auto context = options.MakeContext(system_clock::time_point::max());
+  EXPECT_EQ(1, calls);
+  EXPECT_EQ(GRPC_COMPRESS_GZIP, context->compression_algorithm());
+  EXPECT_EQ(factory_deadline, context->deadline());
+
+  // The retry deadline is used if it is earlier than the factory's deadline.
+  auto const retry_deadline = factory_deadline - std::chrono::milliseconds(500);
+  context = options.MakeContext(retry_deadline);
+  EXPECT_EQ(2, calls);
+  EXPECT_EQ(retry_deadline, context->deadline());
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace GOOGLE_CLOUD_CPP_NS
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,88 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/internal/streaming_read_stats_recorder.h"
+
+namespace google {
+namespace cloud {
+inline namespace GOOGLE_CLOUD_CPP_NS {
+namespace internal {
+
+void StreamingReadStatsRecorder::OnStart() {
+  start_.store(ToNanos(Clock::now()), std::memory_order_relaxed);
+}
+
+void StreamingReadStatsRecorder::OnMessage(std::size_t bytes) {
+  auto const now = ToNanos(Clock::now());
+  // Only the stream calls this function, and never concurrently, so the
+  // updates below do not need to be atomic as a group.
+  if (messages_.fetch_add(1, std::memory_order_relaxed) == 0) {
+    time_to_first_message_.store(now - Load(start_), std::memory_order_relaxed);
+  } else {
+    auto const gap = now - Load(last_message_);
+    Add(total_message_gap_, gap);
+    if (gap > Load(max_message_gap_)) {
+      max_message_gap_.store(gap, std::memory_order_relaxed);
+    }
+  }
+  last_message_.store(now, std::memory_order_relaxed);
+  Add(bytes_, static_cast<std::int64_t>(bytes));
+}
+
+void StreamingReadStatsRecorder::OnHandlerDone(Clock::time_point start) {
+  Add(handler_time_, ToNanos(Clock::now()) - ToNanos(start));
+}
+
+void StreamingReadStatsRecorder::OnDiscardStart() {
+  discard_start_.store(ToNanos(Clock::now()), std::memory_order_relaxed);
+  discarding_.store(true, std::memory_order_relaxed);
+}
+
+void StreamingReadStatsRecorder::OnEndOfStream() {
+  if (!discarding_.exchange(false, std::memory_order_relaxed)) return;
+  Add(discard_time_, ToNanos(Clock::now()) - Load(discard_start_));
+}
+
+void StreamingReadStatsRecorder::OnFinish(Status status) {
+  std::lock_guard<std::mutex> lk(mu_);
+  finished_ = true;
+  status_ = std::move(status);
+}
+
+StreamingReadStats StreamingReadStatsRecorder::Snapshot() const {
+  using ns = std::chrono::nanoseconds;
+  StreamingReadStats stats;
+  stats.messages = Load(messages_);
+  stats.bytes = Load(bytes_);
+  stats.time_to_first_message = ns(Load(time_to_first_message_));
+  stats.total_message_gap = ns(Load(total_message_gap_));
+  stats.max_message_gap = ns(Load(max_message_gap_));
+  stats.handler_time = ns(Load(handler_time_));
+  stats.discard_time = ns(Load(discard_time_));
+  std::lock_guard<std::mutex> lk(mu_);
+  stats.finished = finished_;
+  stats.status = status_;
+  return stats;
+}
+
+std::int64_t StreamingReadStatsRecorder::ToNanos(Clock::time_point tp) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             tp.time_since_epoch())
+      .count();
+}
+
+}  // namespace internal
+}  // namespace GOOGLE_CLOUD_CPP_NS
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,104 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_INTERNAL_STREAMING_READ_STATS_RECORDER_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_INTERNAL_STREAMING_READ_STATS_RECORDER_H
+
+#include "google/cloud/status.h"
+#include "google/cloud/streaming_read_stats.h"
+#include "google/cloud/version.h"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+namespace google {
+namespace cloud {
+inline namespace GOOGLE_CLOUD_CPP_NS {
+namespace internal {
+/**
+ * Collect the `StreamingReadStats` for a streaming read RPC.
+ *
+ * The stream calls these functions from the completion queue threads, while
+ * the application may call `Snapshot()` from any thread.
+ *
+ * The per-message counters use relaxed atomics, recording a message does not
+ * acquire a lock. The stream serializes the calls to `OnMessage()`, so only
+ * the handler time is updated concurrently with the other counters. A
+ * `Snapshot()` taken while the stream is active may observe the fields at
+ * slightly different points in time.
+ */
+class StreamingReadStatsRecorder {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  /// The stream is starting the call.
+  void OnStart();
+
+  /// The stream received a message of @p bytes bytes.
+  void OnMessage(std::size_t bytes);
+
+  /// The handler, called at @p start, has completed.
+  void OnHandlerDone(Clock::time_point start);
+
+  /// The handler stopped the stream, the remaining messages are discarded.
+  void OnDiscardStart();
+
+  /// The stream has no more messages.
+  void OnEndOfStream();
+
+  /// The stream finished with @p status.
+  void OnFinish(Status status);
+
+  /// Return the statistics collected so far.
+  StreamingReadStats Snapshot() const;
+
+ private:
+  using Counter = std::atomic<std::int64_t>;
+
+  /// Return @p tp as a count of nanoseconds, suitable for a `Counter`.
+  static std::int64_t ToNanos(Clock::time_point tp);
+
+  static std::int64_t Load(Counter const& c) {
+    return c.load(std::memory_order_relaxed);
+  }
+  static void Add(Counter& c, std::int64_t v) {
+    c.fetch_add(v, std::memory_order_relaxed);
+  }
+
+  Counter messages_{0};
+  Counter bytes_{0};
+  Counter time_to_first_message_{0};
+  Counter total_message_gap_{0};
+  Counter max_message_gap_{0};
+  Counter handler_time_{0};
+  Counter discard_time_{0};
+  Counter start_{0};
+  Counter last_message_{0};
+  Counter discard_start_{0};
+  std::atomic<bool> discarding_{false};
+
+  // The final status is recorded once per stream, a mutex is good enough.
+  mutable std::mutex mu_;
+  bool finished_ = false;  // GUARDED_BY(mu_)
+  Status status_;          // GUARDED_BY(mu_)
+};
+
+}  // namespace internal
+}  // namespace GOOGLE_CLOUD_CPP_NS
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_INTERNAL_STREAMING_READ_STATS_RECORDER_H
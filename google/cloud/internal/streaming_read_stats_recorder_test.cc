@@ -0,0 +1,128 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/internal/streaming_read_stats_recorder.h"
+#include "google/cloud/testing_util/assert_ok.h"
+#include <gmock/gmock.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace google {
+namespace cloud {
+inline namespace GOOGLE_CLOUD_CPP_NS {
+namespace internal {
+namespace {
+
+using ms = std::chrono::milliseconds;
+
+TEST(StreamingReadStatsRecorderTest, Empty) {
+  StreamingReadStatsRecorder recorder;
+  auto const stats = recorder.Snapshot();
+  EXPECT_EQ(0, stats.messages);
+  EXPECT_EQ(0, stats.bytes);
+  EXPECT_EQ(0, stats.time_to_first_message.count());
+  EXPECT_EQ(0, stats.total_message_gap.count());
+  EXPECT_EQ(0, stats.max_message_gap.count());
+  EXPECT_EQ(0, stats.handler_time.count());
+  EXPECT_EQ(0, stats.discard_time.count());
+  EXPECT_FALSE(stats.finished);
+}
+
+TEST(StreamingReadStatsRecorderTest, Messages) {
+  StreamingReadStatsRecorder recorder;
+  recorder.OnStart();
+  std::this_thread::sleep_for(ms(2));
+  recorder.OnMessage(10);
+  recorder.OnMessage(20);
+  std::this_thread::sleep_for(ms(2));
+  recorder.OnMessage(30);
+
+  auto const stats = recorder.Snapshot();
+  EXPECT_EQ(3, stats.messages);
+  EXPECT_EQ(60, stats.bytes);
+  EXPECT_LE(ms(2), stats.time_to_first_message);
+  EXPECT_LE(ms(2), stats.max_message_gap);
+  EXPECT_LE(stats.max_message_gap, stats.total_message_gap);
+  EXPECT_FALSE(stats.finished);
+}
+
+TEST(StreamingReadStatsRecorderTest, HandlerTime) {
+  StreamingReadStatsRecorder recorder;
+  auto const now = StreamingReadStatsRecorder::Clock::now();
+  recorder.OnHandlerDone(now - ms(5));
+  recorder.OnHandlerDone(now - ms(7));
+  EXPECT_LE(ms(12), recorder.Snapshot().handler_time);
+}
+
+TEST(StreamingReadStatsRecorderTest, DiscardTime) {
+  StreamingReadStatsRecorder recorder;
+  // The end of stream only counts as discard time after a discard starts.
+  recorder.OnEndOfStream();
+  EXPECT_EQ(0, recorder.Snapshot().discard_time.count());
+
+  recorder.OnDiscardStart();
+  std::this_thread::sleep_for(ms(2));
+  recorder.OnEndOfStream();
+  auto const discard_time = recorder.Snapshot().discard_time;
+  EXPECT_LE(ms(2), discard_time);
+
+  // A second end of stream does not add to the discard time.
+  recorder.OnEndOfStream();
+  EXPECT_EQ(discard_time, recorder.Snapshot().discard_time);
+}
+
+TEST(StreamingReadStatsRecorderTest, Finish) {
+  StreamingReadStatsRecorder recorder;
+  recorder.OnFinish(Status(StatusCode::kUnavailable, "try-again"));
+  auto const stats = recorder.Snapshot();
+  EXPECT_TRUE(stats.finished);
+  EXPECT_EQ(StatusCode::kUnavailable, stats.status.code());
+  EXPECT_EQ("try-again", stats.status.message());
+}
+
+/// @test Verify that handlers and messages can be recorded concurrently.
+TEST(StreamingReadStatsRecorderTest, ConcurrentHandlers) {
+  auto constexpr kMessages = 1000;
+  auto constexpr kHandlerThreads = 4;
+  StreamingReadStatsRecorder recorder;
+  recorder.OnStart();
+
+  auto const start = StreamingReadStatsRecorder::Clock::now() - ms(1);
+  std::vector<std::thread> handlers;
+  for (int t = 0; t != kHandlerThreads; ++t) {
+    handlers.emplace_back([&recorder, start] {
+      for (int i = 0; i != kMessages; ++i) recorder.OnHandlerDone(start);
+    });
+  }
+  for (int i = 0; i != kMessages; ++i) {
+    recorder.OnMessage(1);
+    (void)recorder.Snapshot();
+  }
+  for (auto& t : handlers) t.join();
+  recorder.OnFinish(Status{});
+
+  auto const stats = recorder.Snapshot();
+  EXPECT_EQ(kMessages, stats.messages);
+  EXPECT_EQ(kMessages, stats.bytes);
+  EXPECT_LE(ms(kMessages * kHandlerThreads), stats.handler_time);
+  EXPECT_TRUE(stats.finished);
+  EXPECT_STATUS_OK(stats.status);
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace GOOGLE_CLOUD_CPP_NS
+}  // namespace cloud
+}  // namespace google
@@ -76,6 +76,23 @@ std::array<char const*, kSeverityCount> constexpr kSeverityNames{{
     "ALERT",
     "FATAL",
 }};
+
+/// Registers a `LogSink::Log()` call as a reader of the current snapshot.
+class ReaderGuard {
+ public:
+  ReaderGuard(std::atomic<std::uint64_t> const& epoch,
+              std::atomic<int>* readers)
+      : counter_(readers[epoch.load() % 2]) {
+    counter_.fetch_add(1);
+  }
+  ~ReaderGuard() { counter_.fetch_sub(1); }
+
+  ReaderGuard(ReaderGuard const&) = delete;
+  ReaderGuard& operator=(ReaderGuard const&) = delete;
+
+ private:
+  std::atomic<int>& counter_;
+};
 }  // namespace
 
 std::ostream& operator<<(std::ostream& os, Severity x) {
@@ -92,7 +109,15 @@ LogSink::LogSink()
     : empty_(true),
       minimum_severity_(static_cast<int>(Severity::GCP_LS_LOWEST_ENABLED)),
       next_id_(0),
-      clog_backend_id_(0) {}
+      clog_backend_id_(0),
+      snapshot_(nullptr),
+      epoch_(0),
+      flip_pending_(false) {
+  readers_[0].store(0);
+  readers_[1].store(0);
+}
+
+LogSink::~LogSink() { delete snapshot_.load(); }
 
 LogSink& LogSink::Instance() {
   static auto* const kInstance = [] {
@@ -108,13 +133,16 @@ LogSink& LogSink::Instance() {
 // NOLINTNEXTLINE(google-runtime-int)
 long LogSink::AddBackend(std::shared_ptr<LogBackend> backend) {
   std::unique_lock<std::mutex> lk(mu_);
-  return AddBackendImpl(std::move(backend));
+  auto const id = AddBackendImpl(std::move(backend));
+  PublishBackends(std::move(lk));
+  return id;
 }
 
 // NOLINTNEXTLINE(google-runtime-int)
 void LogSink::RemoveBackend(long id) {
   std::unique_lock<std::mutex> lk(mu_);
   RemoveBackendImpl(id);
+  PublishBackends(std::move(lk));
 }
 
 void LogSink::ClearBackends() {
@@ -122,6 +150,7 @@ void LogSink::ClearBackends() {
   backends_.clear();
   clog_backend_id_ = 0;
   empty_.store(backends_.empty());
+  PublishBackends(std::move(lk));
 }
 
 std::size_t LogSink::BackendCount() const {
@@ -130,26 +159,26 @@ std::size_t LogSink::BackendCount() const {
 }
 
 void LogSink::Log(LogRecord log_record) {
-  // Make a copy of the backends because calling user-defined functions while
-  // holding a lock is a bad idea: the application may change the backends while
-  // we are holding this lock, and soon deadlock occurs.
-  auto copy = [this]() {
-    std::unique_lock<std::mutex> lk(mu_);
-    return backends_;
-  }();
-  if (copy.empty()) {
+  // Calling user-defined functions while holding a lock is a bad idea: the
+  // application may change the backends while we are holding this lock, and
+  // soon deadlock occurs. Copying the backends for each record is too
+  // expensive, so use the current snapshot, which is not deleted until this
+  // function returns.
+  ReaderGuard guard(epoch_, readers_);
+  auto const* backends = snapshot_.load();
+  if (backends == nullptr) {
     return;
   }
   // In general, we just give each backend a const-reference and the backends
   // must make a copy if needed.  But if there is only one backend we can give
   // the backend an opportunity to optimize things by transferring ownership of
   // the LogRecord to it.
-  if (copy.size() == 1) {
-    copy.begin()->second->ProcessWithOwnership(std::move(log_record));
+  if (backends->size() == 1) {
+    backends->front()->ProcessWithOwnership(std::move(log_record));
     return;
   }
-  for (auto& kv : copy) {
-    kv.second->Process(log_record);
+  for (auto const& b : *backends) {
+    b->Process(log_record);
   }
 }
 
@@ -174,6 +203,7 @@ void LogSink::EnableStdClogImpl() {
     return;
   }
   clog_backend_id_ = AddBackendImpl(std::make_shared<StdClogBackend>());
+  PublishBackends(std::move(lk));
 }
 
 void LogSink::DisableStdClogImpl() {
@@ -183,6 +213,7 @@ void LogSink::DisableStdClogImpl() {
   }
   RemoveBackendImpl(clog_backend_id_);
   clog_backend_id_ = 0;
+  PublishBackends(std::move(lk));
 }
 
 // NOLINTNEXTLINE(google-runtime-int)
@@ -203,6 +234,50 @@ void LogSink::RemoveBackendImpl(long id) {
   empty_.store(backends_.empty());
 }
 
+void LogSink::PublishBackends(std::unique_lock<std::mutex> lk) {
+  std::unique_ptr<BackendList> list;
+  if (!backends_.empty()) {
+    list.reset(new BackendList);
+    list->reserve(backends_.size());
+    for (auto const& kv : backends_) list->push_back(kv.second);
+  }
+  std::unique_ptr<BackendList const> old(snapshot_.exchange(list.release()));
+  if (old) {
+    // Only flips started after the exchange wait for the readers of `old`.
+    retired_.push_back(RetiredSnapshot{std::move(old), epoch_.load() + 2});
+  }
+  // Release the lock before deleting the snapshots: the destructors of the
+  // backends may log.
+  auto reclaimed = ReclaimSnapshots();
+  lk.unlock();
+}
+
+std::vector<std::unique_ptr<LogSink::BackendList const>>
+LogSink::ReclaimSnapshots() {
+  std::vector<std::unique_ptr<BackendList const>> reclaimed;
+  // A reader may load the epoch before a flip, and increment its counter
+  // after it. Two completed flips after a snapshot is replaced wait for the
+  // readers of both epochs. A flip completes once the readers of the
+  // previous epoch have drained; this never waits for them.
+  while (!retired_.empty()) {
+    if (flip_pending_) {
+      if (readers_[(epoch_.load() - 1) % 2].load() != 0) break;
+      flip_pending_ = false;
+    }
+    auto const completed = epoch_.load();
+    auto it = retired_.begin();
+    while (it != retired_.end() && it->safe_epoch <= completed) {
+      reclaimed.push_back(std::move(it->snapshot));
+      ++it;
+    }
+    retired_.erase(retired_.begin(), it);
+    if (retired_.empty()) break;
+    epoch_.fetch_add(1);
+    flip_pending_ = true;
+  }
+  return reclaimed;
+}
+
 }  // namespace GOOGLE_CLOUD_CPP_NS
 }  // namespace cloud
 }  // namespace google
@@ -85,12 +85,14 @@
 #include "google/cloud/version.h"
 #include <atomic>
 #include <chrono>
+#include <cstdint>
 #include <functional>
 #include <iostream>
 #include <map>
 #include <memory>
 #include <mutex>
 #include <sstream>
+#include <vector>
 
 namespace google {
 namespace cloud {
@@ -239,6 +241,7 @@ class LogBackend {
 class LogSink {
  public:
   LogSink();
+  ~LogSink();
 
   /// Return true if the severity is enabled at compile time.
   static bool constexpr CompileTimeEnabled(Severity level) {
@@ -297,6 +300,15 @@ class LogSink {
   }
 
   long AddBackend(std::shared_ptr<LogBackend> backend);
+
+  /**
+   * Remove one backend, or all of them.
+   *
+   * These functions do not wait for concurrent `Log()` calls, and may be
+   * called from a backend. A removed backend may still receive the records
+   * being logged concurrently, and the sink may hold a reference to it until
+   * the backends change again.
+   */
   void RemoveBackend(long id);
   void ClearBackends();
   std::size_t BackendCount() const;
@@ -320,12 +332,44 @@ class LogSink {
   long AddBackendImpl(std::shared_ptr<LogBackend> backend);
   void RemoveBackendImpl(long id);
 
+  using BackendList = std::vector<std::shared_ptr<LogBackend>>;
+  struct RetiredSnapshot {
+    std::unique_ptr<BackendList const> snapshot;
+    /// No `Log()` call uses `snapshot` once this many flips have completed.
+    std::uint64_t safe_epoch;
+  };
+
+  /// Publish a new snapshot of `backends_`, releasing @p lk.
+  void PublishBackends(std::unique_lock<std::mutex> lk);
+
+  /**
+   * Advance the epoch and return the retired snapshots no longer in use.
+   *
+   * This never waits for `Log()` calls to finish. Snapshots still in use are
+   * reclaimed by a later call.
+   */
+  std::vector<std::unique_ptr<BackendList const>> ReclaimSnapshots();
+
   std::atomic<bool> empty_;
   std::atomic<int> minimum_severity_;
   std::mutex mutable mu_;
   long next_id_;
   long clog_backend_id_;
   std::map<long, std::shared_ptr<LogBackend>> backends_;
+
+  /**
+   * An immutable snapshot of `backends_`, used by `Log()` without locking.
+   *
+   * `Log()` registers in `readers_[epoch_ % 2]` before loading the snapshot.
+   * Replaced snapshots are retired, and deleted only after the epoch has been
+   * flipped twice, and the readers of each epoch have finished.
+   */
+  std::atomic<BackendList const*> snapshot_;
+  std::atomic<std::uint64_t> epoch_;
+  std::atomic<int> readers_[2];
+  /// Set when the readers of the epoch before `epoch_` may be active.
+  bool flip_pending_;
+  std::vector<RetiredSnapshot> retired_;
 };
 
 /**
@@ -404,8 +448,8 @@ class Logger {
 template <>
 class Logger<false> {
  public:
-  Logger<false>() = default;
-  Logger<false>(Severity, char const*, char const*, int, LogSink&) {}
+  Logger() = default;
+  Logger(Severity, char const*, char const*, int, LogSink&) {}
 
   //@{
   /**
@@ -16,6 +16,9 @@
 #include "google/cloud/testing_util/scoped_environment.h"
 #include <gmock/gmock.h>
 #include <chrono>
+#include <future>
+#include <thread>
+#include <vector>
 
 namespace google {
 namespace cloud {
@@ -119,6 +122,90 @@ TEST(LogSinkTest, LogEnabledMultipleBackends) {
   GOOGLE_CLOUD_CPP_LOG_I(GCP_LS_WARNING, sink) << "test message";
 }
 
+TEST(LogSinkTest, RemoveBackendWhileLogging) {
+  LogSink sink;
+  auto backend = std::make_shared<MockLogBackend>();
+  long id = 0;  // NOLINT(google-runtime-int)
+  EXPECT_CALL(*backend, ProcessWithOwnership(_))
+      .WillOnce(Invoke([&sink, &id](LogRecord const&) {
+        // The snapshot used by this call is not deleted until it returns.
+        sink.RemoveBackend(id);
+        EXPECT_TRUE(sink.empty());
+      }));
+  id = sink.AddBackend(backend);
+
+  GOOGLE_CLOUD_CPP_LOG_I(GCP_LS_WARNING, sink) << "test message";
+  GOOGLE_CLOUD_CPP_LOG_I(GCP_LS_WARNING, sink) << "not delivered";
+  EXPECT_EQ(0, sink.BackendCount());
+
+  // The next change releases the snapshot replaced while logging.
+  sink.ClearBackends();
+  EXPECT_EQ(1, backend.use_count());
+}
+
+class CountingBackend : public LogBackend {
+ public:
+  void Process(LogRecord const&) override { ++count; }
+  void ProcessWithOwnership(LogRecord) override { ++count; }
+
+  std::atomic<int> count{0};
+};
+
+TEST(LogSinkTest, ChangeBackendsWhileLogging) {
+  LogSink sink;
+  auto permanent = std::make_shared<CountingBackend>();
+  sink.AddBackend(permanent);
+
+  auto constexpr kThreadCount = 4;
+  auto constexpr kIterations = 1000;
+  std::vector<std::thread> threads;
+  for (int t = 0; t != kThreadCount; ++t) {
+    threads.emplace_back([&sink] {
+      for (int i = 0; i != kIterations; ++i) {
+        GOOGLE_CLOUD_CPP_LOG_I(GCP_LS_WARNING, sink) << "message " << i;
+      }
+    });
+  }
+  auto transient = std::make_shared<CountingBackend>();
+  for (int i = 0; i != 100; ++i) {
+    sink.RemoveBackend(sink.AddBackend(transient));
+  }
+  for (auto& t : threads) t.join();
+
+  // Without concurrent readers the next change releases all the snapshots.
+  sink.ClearBackends();
+  EXPECT_EQ(kThreadCount * kIterations, permanent->count.load());
+  EXPECT_EQ(1, permanent.use_count());
+  EXPECT_EQ(1, transient.use_count());
+}
+
+TEST(LogSinkTest, RemoveBackendDoesNotWaitForSlowBackend) {
+  LogSink sink;
+  std::promise<void> entered;
+  std::promise<void> release;
+  auto slow = std::make_shared<MockLogBackend>();
+  EXPECT_CALL(*slow, ProcessWithOwnership(_))
+      .WillOnce(Invoke([&](LogRecord const&) {
+        entered.set_value();
+        release.get_future().get();
+      }));
+  auto const id = sink.AddBackend(slow);
+
+  std::thread t([&sink] {
+    GOOGLE_CLOUD_CPP_LOG_I(GCP_LS_WARNING, sink) << "slow message";
+  });
+  entered.get_future().get();
+  // This would deadlock if removing a backend waited for `Log()` to return.
+  sink.RemoveBackend(id);
+  EXPECT_TRUE(sink.empty());
+  EXPECT_LT(1, slow.use_count());
+  release.set_value();
+  t.join();
+
+  sink.ClearBackends();
+  EXPECT_EQ(1, slow.use_count());
+}
+
 TEST(LogSinkTest, LogDefaultInstance) {
   auto backend = std::make_shared<MockLogBackend>();
   EXPECT_CALL(*backend, ProcessWithOwnership(_))
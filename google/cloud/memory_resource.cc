@@ -0,0 +1,171 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/memory_resource.h"
+#include <atomic>
+#include <cstdint>
+#include <new>
+
+namespace google {
+namespace cloud {
+inline namespace GOOGLE_CLOUD_CPP_NS {
+namespace {
+std::size_t constexpr kMaxAlign = alignof(std::max_align_t);
+
+void* GlobalAllocate(std::size_t bytes, std::size_t alignment) {
+  if (alignment <= kMaxAlign) return ::operator new(bytes);
+  // C++11 does not have an over-aligned `operator new()`. Allocate enough
+  // memory to align the block, and save the original pointer just before it.
+  auto* raw = static_cast<char*>(
+      ::operator new(bytes + alignment + sizeof(void*)));
+  auto address = reinterpret_cast<std::uintptr_t>(raw + sizeof(void*));
+  address = (address + alignment - 1) & ~(alignment - 1);
+  auto* aligned = reinterpret_cast<void**>(address);
+  aligned[-1] = raw;
+  return aligned;
+}
+
+void GlobalDeallocate(void* p, std::size_t alignment) {
+  if (alignment <= kMaxAlign) return ::operator delete(p);
+  ::operator delete(static_cast<void**>(p)[-1]);
+}
+
+class NewDeleteResourceImpl : public MemoryResource {
+ public:
+  void* Allocate(std::size_t bytes, std::size_t alignment) override {
+    return GlobalAllocate(bytes, alignment);
+  }
+  void Deallocate(void* p, std::size_t, std::size_t alignment) override {
+    GlobalDeallocate(p, alignment);
+  }
+};
+
+// The pool uses size classes in multiples of this value.
+std::size_t constexpr kSizeClassGranularity = 64;
+// The number of size classes, larger blocks are not cached.
+std::size_t constexpr kSizeClassCount = 8;
+std::size_t constexpr kMaxPooledSize =
+    kSizeClassGranularity * kSizeClassCount;
+// The maximum number of free blocks cached by each thread, per size class.
+std::size_t constexpr kMaxCachedBlocks = 64;
+
+struct FreeBlock {
+  FreeBlock* next;
+};
+
+/**
+ * The per-thread free lists.
+ *
+ * This is trivially destructible, so it remains usable (as "destroyed") even
+ * after the thread-local destructors run, for example, when a future is
+ * released by the destructor of another thread-local object.
+ */
+struct ThreadCache {
+  FreeBlock* head[kSizeClassCount];
+  std::size_t count[kSizeClassCount];
+  bool registered;
+  bool destroyed;
+};
+
+thread_local ThreadCache thread_cache;
+
+/// Return the cached blocks to the global allocator when the thread exits.
+struct ThreadCacheReleaser {
+  ThreadCacheReleaser() { thread_cache.registered = true; }
+  ~ThreadCacheReleaser() {
+    for (std::size_t i = 0; i != kSizeClassCount; ++i) {
+      while (thread_cache.head[i] != nullptr) {
+        auto* block = thread_cache.head[i];
+        thread_cache.head[i] = block->next;
+        ::operator delete(block);
+      }
+      thread_cache.count[i] = 0;
+    }
+    thread_cache.destroyed = true;
+  }
+};
+
+ThreadCache* LocalCache() {
+  if (thread_cache.destroyed) return nullptr;
+  if (!thread_cache.registered) {
+    static thread_local ThreadCacheReleaser releaser;
+    (void)releaser;
+  }
+  return &thread_cache;
+}
+
+std::size_t SizeClass(std::size_t bytes) {
+  return bytes == 0 ? 0 : (bytes - 1) / kSizeClassGranularity;
+}
+
+class ThreadCachingPool : public MemoryResource {
+ public:
+  void* Allocate(std::size_t bytes, std::size_t alignment) override {
+    if (bytes > kMaxPooledSize || alignment > kMaxAlign) {
+      return GlobalAllocate(bytes, alignment);
+    }
+    auto const size_class = SizeClass(bytes);
+    auto* cache = LocalCache();
+    if (cache != nullptr && cache->head[size_class] != nullptr) {
+      auto* block = cache->head[size_class];
+      cache->head[size_class] = block->next;
+      --cache->count[size_class];
+      return block;
+    }
+    return ::operator new((size_class + 1) * kSizeClassGranularity);
+  }
+
+  void Deallocate(void* p, std::size_t bytes, std::size_t alignment) override {
+    if (bytes > kMaxPooledSize || alignment > kMaxAlign) {
+      return GlobalDeallocate(p, alignment);
+    }
+    auto const size_class = SizeClass(bytes);
+    auto* cache = LocalCache();
+    if (cache == nullptr || cache->count[size_class] >= kMaxCachedBlocks) {
+      return ::operator delete(p);
+    }
+    auto* block = static_cast<FreeBlock*>(p);
+    block->next = cache->head[size_class];
+    cache->head[size_class] = block;
+    ++cache->count[size_class];
+  }
+};
+
+std::atomic<MemoryResource*> default_resource(nullptr);
+
+}  // namespace
+
+MemoryResource* NewDeleteResource() {
+  static auto* const kInstance = new NewDeleteResourceImpl;
+  return kInstance;
+}
+
+MemoryResource* ThreadCachingPoolResource() {
+  static auto* const kInstance = new ThreadCachingPool;
+  return kInstance;
+}
+
+MemoryResource* DefaultMemoryResource() {
+  auto* resource = default_resource.load();
+  return resource != nullptr ? resource : ThreadCachingPoolResource();
+}
+
+MemoryResource* SetDefaultMemoryResource(MemoryResource* resource) {
+  auto* previous = default_resource.exchange(resource);
+  return previous != nullptr ? previous : ThreadCachingPoolResource();
+}
+
+}  // namespace GOOGLE_CLOUD_CPP_NS
+}  // namespace cloud
+}  // namespace google
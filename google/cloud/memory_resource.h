@@ -0,0 +1,125 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_MEMORY_RESOURCE_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_MEMORY_RESOURCE_H
+
+#include "google/cloud/version.h"
+#include <cstddef>
+
+namespace google {
+namespace cloud {
+inline namespace GOOGLE_CLOUD_CPP_NS {
+/**
+ * An interface to allocate the memory used by futures and promises.
+ *
+ * This is modeled after the C++17 `std::pmr::memory_resource` class, which is
+ * not available in C++11. Applications can route the allocations for shared
+ * states and continuations to a pool or arena by implementing this interface
+ * and passing the resource to `promise<T>` or `future<T>::then()`.
+ *
+ * The resource must outlive any object allocated with it.
+ *
+ * @par Thread-safety
+ * Implementations must be thread-safe, the memory may be released in a
+ * different thread than the thread that allocated it.
+ */
+class MemoryResource {
+ public:
+  virtual ~MemoryResource() = default;
+
+  /// Allocate @p bytes with at least @p alignment, never returns `nullptr`.
+  virtual void* Allocate(std::size_t bytes, std::size_t alignment) = 0;
+
+  /// Release memory obtained from `Allocate(bytes, alignment)`.
+  virtual void Deallocate(void* p, std::size_t bytes,
+                          std::size_t alignment) = 0;
+};
+
+/// A resource using the global `operator new()` and `operator delete()`.
+MemoryResource* NewDeleteResource();
+
+/**
+ * A resource caching small blocks in thread-local free lists.
+ *
+ * Small allocations are served from (and released to) a free list in the
+ * calling thread, falling back to the global `operator new()` when the list is
+ * empty. Large or over-aligned allocations always use the global allocator.
+ * Memory allocated in one thread can be released in any other thread.
+ */
+MemoryResource* ThreadCachingPoolResource();
+
+/**
+ * The resource used when the application does not provide one.
+ *
+ * This is initially `ThreadCachingPoolResource()`.
+ */
+MemoryResource* DefaultMemoryResource();
+
+/**
+ * Change the resource returned by `DefaultMemoryResource()`.
+ *
+ * @param resource the new default resource, if `nullptr` the default is reset
+ *     to `ThreadCachingPoolResource()`.
+ * @return the previous default resource.
+ */
+MemoryResource* SetDefaultMemoryResource(MemoryResource* resource);
+
+/**
+ * A C++11 allocator based on a `MemoryResource`.
+ *
+ * Use this class to create objects with `std::allocate_shared()` or standard
+ * containers using a `MemoryResource`.
+ */
+template <typename T>
+class MemoryResourceAllocator {
+ public:
+  using value_type = T;
+
+  explicit MemoryResourceAllocator(MemoryResource* resource)
+      : resource_(resource) {}
+  template <typename U>
+  MemoryResourceAllocator(MemoryResourceAllocator<U> const& rhs)
+      : resource_(rhs.resource()) {}
+
+  T* allocate(std::size_t n) {
+    return static_cast<T*>(resource_->Allocate(n * sizeof(T), alignof(T)));
+  }
+  void deallocate(T* p, std::size_t n) {
+    resource_->Deallocate(p, n * sizeof(T), alignof(T));
+  }
+
+  MemoryResource* resource() const { return resource_; }
+
+ private:
+  MemoryResource* resource_;
+};
+
+template <typename T, typename U>
+bool operator==(MemoryResourceAllocator<T> const& lhs,
+                MemoryResourceAllocator<U> const& rhs) {
+  return lhs.resource() == rhs.resource();
+}
+
+template <typename T, typename U>
+bool operator!=(MemoryResourceAllocator<T> const& lhs,
+                MemoryResourceAllocator<U> const& rhs) {
+  return !(lhs == rhs);
+}
+
+}  // namespace GOOGLE_CLOUD_CPP_NS
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_MEMORY_RESOURCE_H
@@ -0,0 +1,146 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/memory_resource.h"
+#include "google/cloud/future.h"
+#include <gmock/gmock.h>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace google {
+namespace cloud {
+inline namespace GOOGLE_CLOUD_CPP_NS {
+namespace {
+
+/// A resource that counts the allocations and forwards them to the default.
+class CountingResource : public MemoryResource {
+ public:
+  void* Allocate(std::size_t bytes, std::size_t alignment) override {
+    ++allocations;
+    return NewDeleteResource()->Allocate(bytes, alignment);
+  }
+  void Deallocate(void* p, std::size_t bytes, std::size_t alignment) override {
+    ++deallocations;
+    NewDeleteResource()->Deallocate(p, bytes, alignment);
+  }
+
+  int allocations = 0;
+  int deallocations = 0;
+};
+
+bool IsAligned(void* p, std::size_t alignment) {
+  return reinterpret_cast<std::uintptr_t>(p) % alignment == 0;
+}
+
+TEST(MemoryResourceTest, NewDelete) {
+  auto* resource = NewDeleteResource();
+  for (std::size_t alignment : {1, 8, 16, 64, 256, 4096}) {
+    void* p = resource->Allocate(100, alignment);
+    ASSERT_NE(nullptr, p);
+    EXPECT_TRUE(IsAligned(p, alignment)) << "alignment=" << alignment;
+    resource->Deallocate(p, 100, alignment);
+  }
+}
+
+TEST(MemoryResourceTest, PoolReusesBlocks) {
+  auto* resource = ThreadCachingPoolResource();
+  void* p = resource->Allocate(100, 8);
+  resource->Deallocate(p, 100, 8);
+  // Any size in the same size class returns the cached block.
+  void* q = resource->Allocate(120, 8);
+  EXPECT_EQ(p, q);
+  resource->Deallocate(q, 120, 8);
+}
+
+TEST(MemoryResourceTest, PoolLargeAndOverAligned) {
+  auto* resource = ThreadCachingPoolResource();
+  void* large = resource->Allocate(64 * 1024, 8);
+  ASSERT_NE(nullptr, large);
+  resource->Deallocate(large, 64 * 1024, 8);
+
+  void* aligned = resource->Allocate(32, 256);
+  EXPECT_TRUE(IsAligned(aligned, 256));
+  resource->Deallocate(aligned, 32, 256);
+}
+
+TEST(MemoryResourceTest, PoolCrossThread) {
+  auto* resource = ThreadCachingPoolResource();
+  std::vector<void*> blocks;
+  for (int i = 0; i != 200; ++i) blocks.push_back(resource->Allocate(48, 8));
+  // Release the blocks in a different thread, which caches some of them and
+  // returns the rest to the global allocator when it exits.
+  std::thread t([&] {
+    for (auto* p : blocks) resource->Deallocate(p, 48, 8);
+  });
+  t.join();
+}
+
+TEST(MemoryResourceTest, SetDefault) {
+  EXPECT_EQ(ThreadCachingPoolResource(), DefaultMemoryResource());
+  CountingResource counting;
+  auto* previous = SetDefaultMemoryResource(&counting);
+  EXPECT_EQ(ThreadCachingPoolResource(), previous);
+  EXPECT_EQ(&counting, DefaultMemoryResource());
+  SetDefaultMemoryResource(nullptr);
+  EXPECT_EQ(ThreadCachingPoolResource(), DefaultMemoryResource());
+}
+
+TEST(MemoryResourceTest, Allocator) {
+  CountingResource counting;
+  {
+    MemoryResourceAllocator<int> allocator(&counting);
+    std::vector<int, MemoryResourceAllocator<int>> v(allocator);
+    v.assign(1000, 42);
+    auto p = std::allocate_shared<std::string>(allocator, "test");
+    EXPECT_EQ("test", *p);
+  }
+  EXPECT_LT(0, counting.allocations);
+  EXPECT_EQ(counting.allocations, counting.deallocations);
+}
+
+TEST(MemoryResourceTest, PromiseUsesResource) {
+  CountingResource counting;
+  {
+    promise<int> p(std::allocator_arg, &counting);
+    EXPECT_EQ(1, counting.allocations);
+    // Continuations inherit the resource from the shared state.
+    auto f = p.get_future()
+                 .then([](future<int> g) { return 2 * g.get(); })
+                 .then([](future<int> g) { return make_ready_future(g.get()); });
+    EXPECT_LT(1, counting.allocations);
+    p.set_value(21);
+    EXPECT_EQ(42, f.get());
+  }
+  EXPECT_EQ(counting.allocations, counting.deallocations);
+}
+
+TEST(MemoryResourceTest, ThenUsesResource) {
+  CountingResource counting;
+  {
+    promise<void> p;
+    auto f = p.get_future().then(std::allocator_arg, &counting,
+                                 [](future<void>) { return 42; });
+    // The continuation and its shared state.
+    EXPECT_EQ(2, counting.allocations);
+    p.set_value();
+    EXPECT_EQ(42, f.get());
+  }
+  EXPECT_EQ(counting.allocations, counting.deallocations);
+}
+
+}  // namespace
+}  // namespace GOOGLE_CLOUD_CPP_NS
+}  // namespace cloud
+}  // namespace google
@@ -0,0 +1,67 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/retry_budget.h"
+#include "google/cloud/internal/throw_delegate.h"
+#include <algorithm>
+#include <cmath>
+
+namespace google {
+namespace cloud {
+inline namespace GOOGLE_CLOUD_CPP_NS {
+
+std::int64_t constexpr RetryBudget::kScale;
+
+RetryBudget::RetryBudget(double max_tokens, double retry_ratio)
+    : max_tokens_(std::llround(max_tokens * kScale)),
+      retry_ratio_(std::llround(retry_ratio * kScale)),
+      tokens_(max_tokens_) {
+  if (max_tokens < 1.0) {
+    google::cloud::internal::ThrowInvalidArgument("max_tokens must be >= 1.0");
+  }
+  if (retry_ratio < 0.0) {
+    google::cloud::internal::ThrowInvalidArgument("retry_ratio must be >= 0.0");
+  }
+}
+
+void RetryBudget::OnSuccess() {
+  std::lock_guard<std::mutex> lk(mu_);
+  ++counters_.successes;
+  tokens_ = std::min(max_tokens_, tokens_ + retry_ratio_);
+}
+
+bool RetryBudget::TryRetry() {
+  std::lock_guard<std::mutex> lk(mu_);
+  if (tokens_ < kScale) {
+    ++counters_.retries_denied;
+    return false;
+  }
+  ++counters_.retries_allowed;
+  tokens_ -= kScale;
+  return true;
+}
+
+double RetryBudget::tokens() const {
+  std::lock_guard<std::mutex> lk(mu_);
+  return static_cast<double>(tokens_) / kScale;
+}
+
+RetryBudgetCounters RetryBudget::counters() const {
+  std::lock_guard<std::mutex> lk(mu_);
+  return counters_;
+}
+
+}  // namespace GOOGLE_CLOUD_CPP_NS
+}  // namespace cloud
+}  // namespace google
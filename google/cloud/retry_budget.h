@@ -0,0 +1,99 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_RETRY_BUDGET_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_RETRY_BUDGET_H
+
+#include "google/cloud/version.h"
+#include <cstdint>
+#include <mutex>
+
+namespace google {
+namespace cloud {
+inline namespace GOOGLE_CLOUD_CPP_NS {
+/// The counters for a `RetryBudget`.
+struct RetryBudgetCounters {
+  /// The number of successful requests, each one deposits into the budget.
+  std::int64_t successes = 0;
+
+  /// The number of retries allowed by the budget.
+  std::int64_t retries_allowed = 0;
+
+  /// The number of retries rejected because the budget was exhausted.
+  std::int64_t retries_denied = 0;
+};
+
+/**
+ * Limit the number of retries across all the requests in a client.
+ *
+ * Each retry policy limits the retries for a single request. During an outage
+ * all the requests fail, and each of them retries up to its limit. This
+ * multiplies the load on the service, just when it is least able to handle it.
+ *
+ * A `RetryBudget` is a token bucket shared by many requests. Each successful
+ * request deposits @p retry_ratio tokens (up to @p max_tokens), and each retry
+ * withdraws one token. When the bucket is empty the requests fail instead of
+ * retrying. In the steady state the retries are capped at @p retry_ratio
+ * times the number of successful requests, while the initial @p max_tokens
+ * allow short bursts of retries.
+ *
+ * Applications attach a budget to their clients using
+ * `ConnectionOptions::set_retry_budget()`. The same budget can be shared by
+ * several clients. This class is thread-safe.
+ */
+class RetryBudget {
+ public:
+  /**
+   * Create a budget.
+   *
+   * @param max_tokens the capacity (and initial value) of the budget. It must
+   *     be at least 1.0.
+   * @param retry_ratio the tokens deposited by each successful request, this
+   *     is the maximum ratio between retries and successful requests. It must
+   *     not be negative.
+   */
+  explicit RetryBudget(double max_tokens = 10.0, double retry_ratio = 0.1);
+
+  /// Deposit the tokens for a successful request.
+  void OnSuccess();
+
+  /**
+   * Withdraw the tokens for a retry.
+   *
+   * @return true if the retry is allowed, false if the budget is exhausted.
+   */
+  bool TryRetry();
+
+  /// The tokens currently available.
+  double tokens() const;
+
+  /// A snapshot of the counters for this budget.
+  RetryBudgetCounters counters() const;
+
+ private:
+  // Keep the tokens in thousandths, so the deposits add up exactly.
+  static std::int64_t constexpr kScale = 1000;
+
+  std::int64_t const max_tokens_;
+  std::int64_t const retry_ratio_;
+  mutable std::mutex mu_;
+  std::int64_t tokens_;
+  RetryBudgetCounters counters_;
+};
+
+}  // namespace GOOGLE_CLOUD_CPP_NS
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_RETRY_BUDGET_H
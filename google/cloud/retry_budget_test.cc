@@ -0,0 +1,94 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "google/cloud/retry_budget.h"
+#include <gmock/gmock.h>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace google {
+namespace cloud {
+inline namespace GOOGLE_CLOUD_CPP_NS {
+namespace {
+
+TEST(RetryBudget, Simple) {
+  RetryBudget tested(3.0, 0.25);
+  EXPECT_EQ(3.0, tested.tokens());
+  EXPECT_TRUE(tested.TryRetry());
+  EXPECT_TRUE(tested.TryRetry());
+  EXPECT_TRUE(tested.TryRetry());
+  EXPECT_FALSE(tested.TryRetry());
+  EXPECT_EQ(0.0, tested.tokens());
+
+  // Four successes deposit enough for another retry.
+  for (int i = 0; i != 3; ++i) tested.OnSuccess();
+  EXPECT_FALSE(tested.TryRetry());
+  tested.OnSuccess();
+  EXPECT_TRUE(tested.TryRetry());
+
+  auto const counters = tested.counters();
+  EXPECT_EQ(4, counters.successes);
+  EXPECT_EQ(4, counters.retries_allowed);
+  EXPECT_EQ(2, counters.retries_denied);
+}
+
+TEST(RetryBudget, DepositsAreCapped) {
+  RetryBudget tested(2.0, 0.1);
+  for (int i = 0; i != 100; ++i) tested.OnSuccess();
+  EXPECT_EQ(2.0, tested.tokens());
+
+  EXPECT_TRUE(tested.TryRetry());
+  for (int i = 0; i != 10; ++i) tested.OnSuccess();
+  EXPECT_EQ(2.0, tested.tokens());
+}
+
+TEST(RetryBudget, ValidateParameters) {
+#if GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+  EXPECT_THROW(RetryBudget(0.5, 0.1), std::invalid_argument);
+  EXPECT_THROW(RetryBudget(10.0, -0.1), std::invalid_argument);
+#else
+  EXPECT_DEATH_IF_SUPPORTED(RetryBudget(0.5, 0.1), "exceptions are disabled");
+  EXPECT_DEATH_IF_SUPPORTED(RetryBudget(10.0, -0.1),
+                            "exceptions are disabled");
+#endif  // GOOGLE_CLOUD_CPP_HAVE_EXCEPTIONS
+}
+
+TEST(RetryBudget, ThreadSafe) {
+  auto constexpr kThreads = 4;
+  auto constexpr kIterations = 1000;
+  RetryBudget tested(10.0, 0.5);
+  std::vector<std::thread> threads;
+  for (int t = 0; t != kThreads; ++t) {
+    threads.emplace_back([&tested] {
+      for (int i = 0; i != kIterations; ++i) {
+        tested.OnSuccess();
+        tested.TryRetry();
+      }
+    });
+  }
+  for (auto& t : threads) t.join();
+
+  auto const counters = tested.counters();
+  EXPECT_EQ(kThreads * kIterations, counters.successes);
+  EXPECT_EQ(kThreads * kIterations,
+            counters.retries_allowed + counters.retries_denied);
+  EXPECT_LE(0.0, tested.tokens());
+  EXPECT_GE(10.0, tested.tokens());
+}
+
+}  // namespace
+}  // namespace GOOGLE_CLOUD_CPP_NS
+}  // namespace cloud
+}  // namespace google
@@ -71,6 +71,19 @@ std::ostream& operator<<(std::ostream& os, StatusCode code) {
   return os << StatusCodeToString(code);
 }
 
+Status::Status(StatusCode status_code, std::string message,
+               std::string error_details)
+    : code_(status_code), message_(std::move(message)) {
+  if (error_details.empty()) return;
+  error_details_ =
+      std::make_shared<std::string const>(std::move(error_details));
+}
+
+std::string const& Status::error_details() const {
+  static auto const* const kEmpty = new std::string;
+  return error_details_ ? *error_details_ : *kEmpty;
+}
+
 RuntimeStatusError::RuntimeStatusError(Status status)
     : std::runtime_error(StatusWhat(status)), status_(std::move(status)) {}
 
@@ -17,6 +17,7 @@
 
 #include "google/cloud/version.h"
 #include <iostream>
+#include <memory>
 #include <tuple>
 
 namespace google {
@@ -59,6 +60,12 @@ std::ostream& operator<<(std::ostream& os, StatusCode code);
  *
  * This class is modeled after `grpc::Status`, it contains the status code and
  * error message (if applicable) from a JSON request.
+ *
+ * Errors from gRPC services may also include additional details, such as how
+ * long to wait before retrying the request. These details are kept in their
+ * serialized form (a `google.rpc.Status` proto), and are only parsed by the
+ * functions that need them. The details are shared between copies of the
+ * status, so copying a `Status` remains cheap.
  */
 class Status {
  public:
@@ -67,20 +74,32 @@ class Status {
   explicit Status(StatusCode status_code, std::string message)
       : code_(status_code), message_(std::move(message)) {}
 
+  explicit Status(StatusCode status_code, std::string message,
+                  std::string error_details);
+
   bool ok() const { return code_ == StatusCode::kOk; }
 
   StatusCode code() const { return code_; }
   std::string const& message() const { return message_; }
 
+  /**
+   * The serialized `google.rpc.Status` proto with the error details, if any.
+   *
+   * Returns an empty string if the error did not include any details.
+   */
+  std::string const& error_details() const;
+
  private:
   StatusCode code_;
   std::string message_;
+  std::shared_ptr<std::string const> error_details_;
 };
 
 inline std::ostream& operator<<(std::ostream& os, Status const& rhs) {
   return os << rhs.message() << " [" << StatusCodeToString(rhs.code()) << "]";
 }
 
+/// Compares the code and message, the error details are not compared.
 inline bool operator==(Status const& lhs, Status const& rhs) {
   return lhs.code() == rhs.code() && lhs.message() == rhs.message();
 }
@@ -51,6 +51,19 @@ TEST(Status, StatusCodeToString) {
             StatusCodeToString(static_cast<StatusCode>(42)));
 }
 
+TEST(Status, ErrorDetails) {
+  Status plain(StatusCode::kUnavailable, "try-again");
+  EXPECT_TRUE(plain.error_details().empty());
+
+  Status detailed(StatusCode::kUnavailable, "try-again", "serialized-details");
+  EXPECT_EQ("serialized-details", detailed.error_details());
+
+  // Copies share the details, and the details do not affect equality.
+  Status copy = detailed;
+  EXPECT_EQ(&detailed.error_details(), &copy.error_details());
+  EXPECT_EQ(plain, detailed);
+}
+
 }  // namespace
 }  // namespace GOOGLE_CLOUD_CPP_NS
 }  // namespace cloud
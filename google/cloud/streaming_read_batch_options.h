@@ -0,0 +1,87 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STREAMING_READ_BATCH_OPTIONS_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STREAMING_READ_BATCH_OPTIONS_H
+
+#include "google/cloud/version.h"
+#include <chrono>
+#include <cstddef>
+
+namespace google {
+namespace cloud {
+inline namespace GOOGLE_CLOUD_CPP_NS {
+/**
+ * Control how streaming read RPCs group messages into batches.
+ *
+ * With `CompletionQueue::MakeBatchedStreamingReadRpc()` the handler receives
+ * the messages in batches, amortizing the per-message dispatch overhead. A
+ * batch is delivered when (a) it contains `max_messages()` messages, or
+ * (b) it contains at least `max_bytes()` bytes, or (c) the `linger()` period
+ * after its first message expires, or (d) the stream ends. Messages received
+ * while the handler is busy are delivered as soon as the handler completes.
+ */
+class StreamingReadBatchOptions {
+ public:
+  StreamingReadBatchOptions() = default;
+
+  /// The maximum number of messages in a batch, must be at least 1.
+  std::size_t max_messages() const { return max_messages_; }
+
+  /// Set the value for `max_messages()`.
+  StreamingReadBatchOptions& set_max_messages(std::size_t v) {
+    max_messages_ = v == 0 ? 1 : v;
+    return *this;
+  }
+
+  /**
+   * Deliver a batch once its messages add up to this many bytes.
+   *
+   * The size of each message is its serialized size. A single message larger
+   * than this limit is delivered in a batch of its own. Zero (the default)
+   * disables this limit.
+   */
+  std::size_t max_bytes() const { return max_bytes_; }
+
+  /// Set the value for `max_bytes()`.
+  StreamingReadBatchOptions& set_max_bytes(std::size_t v) {
+    max_bytes_ = v;
+    return *this;
+  }
+
+  /**
+   * How long to wait for a partial batch to fill.
+   *
+   * Zero (the default) delivers partial batches immediately if the handler is
+   * idle. Messages still accumulate into batches while the handler is busy.
+   */
+  std::chrono::microseconds linger() const { return linger_; }
+
+  /// Set the value for `linger()`.
+  StreamingReadBatchOptions& set_linger(std::chrono::microseconds v) {
+    linger_ = v;
+    return *this;
+  }
+
+ private:
+  std::size_t max_messages_ = 128;
+  std::size_t max_bytes_ = 0;
+  std::chrono::microseconds linger_ = std::chrono::microseconds(0);
+};
+
+}  // namespace GOOGLE_CLOUD_CPP_NS
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STREAMING_READ_BATCH_OPTIONS_H
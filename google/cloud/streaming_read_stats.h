@@ -0,0 +1,75 @@
+// Copyright 2020 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STREAMING_READ_STATS_H
+#define GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STREAMING_READ_STATS_H
+
+#include "google/cloud/status.h"
+#include "google/cloud/version.h"
+#include <chrono>
+#include <cstdint>
+
+namespace google {
+namespace cloud {
+inline namespace GOOGLE_CLOUD_CPP_NS {
+/**
+ * Statistics about a streaming read RPC.
+ *
+ * These statistics help to determine if a slow stream is limited by the
+ * network or by the handler. Compare the gaps between messages (the time
+ * waiting for the network) against `handler_time` (the time processing the
+ * messages).
+ *
+ * The statistics are only collected if requested when the stream is created,
+ * otherwise all the fields keep their default values.
+ */
+struct StreamingReadStats {
+  /// The number of messages received, including any discarded messages.
+  std::int64_t messages = 0;
+
+  /// The total serialized size of the messages received.
+  std::int64_t bytes = 0;
+
+  /// The time between starting the call and receiving the first message.
+  std::chrono::nanoseconds time_to_first_message{0};
+
+  /// The sum of the gaps between consecutive messages.
+  std::chrono::nanoseconds total_message_gap{0};
+
+  /// The largest gap between consecutive messages.
+  std::chrono::nanoseconds max_message_gap{0};
+
+  /**
+   * The time spent in the `on_read` handler.
+   *
+   * For handlers returning `future<bool>` this includes the time until the
+   * future is satisfied.
+   */
+  std::chrono::nanoseconds handler_time{0};
+
+  /// The time spent discarding messages after the handler stopped the stream.
+  std::chrono::nanoseconds discard_time{0};
+
+  /// Set once the stream has finished, `status` is valid only after that.
+  bool finished = false;
+
+  /// The final status of the stream.
+  Status status;
+};
+
+}  // namespace GOOGLE_CLOUD_CPP_NS
+}  // namespace cloud
+}  // namespace google
+
+#endif  // GOOGLE_CLOUD_CPP_GOOGLE_CLOUD_STREAMING_READ_STATS_H
@@ -36,6 +36,7 @@ class MockCompletionQueue
   }
 
   using CompletionQueueImpl::empty;
+  using CompletionQueueImpl::pending_tags;
   using CompletionQueueImpl::SimulateCompletion;
   using CompletionQueueImpl::size;
 };